@@ -6,6 +6,41 @@
  * Authors: Ahmed Ali El Adoly, Mohamed Gheith, M. Nashat Fors
  * 
  * This implementation uses OR-Tools CP-SAT solver for Binary Linear Programming
+ *
+ * Tùy chọn dòng lệnh:
+ *   --compact    encoding gọn (không tạo biến cố định, AtMostOne cho #9, tổng dùng chung)
+ *   --hint       dựng lịch greedy theo (1)-(10) và đưa vào CP-SAT qua AddHint
+ *   --fix-hint   như --hint nhưng cố định biến theo hint (fix_variables_to_their_hinted_value)
+ *   --symmetry none|count|lex   phá đối xứng giữa các y tá có cùng thuộc tính
+ *   --symmetry-level N          tham số symmetry_level của CP-SAT (0-4)
+ *   --stream                    in từng lời giải cải thiện (chi phí, thời điểm, bound)
+ *   --stream-file FILE          ghi lịch tốt nhất hiện tại ra FILE (ghi file tạm rồi rename)
+ *   --automaton                 luật chuỗi ca (#9, #10, ...) thành AddAutomaton thay vì tổng trượt
+ *   --dataset small|sample      chọn bộ dữ liệu không cần nhập từ bàn phím
+ *   --instance FILE             đọc instance từ file (định dạng: xem readInstanceFile)
+ *   --workers N / --time-limit S   số CP-SAT worker / giới hạn thời gian mỗi instance
+ *   --batch DIR|MANIFEST [--jobs N] [--out FILE]
+ *                               giải nhiều instance song song, mỗi instance một dòng JSON
+ *   --repair I:A-B[,I:A-B...] [--change-budget K] [--repair-time-limit S]
+ *                               sau khi giải: y tá I nghỉ các ca A..B, sửa lịch cục bộ (NSPSolver::repair)
+ *                               trong tổng cộng S giây (mặc định 1)
+ *   --dump-model PREFIX         ghi CpModelProto, SatParameters, CpSolverResponse (protobuf nhị phân)
+ *                               ra PREFIX.{model,params,response}.pb; batch: PREFIX là thư mục.
+ *                               Giải lại bằng nsp_replay
+ *   --seed N                    random_seed của CP-SAT
+ *   --bench-workers 1,4,8,16 [--bench-seeds R]
+ *                               benchmark số worker × R seed trên instance đã chọn, in bảng rồi thoát
+ *   --export-csv FILE / --export-bin FILE / --export-json FILE
+ *                               xuất lịch (CSV 0/1, bitmatrix nhị phân, JSON danh sách ca)
+ *   --no-print                  không in bảng lịch ra terminal
+ *   --pool K [--pool-distance D] [--pool-out PREFIX]
+ *                               giữ K lời giải tốt nhất (từ observer của CP-SAT) cách nhau >= D ô
+ *                               (mặc định 100, nsp_pool.h), ghi PREFIX.1.bin ... theo định dạng --export-bin
+ *   --checkpoint FILE           ghi checkpoint nhị phân (nsp_checkpoint.h) mỗi lời giải cải thiện, ở thread
+ *                               riêng: lời giải tốt nhất, bound, số lời giải, thời gian tìm kiếm, seed
+ *   --resume FILE               chạy tiếp từ checkpoint: hint lời giải đã lưu, chặn hàm mục tiêu trong
+ *                               [bound, chi phí đã có], chỉ dùng phần còn lại của --time-limit;
+ *                               ghi tiếp vào FILE nếu không có --checkpoint
  */
 
 #include <iostream>
@@ -16,14 +51,38 @@
 #include <numeric>
 #include <random>
 #include <chrono>
+#include <map>
+#include <tuple>
+#include <array>
+#include <queue>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
 
 #include "ortools/sat/cp_model.h"
 #include "ortools/sat/cp_model_solver.h"
+#include "ortools/util/time_limit.h"
+
+#include "nsp_backend.h"
+#include "nsp_pool.h"
+#include "nsp_checkpoint.h"
 
 using namespace std;
 using namespace operations_research;
 using namespace operations_research::sat;
 
+namespace nsp_cpsat {
+
 // ==================== CẤU TRÚC DỮ LIỆU ====================
 
 struct Nurse {
@@ -33,6 +92,10 @@ struct Nurse {
     bool isFemale;       // Giới tính nữ
     int minShifts;       // Số ca tối thiểu phải làm (N_i)
     int maxShifts;       // Số ca tối đa có thể làm (U_i)
+    // Mask theo ca (bit j % 64 của word j / 64), rỗng = không có
+    vector<uint64_t> unavailable;   // (11) ca không thể làm: không tạo biến
+    vector<uint64_t> avoid;         // ca muốn tránh: phạt preferenceCost mỗi ca
+    int skills = 0;                 // (12) bit k = có kỹ năng k
 };
 
 struct ShiftRequirement {
@@ -41,6 +104,28 @@ struct ShiftRequirement {
     int requiredNurses;  // Số y tá cần (M_j)
 };
 
+// Luật chuỗi ca cho y tá thường, trên chuỗi ca liên tiếp j = day * numShiftsPerDay + s.
+// Mỗi luật là một ngôn ngữ chính quy "không chứa mẫu cấm":
+//  - pattern:  '1' = làm, '?' = tùy ý; cấm xuất hiện.   "1?1" = luật (9)
+//  - window/maxWorked: mọi cửa sổ 'window' ca liên tiếp làm tối đa 'maxWorked'.  (5, 2) = luật (10)
+//  - anchorType >= 0: chỉ áp dụng khi ca đầu của mẫu/cửa sổ thuộc loại ca đó
+//    (ví dụ {"11", anchor = ca đêm} = không làm ca đêm rồi tiếp ngay ca sáng hôm sau)
+struct SequenceRule {
+    string pattern;
+    int window = 0;
+    int maxWorked = 0;
+    int anchorType = -1;
+};
+
+vector<SequenceRule> defaultSequenceRules() {
+    SequenceRule rest;           // (9)  làm ca j thì nghỉ ca j+2
+    rest.pattern = "1?1";
+    SequenceRule window;         // (10) 5 ca liên tiếp tối đa 2
+    window.window = 5;
+    window.maxWorked = 2;
+    return {rest, window};
+}
+
 struct NSPInput {
     int numDays;                          // Số ngày trong planning horizon
     int numShiftsPerDay;                  // Số ca mỗi ngày (thường = 3)
@@ -49,9 +134,14 @@ struct NSPInput {
     int minAfternoonShifts;               // Số ca chiều tối thiểu (A)
     int minNightShifts;                   // Số ca đêm tối thiểu (B)
     int minMorningShiftsHeadNurse;        // Số ca sáng tối thiểu cho y tá trưởng (F)
+    int minHeadNursesPerMorning = 0;      // Số y tá trưởng tối thiểu mỗi ca sáng (bản Rust/Python)
     double costPerShift;                  // Chi phí mỗi ca thường (c1)
     double overtimeCost;                  // Chi phí làm thêm (c2)
     double headNurseCost;                 // Chi phí ca y tá trưởng (c3)
+    double preferenceCost = 0;            // Phạt mỗi ca rơi vào ô avoid của y tá (c4)
+    int numSkills = 0;                    // (12) số kỹ năng, 0 = không có nhu cầu theo kỹ năng
+    vector<int> skillDemand;              // (12) nhu cầu [skill * totalShifts + j], cộng qua các khoa
+    vector<SequenceRule> sequenceRules;   // Luật chuỗi ca (mặc định: (9), (10))
 };
 
 struct NSPSolution {
@@ -60,8 +150,30 @@ struct NSPSolution {
     double normalCost;
     double overtimeCost;
     double headNurseCost;
+    double preferenceCost = 0;            // Phạt các ca rơi vào ô avoid
     vector<vector<int>> schedule;         // schedule[nurse][shift] = 0 or 1
     double solveTimeMs;
+    int hintViolations = -1;              // Số ràng buộc hint vi phạm (-1 = không dùng hint)
+    bool optimal = false;                 // CP-SAT chứng minh tối ưu
+    double bestBound = 0;                 // Cận dưới tốt nhất của chi phí (repair: gồm cả chi phí đổi ca)
+    int changedAssignments = -1;          // Repair: số ô lịch khác lịch gốc (-1 = không phải repair)
+    double searchMs = 0;                  // Thời gian CP-SAT (không tính build model)
+    int numVariables = 0;                 // Kích thước CpModelProto
+    int numConstraints = 0;
+    vector<pair<double, double>> trace;   // (ms từ lúc bắt đầu tìm kiếm, chi phí) mỗi lời giải cải thiện
+    NSPSolutionPool pool;                 // --pool: lời giải tốt và khác nhau từ observer
+    long checkpointWrites = 0;            // --checkpoint: số lần ghi file thành công
+};
+
+// Sự cố giữa kỳ cho NSPSolver::repair
+struct NSPDisruption {
+    vector<pair<int, int>> unavailable;    // (y tá, ca) không thể làm (ốm, nghỉ đột xuất)
+    vector<pair<int, int>> demandChanges;  // (ca, số y tá cần mới)
+    int changeBudget = -1;      // Số ô được đổi tối đa, không tính ô bị buộc bỏ (-1 = không giới hạn)
+    double changeCost = 1.0;    // Chi phí mỗi ô đổi, cộng vào hàm mục tiêu
+    int radius = 6;             // Vùng sửa ban đầu: ±radius ca quanh ca bị ảnh hưởng, nhân đôi nếu vô nghiệm
+    bool hintOnly = false;      // true: ngoài vùng sửa chỉ hint lịch gốc thay vì cố định
+    double timeLimit = 1.0;     // Giây cho cả lần sửa, chia cho các lần nhân đôi vùng (không dùng options.timeLimit)
 };
 
 // ==================== HELPER FUNCTIONS ====================
@@ -75,8 +187,8 @@ string getShiftName(int shiftType) {
     }
 }
 
-string getDayName(int dayIndex) {
-    vector<string> days = {"Thứ 7", "CN   ", "Thứ 2", "Thứ 3", "Thứ 4", "Thứ 5", "Thứ 6"};
+const char* getDayName(int dayIndex) {
+    static const char* const days[] = {"Thứ 7", "CN   ", "Thứ 2", "Thứ 3", "Thứ 4", "Thứ 5", "Thứ 6"};
     return days[dayIndex % 7];
 }
 
@@ -84,36 +196,244 @@ int getShiftIndex(int day, int shiftType, int shiftsPerDay) {
     return day * shiftsPerDay + shiftType;
 }
 
+bool maskBit(const vector<uint64_t>& mask, int j) {
+    return !mask.empty() && ((mask[j / 64] >> (j % 64)) & 1);
+}
+
+// Vai trò loại ca theo số ca mỗi ngày: ca 0 luôn là ca sáng, ca cuối là ca đêm,
+// ca chiều là ca 1 khi có từ 3 ca trở lên (-1 = không có)
+int afternoonShiftType(int shiftsPerDay) {
+    return shiftsPerDay >= 3 ? 1 : -1;
+}
+
+int nightShiftType(int shiftsPerDay) {
+    return shiftsPerDay >= 2 ? shiftsPerDay - 1 : -1;
+}
+
+char getShiftLetter(int shiftType, int shiftsPerDay) {
+    if (shiftType == 0) return 'S';
+    if (shiftType == afternoonShiftType(shiftsPerDay)) return 'C';
+    if (shiftType == nightShiftType(shiftsPerDay)) return 'D';
+    return 'T';
+}
+
+// ==================== AUTOMATON CHO LUẬT CHUỖI CA ====================
+
+// DFA trên bảng chữ {0 = nghỉ, 1 = làm}. Trạng thái = (số ca đã đọc, tối đa L-1;
+// L-1 bit cuối; vị trí trong ngày nếu có luật neo theo loại ca). Mọi chuyển trạng thái
+// đều được giữ lại kèm số luật bị vi phạm: AddAutomaton chỉ dùng chuyển có cost 0,
+// còn bộ kiểm tra cộng dồn cost để đếm vi phạm.
+struct SequenceDFA {
+    int numStates = 0;
+    vector<array<int, 2>> next;
+    vector<array<int, 2>> cost;
+};
+
+SequenceDFA compileSequenceRules(const vector<SequenceRule>& rules, int shiftsPerDay) {
+    int L = 1;
+    bool anchored = false;
+    for (const SequenceRule& r : rules) {
+        L = max(L, r.pattern.empty() ? r.window : (int)r.pattern.size());
+        anchored = anchored || r.anchorType >= 0;
+    }
+    int H = L - 1;
+    int P = anchored ? shiftsPerDay : 1;
+    
+    SequenceDFA dfa;
+    map<tuple<int, int, int>, int> ids;
+    vector<tuple<int, int, int>> states;
+    queue<int> pending;
+    auto idOf = [&](int seen, int hist, int phase) {
+        auto key = make_tuple(seen, hist, phase);
+        auto it = ids.find(key);
+        if (it != ids.end()) return it->second;
+        int id = states.size();
+        ids[key] = id;
+        states.push_back(key);
+        dfa.next.push_back({-1, -1});
+        dfa.cost.push_back({0, 0});
+        pending.push(id);
+        return id;
+    };
+    
+    idOf(0, 0, 0);
+    while (!pending.empty()) {
+        int id = pending.front();
+        pending.pop();
+        int seen, hist, phase;
+        tie(seen, hist, phase) = states[id];
+        for (int b = 0; b < 2; b++) {
+            unsigned bits = ((unsigned)hist << 1) | b;   // bit 0 = ca vừa đọc, bit k = k ca trước
+            int violations = 0;
+            for (const SequenceRule& r : rules) {
+                int m = r.pattern.empty() ? r.window : (int)r.pattern.size();
+                if (m <= 0 || m > seen + 1) continue;
+                if (r.anchorType >= 0 && ((phase - (m - 1)) % P + P) % P != r.anchorType) continue;
+                if (r.pattern.empty()) {
+                    if (__builtin_popcount(bits & ((1u << m) - 1)) > r.maxWorked) violations++;
+                } else {
+                    bool match = true;
+                    for (int k = 0; k < m && match; k++) {
+                        if (r.pattern[k] == '1' && !((bits >> (m - 1 - k)) & 1)) match = false;
+                    }
+                    if (match) violations++;
+                }
+            }
+            int nextId = idOf(min(seen + 1, H), (int)(bits & ((1u << H) - 1)), (phase + 1) % P);
+            dfa.next[id][b] = nextId;
+            dfa.cost[id][b] = violations;
+        }
+    }
+    dfa.numStates = states.size();
+    return dfa;
+}
+
+// Số lần vi phạm luật chuỗi ca của một hàng lịch (0 = hàng được DFA chấp nhận)
+int sequenceViolations(const SequenceDFA& dfa, const vector<int>& row) {
+    int state = 0, violations = 0;
+    for (int v : row) {
+        int b = v ? 1 : 0;
+        violations += dfa.cost[state][b];
+        state = dfa.next[state][b];
+    }
+    return violations;
+}
+
+// Ghi lịch ra file theo kiểu atomic (writeFileAtomic: FILE.tmp, fsync, rename), nên bên đọc
+// luôn thấy một lịch đầy đủ (cũ hoặc mới), không bao giờ thấy file dở dang
+bool writeScheduleAtomic(const string& path, const NSPInput& input,
+                         const vector<vector<int>>& schedule, double cost, double bound,
+                         double timeMs) {
+    ostringstream out;
+    out << "# cost=" << fixed << setprecision(2) << cost << " bound=" << bound
+        << " time_ms=" << timeMs << "\n";
+    size_t numShifts = schedule.empty() ? 0 : schedule[0].size();
+    out << "nurse";
+    for (size_t j = 0; j < numShifts; j++) out << ",s" << j;
+    out << "\n";
+    for (size_t i = 0; i < schedule.size(); i++) {
+        out << input.nurses[i].name;
+        for (int v : schedule[i]) out << ',' << v;
+        out << "\n";
+    }
+    string text = out.str();
+    return writeFileAtomic(path, text.data(), text.size());
+}
+
+// Hash các dữ liệu của input ảnh hưởng tới model, để checkpoint không bị nạp cho instance khác
+uint64_t inputFingerprint(const NSPInput& input) {
+    NSPHasher h;
+    h.add(input.numDays);
+    h.add(input.numShiftsPerDay);
+    for (const Nurse& n : input.nurses) {
+        h.add(n.isHeadNurse);
+        h.add(n.isFemale);
+        h.add(n.minShifts);
+        h.add(n.maxShifts);
+        h.add(n.skills);
+        h.add(n.unavailable.size());
+        h.mix(n.unavailable.data(), n.unavailable.size() * sizeof(uint64_t));
+        h.add(n.avoid.size());
+        h.mix(n.avoid.data(), n.avoid.size() * sizeof(uint64_t));
+    }
+    for (const ShiftRequirement& r : input.shifts) h.add(r.requiredNurses);
+    h.add(input.minAfternoonShifts);
+    h.add(input.minNightShifts);
+    h.add(input.minMorningShiftsHeadNurse);
+    h.add(input.minHeadNursesPerMorning);
+    h.add(input.costPerShift);
+    h.add(input.overtimeCost);
+    h.add(input.headNurseCost);
+    h.add(input.preferenceCost);
+    h.add(input.numSkills);
+    h.mix(input.skillDemand.data(), input.skillDemand.size() * sizeof(int));
+    for (const SequenceRule& r : input.sequenceRules) {
+        h.mix(r.pattern.data(), r.pattern.size());
+        h.add(r.window);
+        h.add(r.maxWorked);
+        h.add(r.anchorType);
+    }
+    return h.h;
+}
+
+// Ghi một message protobuf ra file nhị phân (CpModelProto, SatParameters, CpSolverResponse)
+template <typename Proto>
+bool writeProtoFile(const string& path, const Proto& message) {
+    ofstream out(path, ios::binary);
+    return out && message.SerializeToOstream(&out);
+}
+
 // ==================== MODEL BUILDER ====================
 
+enum class SymmetryMode {
+    None,      // không thêm ràng buộc
+    Count,     // tổng ca giảm dần trong mỗi lớp y tá tương đương
+    Lex        // hàng lịch giảm dần theo thứ tự từ điển trong mỗi lớp
+};
+
+struct NSPSolverOptions {
+    bool compact = false;    // Encoding gọn: bỏ biến cố định, AtMostOne cho #9, dùng chung tổng theo y tá
+    bool hint = false;       // Dựng lịch greedy và đưa vào CP-SAT qua AddHint
+    bool fixHint = false;    // fix_variables_to_their_hinted_value (chạy sửa lịch)
+    SymmetryMode symmetry = SymmetryMode::None;
+    int symmetryLevel = -1;  // SatParameters::symmetry_level (0-4), -1 = mặc định CP-SAT
+    bool stream = false;     // In mỗi lời giải cải thiện qua NewFeasibleSolutionObserver
+    string streamFile;       // Nếu khác rỗng: ghi lịch tốt nhất hiện tại ra file
+    bool automaton = false;  // Luật chuỗi ca thành AddAutomaton (thay cho tổng trượt / mệnh đề)
+    int numWorkers = 4;      // CP-SAT search workers
+    double timeLimit = 300.0;
+    bool quiet = false;      // Không in log của solver (batch mode)
+    string dumpPrefix;       // Nếu khác rỗng: ghi PREFIX.model.pb / .params.pb / .response.pb để replay
+    int randomSeed = -1;     // random_seed của CP-SAT (-1 = mặc định)
+    bool recordTrace = false;   // Ghi NSPSolution::trace (benchmark worker)
+    function<bool(double, double)> progress;   // (ms tìm kiếm, chi phí); false = dừng sớm
+    int poolSize = 0;        // > 0: giữ pool top-K lời giải khác nhau (nsp_pool.h)
+    int poolDistance = 100;  // khoảng cách Hamming tối thiểu giữa hai lời giải trong pool
+    string checkpointFile;   // Nếu khác rỗng: checkpoint mỗi lời giải cải thiện (nsp_checkpoint.h)
+};
+
 class NSPSolver {
 private:
     NSPInput input;
+    NSPSolverOptions options;
     int numNurses;
     int totalShifts;
+    SequenceDFA sequenceDfa;     // DFA của input.sequenceRules
     
-public:
-    NSPSolver(const NSPInput& inp) : input(inp) {
-        numNurses = input.nurses.size();
-        totalShifts = input.numDays * input.numShiftsPerDay;
-    }
+    // Trạng thái nạp từ checkpoint (loadCheckpoint); hàm mục tiêu và bound ở thang của model (x100)
+    struct ResumeState {
+        bool active = false;
+        int numSolutions = 0;
+        int64_t objective = 0;
+        double bound = 0;
+        double searchMs = 0;                    // thời gian tìm kiếm cộng dồn các lần trước
+        int randomSeed = -1;
+        bool optimal = false;
+        vector<char> cells;                     // cells[i * totalShifts + j]
+    };
+    ResumeState resume;
     
-    NSPSolution solve() {
-        NSPSolution solution;
-        solution.feasible = false;
-        
-        auto startTime = chrono::high_resolution_clock::now();
-        
-        // Tạo CP-SAT model
-        CpModelBuilder cp_model;
-        
+    // Dữ liệu repair cho solveModel
+    struct RepairSpec {
+        const vector<vector<int>>* base;        // Lịch gốc
+        vector<vector<char>> unavailable;       // Ô buộc bằng 0
+        vector<vector<char>> inside;            // Ô thuộc vùng sửa
+        int changeBudget;
+        double changeCost;
+        bool hintOnly;
+    };
+    
+    // Encoding gốc: mỗi ràng buộc một vector riêng, mọi x[i][j] đều là biến
+    // (trừ ô y tá không làm được (11): FalseVar(), không tạo biến)
+    LinearExpr buildModel(CpModelBuilder& cp_model, vector<vector<BoolVar>>& x) {
         // ==================== BIẾN QUYẾT ĐỊNH ====================
         // x[i][j] = 1 nếu y tá i được phân công vào ca j
-        vector<vector<BoolVar>> x(numNurses, vector<BoolVar>(totalShifts));
+        x.assign(numNurses, vector<BoolVar>(totalShifts));
         
         for (int i = 0; i < numNurses; i++) {
             for (int j = 0; j < totalShifts; j++) {
-                x[i][j] = cp_model.NewBoolVar();
+                x[i][j] = maskBit(input.nurses[i].unavailable, j) ? cp_model.FalseVar()
+                                                                  : cp_model.NewBoolVar();
             }
         }
         
@@ -149,12 +469,15 @@ public:
         for (int i = 0; i < numNurses; i++) {
             if (!input.nurses[i].isHeadNurse) {
                 vector<BoolVar> afternoonShifts;
-                for (int day = 0; day < input.numDays; day++) {
-                    int shiftIdx = getShiftIndex(day, 1, input.numShiftsPerDay); // 1 = Afternoon
+                int afternoon = afternoonShiftType(input.numShiftsPerDay);
+                for (int day = 0; day < input.numDays && afternoon >= 0; day++) {
+                    int shiftIdx = getShiftIndex(day, afternoon, input.numShiftsPerDay);
                     afternoonShifts.push_back(x[i][shiftIdx]);
                 }
-                cp_model.AddGreaterOrEqual(LinearExpr::Sum(afternoonShifts), 
-                                            input.minAfternoonShifts);
+                if (!afternoonShifts.empty()) {
+                    cp_model.AddGreaterOrEqual(LinearExpr::Sum(afternoonShifts), 
+                                                input.minAfternoonShifts);
+                }
             }
         }
         
@@ -162,12 +485,15 @@ public:
         for (int i = 0; i < numNurses; i++) {
             if (!input.nurses[i].isHeadNurse) {
                 vector<BoolVar> nightShifts;
-                for (int day = 0; day < input.numDays; day++) {
-                    int shiftIdx = getShiftIndex(day, 2, input.numShiftsPerDay); // 2 = Night
+                int night = nightShiftType(input.numShiftsPerDay);
+                for (int day = 0; day < input.numDays && night >= 0; day++) {
+                    int shiftIdx = getShiftIndex(day, night, input.numShiftsPerDay);
                     nightShifts.push_back(x[i][shiftIdx]);
                 }
-                cp_model.AddGreaterOrEqual(LinearExpr::Sum(nightShifts), 
-                                            input.minNightShifts);
+                if (!nightShifts.empty()) {
+                    cp_model.AddGreaterOrEqual(LinearExpr::Sum(nightShifts), 
+                                                input.minNightShifts);
+                }
             }
         }
         
@@ -180,11 +506,10 @@ public:
                     int morningIdx = getShiftIndex(day, 0, input.numShiftsPerDay);
                     morningShifts.push_back(x[i][morningIdx]);
                     
-                    // Không làm ca chiều và đêm
-                    int afternoonIdx = getShiftIndex(day, 1, input.numShiftsPerDay);
-                    int nightIdx = getShiftIndex(day, 2, input.numShiftsPerDay);
-                    cp_model.AddEquality(x[i][afternoonIdx], 0);
-                    cp_model.AddEquality(x[i][nightIdx], 0);
+                    // Không làm các ca khác ca sáng
+                    for (int s = 1; s < input.numShiftsPerDay; s++) {
+                        cp_model.AddEquality(x[i][getShiftIndex(day, s, input.numShiftsPerDay)], 0);
+                    }
                 }
                 // Số ca sáng tối thiểu cho y tá trưởng
                 cp_model.AddGreaterOrEqual(LinearExpr::Sum(morningShifts), 
@@ -192,6 +517,26 @@ public:
             }
         }
         
+        // Constraint (7'): Mỗi ca sáng có ít nhất minHeadNursesPerMorning y tá trưởng
+        if (input.minHeadNursesPerMorning > 0) {
+            for (int day = 0; day < input.numDays; day++) {
+                vector<BoolVar> headMorning;
+                int morningIdx = getShiftIndex(day, 0, input.numShiftsPerDay);
+                for (int i = 0; i < numNurses; i++) {
+                    if (input.nurses[i].isHeadNurse) headMorning.push_back(x[i][morningIdx]);
+                }
+                cp_model.AddGreaterOrEqual(LinearExpr::Sum(headMorning),
+                                            input.minHeadNursesPerMorning);
+            }
+        }
+        
+        // Buffer dùng chung cho hàng Hall và luật chuỗi ca
+        vector<BoolVar> buf;
+        buf.reserve(max(numNurses, totalShifts));
+        
+        // Constraint (12): hàng Hall theo tập kỹ năng, không cần biến theo khoa
+        addSkillCoverage(cp_model, x, buf);
+        
         // Constraint (8): Mỗi ca có ít nhất 1 y tá nữ
         for (int j = 0; j < totalShifts; j++) {
             vector<BoolVar> femaleNurses;
@@ -205,97 +550,877 @@ public:
             }
         }
         
-        // Constraint (9): Nếu làm 1 ca thì nghỉ 2 ca tiếp theo
-        // x[i][j] + x[i][j+2] <= 1 (không làm ca cách 2 vị trí)
+        // Constraint (9), (10) và các luật chuỗi ca khác (input.sequenceRules):
+        //  (9)  x[i][j] + x[i][j+2] <= 1 (không làm ca cách 2 vị trí)
+        //  (10) x[i][j] + ... + x[i][j+4] <= 2 (làm 2 ca liên tiếp thì nghỉ 3 ca tiếp theo)
+        // Với --automaton các luật này được thêm trong solve() bằng AddAutomaton
+        for (int i = 0; i < numNurses; i++) {
+            if (!input.nurses[i].isHeadNurse && !options.automaton) {
+                addSequenceRules(cp_model, x[i], false, buf);
+            }
+        }
+        
+        // ==================== HÀM MỤC TIÊU ====================
+        // Minimize: c1 * Σx[i][j] + c2 * max(0, Σx[i][j] - N[i]) + c3 * Σx_head[i][j]
+        
+        // Sử dụng hệ số nguyên (nhân 100 để tránh số thực)
+        int c1 = static_cast<int>(input.costPerShift * 100);
+        int c2 = static_cast<int>(input.overtimeCost * 100);
+        int c3 = static_cast<int>(input.headNurseCost * 100);
+        
+        LinearExpr objective;
+        
+        // Chi phí y tá thường
         for (int i = 0; i < numNurses; i++) {
             if (!input.nurses[i].isHeadNurse) {
-                for (int j = 0; j < totalShifts - 2; j++) {
-                    cp_model.AddLessOrEqual(
-                        LinearExpr::Sum({x[i][j], x[i][j + 2]}), 1);
+                for (int j = 0; j < totalShifts; j++) {
+                    objective += c1 * x[i][j];
                 }
             }
         }
         
-        // Constraint (10): Nếu làm 2 ca liên tiếp thì nghỉ 3 ca tiếp theo
-        // Nếu x[i][j] = 1 và x[i][j+1] = 1, thì x[i][j+2] + x[i][j+3] + x[i][j+4] <= 0
-        // Tương đương: x[i][j] + x[i][j+1] + x[i][j+2] + x[i][j+3] + x[i][j+4] <= 2
+        // Chi phí làm thêm giờ cho y tá thường
+        // overtime[i] = max(0, Σx[i][j] - N[i])
         for (int i = 0; i < numNurses; i++) {
             if (!input.nurses[i].isHeadNurse) {
-                for (int j = 0; j < totalShifts - 4; j++) {
-                    cp_model.AddLessOrEqual(
-                        LinearExpr::Sum({x[i][j], x[i][j+1], x[i][j+2], x[i][j+3], x[i][j+4]}), 2);
+                IntVar overtime = cp_model.NewIntVar({0, input.nurses[i].maxShifts});
+                
+                vector<BoolVar> allShifts;
+                for (int j = 0; j < totalShifts; j++) {
+                    allShifts.push_back(x[i][j]);
                 }
+                
+                // overtime >= Σx[i][j] - N[i]
+                cp_model.AddGreaterOrEqual(
+                    overtime, 
+                    LinearExpr::Sum(allShifts) - input.nurses[i].minShifts);
+                
+                objective += c2 * overtime;
             }
         }
         
-        // ==================== HÀM MỤC TIÊU ====================
-        // Minimize: c1 * Σx[i][j] + c2 * max(0, Σx[i][j] - N[i]) + c3 * Σx_head[i][j]
+        // Chi phí y tá trưởng
+        for (int i = 0; i < numNurses; i++) {
+            if (input.nurses[i].isHeadNurse) {
+                for (int j = 0; j < totalShifts; j++) {
+                    objective += c3 * x[i][j];
+                }
+            }
+        }
+        
+        addPreferencePenalty(objective, x);
+        return objective;
+    }
+    
+    // (12) Mỗi ca j, mỗi tập kỹ năng K có nhu cầu: số y tá làm ca j có kỹ năng thuộc K
+    // >= tổng nhu cầu của K (điều kiện Hall, xem skillCoverageRows trong nsp_backend.h).
+    // Số hàng theo số kỹ năng, không theo số khoa. buf: buffer bên gọi đã reserve
+    void addSkillCoverage(CpModelBuilder& cp_model, const vector<vector<BoolVar>>& x,
+                          vector<BoolVar>& buf) const {
+        for (const NSPSkillRow& row : skillCoverageRows(input.numSkills, totalShifts, input.skillDemand)) {
+            buf.clear();
+            for (int i = 0; i < numNurses; i++) {
+                if ((input.nurses[i].skills & row.skills) && isFree(i, row.shift)) {
+                    buf.push_back(x[i][row.shift]);
+                }
+            }
+            cp_model.AddGreaterOrEqual(LinearExpr::Sum(buf), row.required);
+        }
+    }
+    
+    // Phạt c4 cho mỗi ca làm rơi vào ô avoid (chỉ các ô có biến)
+    void addPreferencePenalty(LinearExpr& objective, const vector<vector<BoolVar>>& x) const {
+        int c4 = static_cast<int>(input.preferenceCost * 100);
+        for (int i = 0; i < numNurses && c4 != 0; i++) {
+            const Nurse& n = input.nurses[i];
+            for (int j = 0; j < totalShifts; j++) {
+                if (maskBit(n.avoid, j) && isFree(i, j)) objective += c4 * x[i][j];
+            }
+        }
+    }
+    
+    // Encoding gọn:
+    //  - x[i][j] cố định bằng 0 (y tá trưởng ca chiều/đêm, ô unavailable (11)) dùng FalseVar(),
+    //    không tạo biến và không đưa vào tổng nào
+    //  - #2/#3 gộp thành một ràng buộc miền trên tổng ca của y tá; tổng này dùng chung
+    //    cho overtime và hàm mục tiêu
+    //  - mẫu cấm 2 literal (#9) là AtMostOne thay vì bất đẳng thức tuyến tính
+    //  - một buffer dùng lại cho mọi ràng buộc
+    LinearExpr buildCompactModel(CpModelBuilder& cp_model, vector<vector<BoolVar>>& x) {
+        int S = input.numShiftsPerDay;
+        
+        x.assign(numNurses, vector<BoolVar>(totalShifts));
+        for (int i = 0; i < numNurses; i++) {
+            for (int j = 0; j < totalShifts; j++) {
+                x[i][j] = isFree(i, j) ? cp_model.NewBoolVar() : cp_model.FalseVar();
+            }
+        }
+        
+        vector<BoolVar> buf;
+        buf.reserve(max(numNurses, totalShifts));
+        
+        // (1) Đủ số y tá mỗi ca
+        for (int j = 0; j < totalShifts; j++) {
+            buf.clear();
+            for (int i = 0; i < numNurses; i++) {
+                if (isFree(i, j)) buf.push_back(x[i][j]);
+            }
+            cp_model.AddGreaterOrEqual(LinearExpr::Sum(buf), input.shifts[j].requiredNurses);
+        }
+        
+        // (7') Số y tá trưởng tối thiểu mỗi ca sáng
+        for (int day = 0; day < input.numDays && input.minHeadNursesPerMorning > 0; day++) {
+            buf.clear();
+            for (int i = 0; i < numNurses; i++) {
+                if (input.nurses[i].isHeadNurse) buf.push_back(x[i][getShiftIndex(day, 0, S)]);
+            }
+            cp_model.AddGreaterOrEqual(LinearExpr::Sum(buf), input.minHeadNursesPerMorning);
+        }
+        
+        // (12) Hàng Hall theo tập kỹ năng
+        addSkillCoverage(cp_model, x, buf);
+        
+        // (8) Ít nhất 1 y tá nữ mỗi ca. Như encoding gốc, chỉ bỏ khi instance không có y tá nữ;
+        // ca không còn y tá nữ nào làm được cho mệnh đề rỗng (model vô nghiệm)
+        bool hasFemale = false;
+        for (const Nurse& n : input.nurses) hasFemale = hasFemale || n.isFemale;
+        for (int j = 0; j < totalShifts && hasFemale; j++) {
+            buf.clear();
+            for (int i = 0; i < numNurses; i++) {
+                if (input.nurses[i].isFemale && isFree(i, j)) buf.push_back(x[i][j]);
+            }
+            cp_model.AddBoolOr(buf);
+        }
+        
+        int c1 = static_cast<int>(input.costPerShift * 100);
+        int c2 = static_cast<int>(input.overtimeCost * 100);
+        int c3 = static_cast<int>(input.headNurseCost * 100);
+        LinearExpr objective;
+        
+        for (int i = 0; i < numNurses; i++) {
+            const Nurse& n = input.nurses[i];
+            
+            // Tổng ca của y tá i, dùng chung cho (2), (3), overtime, mục tiêu
+            buf.clear();
+            for (int j = 0; j < totalShifts; j++) {
+                if (isFree(i, j)) buf.push_back(x[i][j]);
+            }
+            LinearExpr total = LinearExpr::Sum(buf);
+            cp_model.AddLinearConstraint(total, Domain(n.minShifts, n.maxShifts));
+            
+            if (n.isHeadNurse) {
+                // (6) đã mã hóa bằng FalseVar; (7) số ca sáng = tổng ca
+                cp_model.AddGreaterOrEqual(total, input.minMorningShiftsHeadNurse);
+                objective += c3 * total;
+                continue;
+            }
+            
+            // (4), (5) Số ca chiều / đêm tối thiểu
+            int afternoon = afternoonShiftType(S);
+            if (afternoon >= 0) {
+                buf.clear();
+                for (int day = 0; day < input.numDays; day++) {
+                    buf.push_back(x[i][getShiftIndex(day, afternoon, S)]);
+                }
+                cp_model.AddGreaterOrEqual(LinearExpr::Sum(buf), input.minAfternoonShifts);
+            }
+            
+            int night = nightShiftType(S);
+            if (night >= 0) {
+                buf.clear();
+                for (int day = 0; day < input.numDays; day++) {
+                    buf.push_back(x[i][getShiftIndex(day, night, S)]);
+                }
+                cp_model.AddGreaterOrEqual(LinearExpr::Sum(buf), input.minNightShifts);
+            }
+            
+            // (9), (10) và các luật chuỗi ca khác
+            if (!options.automaton) addSequenceRules(cp_model, x[i], true, buf);
+            
+            // Overtime chỉ cần miền [0, U - N]
+            objective += c1 * total;
+            int maxOvertime = max(0, n.maxShifts - n.minShifts);
+            if (maxOvertime > 0) {
+                IntVar overtime = cp_model.NewIntVar({0, maxOvertime});
+                cp_model.AddGreaterOrEqual(overtime, total - n.minShifts);
+                objective += c2 * overtime;
+            }
+        }
+        
+        addPreferencePenalty(objective, x);
+        return objective;
+    }
+    
+    // Luật chuỗi ca cho một hàng x[i][*], dạng tổng trượt / mệnh đề:
+    //  - mẫu cấm k literal: Σ <= k-1 (compact: AtMostOne khi k = 2, BoolOr của phủ định khi k > 2)
+    //  - cửa sổ: Σ <= maxWorked
+    // buf: buffer bên gọi đã reserve, dùng lại qua mọi y tá
+    void addSequenceRules(CpModelBuilder& cp_model, const vector<BoolVar>& row, bool compact,
+                          vector<BoolVar>& buf) {
+        int S = input.numShiftsPerDay;
+        for (const SequenceRule& r : input.sequenceRules) {
+            int m = r.pattern.empty() ? r.window : (int)r.pattern.size();
+            if (m <= 0) continue;
+            for (int j = 0; j + m <= totalShifts; j++) {
+                if (r.anchorType >= 0 && j % S != r.anchorType) continue;
+                buf.clear();
+                if (r.pattern.empty()) {
+                    buf.assign(row.begin() + j, row.begin() + j + m);
+                    cp_model.AddLessOrEqual(LinearExpr::Sum(buf), r.maxWorked);
+                    continue;
+                }
+                for (int k = 0; k < m; k++) {
+                    if (r.pattern[k] == '1') buf.push_back(row[j + k]);
+                }
+                if (buf.empty()) continue;
+                if (!compact) {
+                    cp_model.AddLessOrEqual(LinearExpr::Sum(buf), (int)buf.size() - 1);
+                } else if (buf.size() == 2) {
+                    cp_model.AddAtMostOne(buf);
+                } else {
+                    for (BoolVar& b : buf) b = b.Not();
+                    cp_model.AddBoolOr(buf);
+                }
+            }
+        }
+    }
+    
+    // Repair: ô y tá không làm được bằng 0, ô ngoài vùng sửa cố định (hoặc hint) theo lịch gốc,
+    // ô trong vùng sửa hint theo lịch gốc. Trả về số ô đổi trong vùng sửa.
+    LinearExpr addRepairConstraints(CpModelBuilder& cp_model, const vector<vector<BoolVar>>& x,
+                                    const RepairSpec& repair) {
+        const vector<vector<int>>& base = *repair.base;
+        LinearExpr changes;
+        for (int i = 0; i < numNurses; i++) {
+            for (int j = 0; j < totalShifts; j++) {
+                if (options.compact && !isFree(i, j)) continue;
+                if (repair.unavailable[i][j]) {
+                    cp_model.AddEquality(x[i][j], 0);
+                    continue;
+                }
+                if (!repair.inside[i][j] && !repair.hintOnly) {
+                    cp_model.AddEquality(x[i][j], base[i][j]);
+                    continue;
+                }
+                cp_model.AddHint(x[i][j], base[i][j] != 0);
+                if (base[i][j]) {
+                    changes += 1;
+                    changes -= x[i][j];
+                } else {
+                    changes += x[i][j];
+                }
+            }
+        }
+        if (repair.changeBudget >= 0) {
+            cp_model.AddLessOrEqual(changes, repair.changeBudget);
+        }
+        return changes;
+    }
+    
+    // Luật chuỗi ca dạng automaton: mỗi y tá thường một AddAutomaton trên x[i][*] với
+    // các chuyển trạng thái không vi phạm luật nào; mọi trạng thái đều là trạng thái kết thúc
+    void addSequenceAutomata(CpModelBuilder& cp_model, const vector<vector<BoolVar>>& x) {
+        vector<int> finals(sequenceDfa.numStates);
+        for (int q = 0; q < sequenceDfa.numStates; q++) finals[q] = q;
+        vector<IntVar> vars;
+        vars.reserve(totalShifts);
+        for (int i = 0; i < numNurses; i++) {
+            if (input.nurses[i].isHeadNurse) continue;
+            vars.clear();
+            for (int j = 0; j < totalShifts; j++) vars.push_back(IntVar(x[i][j]));
+            AutomatonConstraint automaton = cp_model.AddAutomaton(vars, 0, finals);
+            for (int q = 0; q < sequenceDfa.numStates; q++) {
+                for (int b = 0; b < 2; b++) {
+                    if (sequenceDfa.cost[q][b] == 0) {
+                        automaton.AddTransition(q, sequenceDfa.next[q][b], b);
+                    }
+                }
+            }
+        }
+    }
+    
+    // Ô (i, j) có thể bằng 1 không (y tá trưởng chỉ làm ca sáng, (11) ô unavailable)
+    bool isFree(int i, int j) const {
+        const Nurse& n = input.nurses[i];
+        return !(n.isHeadNurse && j % input.numShiftsPerDay != 0) && !maskBit(n.unavailable, j);
+    }
+    
+    // ==================== GREEDY HINT ====================
+    
+    // Có thể thêm ca j cho y tá i mà không vi phạm (3), (6) và luật chuỗi ca (9), (10), ...
+    // Hàng hiện tại luôn hợp lệ nên chỉ cần chạy DFA trên hàng sau khi thêm
+    bool canAdd(const vector<vector<int>>& sched, const vector<int>& worked, int i, int j) const {
+        const Nurse& n = input.nurses[i];
+        if (sched[i][j] || worked[i] >= n.maxShifts || !isFree(i, j)) return false;
+        if (n.isHeadNurse) return true;
+        vector<int> row = sched[i];
+        row[j] = 1;
+        return sequenceViolations(sequenceDfa, row) == 0;
+    }
+    
+    // Lịch greedy: phủ nhu cầu từng ca theo thứ tự thời gian (ưu tiên y tá còn thiếu
+    // ca chiều/đêm/tối thiểu rồi tới y tá ít ca nhất), sau đó bù các mức tối thiểu (2), (4), (5), (7)
+    vector<vector<int>> buildGreedySchedule() const {
+        int S = input.numShiftsPerDay;
+        vector<vector<int>> sched(numNurses, vector<int>(totalShifts, 0));
+        vector<int> worked(numNurses, 0);
+        vector<int> byType(numNurses * S, 0);   // byType[i * S + s] = số ca loại s đã làm
+        
+        auto add = [&](int i, int j) {
+            sched[i][j] = 1;
+            worked[i]++;
+            byType[i * S + j % S]++;
+        };
+        auto typeDeficit = [&](int i, int s) {
+            const Nurse& n = input.nurses[i];
+            if (n.isHeadNurse) return s == 0 ? input.minMorningShiftsHeadNurse - byType[i * S] : 0;
+            if (s == afternoonShiftType(S)) return input.minAfternoonShifts - byType[i * S + s];
+            if (s == nightShiftType(S)) return input.minNightShifts - byType[i * S + s];
+            return 0;
+        };
+        
+        vector<pair<int, int>> cand;
+        cand.reserve(numNurses);
+        for (int j = 0; j < totalShifts; j++) {
+            int s = j % S;
+            cand.clear();
+            for (int i = 0; i < numNurses; i++) {
+                if (!canAdd(sched, worked, i, j)) continue;
+                int deficit = max(0, typeDeficit(i, s)) * 4 +
+                              max(0, input.nurses[i].minShifts - worked[i]);
+                cand.emplace_back(-deficit * 100 + worked[i], i);
+            }
+            sort(cand.begin(), cand.end());
+            
+            int need = input.shifts[j].requiredNurses;
+            // Chọn trước một y tá nữ cho (8)
+            for (auto& c : cand) {
+                if (input.nurses[c.second].isFemale) {
+                    add(c.second, j);
+                    need--;
+                    break;
+                }
+            }
+            for (auto& c : cand) {
+                if (need <= 0) break;
+                if (sched[c.second][j]) continue;
+                add(c.second, j);
+                need--;
+            }
+        }
+        
+        // Bù mức tối thiểu theo loại ca rồi theo tổng ca
+        for (int i = 0; i < numNurses; i++) {
+            for (int s = 0; s < S; s++) {
+                for (int j = s; j < totalShifts && typeDeficit(i, s) > 0; j += S) {
+                    if (canAdd(sched, worked, i, j)) add(i, j);
+                }
+            }
+            for (int j = 0; j < totalShifts && worked[i] < input.nurses[i].minShifts; j++) {
+                if (canAdd(sched, worked, i, j)) add(i, j);
+            }
+        }
+        return sched;
+    }
+    
+    // Đếm số ràng buộc (1)-(12) bị vi phạm bởi một lịch
+    int countViolations(const vector<vector<int>>& sched) const {
+        int S = input.numShiftsPerDay;
+        int violations = 0;
+        
+        for (int j = 0; j < totalShifts; j++) {
+            int count = 0, female = 0;
+            for (int i = 0; i < numNurses; i++) {
+                count += sched[i][j];
+                if (input.nurses[i].isFemale) female += sched[i][j];
+            }
+            if (count < input.shifts[j].requiredNurses) violations++;   // (1)
+            if (female < 1) violations++;                                // (8)
+        }
+        
+        for (int day = 0; day < input.numDays && input.minHeadNursesPerMorning > 0; day++) {
+            int heads = 0;
+            for (int i = 0; i < numNurses; i++) {
+                if (input.nurses[i].isHeadNurse) heads += sched[i][getShiftIndex(day, 0, S)];
+            }
+            if (heads < input.minHeadNursesPerMorning) violations++;    // (7')
+        }
+        
+        for (const NSPSkillRow& row : skillCoverageRows(input.numSkills, totalShifts, input.skillDemand)) {
+            int covered = 0;
+            for (int i = 0; i < numNurses; i++) {
+                if (input.nurses[i].skills & row.skills) covered += sched[i][row.shift];
+            }
+            if (covered < row.required) violations++;                   // (12)
+        }
+        
+        for (int i = 0; i < numNurses; i++) {
+            const Nurse& n = input.nurses[i];
+            int total = 0;
+            vector<int> perType(S, 0);
+            for (int j = 0; j < totalShifts; j++) {
+                total += sched[i][j];
+                perType[j % S] += sched[i][j];
+                if (sched[i][j] && maskBit(n.unavailable, j)) violations++;   // (11)
+            }
+            if (total < n.minShifts) violations++;                       // (2)
+            if (total > n.maxShifts) violations++;                       // (3)
+            
+            if (n.isHeadNurse) {
+                if (total != perType[0]) violations++;                   // (6)
+                if (perType[0] < input.minMorningShiftsHeadNurse) violations++;  // (7)
+                continue;
+            }
+            int afternoon = afternoonShiftType(S), night = nightShiftType(S);
+            if (afternoon >= 0 && perType[afternoon] < input.minAfternoonShifts) violations++;  // (4)
+            if (night >= 0 && perType[night] < input.minNightShifts) violations++;              // (5)
+            violations += sequenceViolations(sequenceDfa, sched[i]);    // (9), (10), ...
+        }
+        return violations;
+    }
+    
+    // ==================== SYMMETRY BREAKING ====================
+    
+    // Lớp y tá hoán đổi được: cùng mọi thuộc tính ảnh hưởng tới model (trừ id, tên),
+    // kể cả mask unavailable / avoid và kỹ năng
+    vector<vector<int>> nurseClasses() const {
+        map<tuple<bool, bool, int, int, vector<uint64_t>, vector<uint64_t>, int>, vector<int>> groups;
+        for (int i = 0; i < numNurses; i++) {
+            const Nurse& n = input.nurses[i];
+            groups[make_tuple(n.isHeadNurse, n.isFemale, n.minShifts, n.maxShifts,
+                              n.unavailable, n.avoid, n.skills)].push_back(i);
+        }
+        vector<vector<int>> classes;
+        for (auto& g : groups) {
+            if (g.second.size() >= 2) classes.push_back(g.second);
+        }
+        return classes;
+    }
+    
+    // Lex dùng tổng có trọng số 2^(T-1-j), chỉ an toàn khi T <= 62; dài hơn thì về Count
+    SymmetryMode effectiveSymmetry() const {
+        if (options.symmetry == SymmetryMode::Lex && totalShifts > 62) return SymmetryMode::Count;
+        return options.symmetry;
+    }
+    
+    void addSymmetryBreaking(CpModelBuilder& cp_model, const vector<vector<BoolVar>>& x,
+                             const vector<vector<int>>& classes) const {
+        SymmetryMode mode = effectiveSymmetry();
+        vector<int64_t> weights(totalShifts);
+        for (int j = 0; j < totalShifts && mode == SymmetryMode::Lex; j++) {
+            weights[j] = int64_t(1) << (totalShifts - 1 - j);
+        }
+        
+        for (const vector<int>& members : classes) {
+            for (size_t k = 0; k + 1 < members.size(); k++) {
+                const vector<BoolVar>& a = x[members[k]];
+                const vector<BoolVar>& b = x[members[k + 1]];
+                if (mode == SymmetryMode::Lex) {
+                    cp_model.AddGreaterOrEqual(LinearExpr::WeightedSum(a, weights),
+                                               LinearExpr::WeightedSum(b, weights));
+                } else {
+                    cp_model.AddGreaterOrEqual(LinearExpr::Sum(a), LinearExpr::Sum(b));
+                }
+            }
+        }
+    }
+    
+    // Sắp lại các hàng của hint trong mỗi lớp để hint thỏa ràng buộc symmetry
+    void orderHintForSymmetry(vector<vector<int>>& hint, const vector<vector<int>>& classes) const {
+        SymmetryMode mode = effectiveSymmetry();
+        for (const vector<int>& members : classes) {
+            vector<vector<int>> rows;
+            rows.reserve(members.size());
+            for (int i : members) rows.push_back(hint[i]);
+            if (mode == SymmetryMode::Lex) {
+                sort(rows.begin(), rows.end(), greater<vector<int>>());
+            } else {
+                stable_sort(rows.begin(), rows.end(), [](const vector<int>& a, const vector<int>& b) {
+                    return accumulate(a.begin(), a.end(), 0) > accumulate(b.begin(), b.end(), 0);
+                });
+            }
+            for (size_t k = 0; k < members.size(); k++) hint[members[k]] = rows[k];
+        }
+    }
+    
+    void printModelStats(const CpModelProto& proto, double buildMs) const {
+        int linear = 0, atMostOne = 0, boolOr = 0, automaton = 0, other = 0;
+        for (int c = 0; c < proto.constraints_size(); c++) {
+            switch (proto.constraints(c).constraint_case()) {
+                case ConstraintProto::kLinear:    linear++; break;
+                case ConstraintProto::kAtMostOne: atMostOne++; break;
+                case ConstraintProto::kBoolOr:    boolOr++; break;
+                case ConstraintProto::kAutomaton: automaton++; break;
+                default:                          other++; break;
+            }
+        }
+        cout << "Model (" << (options.compact ? "compact" : "default") << "): "
+             << proto.variables_size() << " biến, "
+             << proto.constraints_size() << " ràng buộc (linear " << linear
+             << ", at_most_one " << atMostOne << ", bool_or " << boolOr
+             << ", automaton " << automaton
+             << ", khác " << other << "), build " << fixed << setprecision(2)
+             << buildMs << " ms" << endl;
+    }
+    
+public:
+    NSPSolver(const NSPInput& inp, const NSPSolverOptions& opts = NSPSolverOptions())
+        : input(inp), options(opts) {
+        numNurses = input.nurses.size();
+        totalShifts = input.numDays * input.numShiftsPerDay;
+        sequenceDfa = compileSequenceRules(input.sequenceRules, input.numShiftsPerDay);
+    }
+    
+    NSPSolution solve() {
+        return solveModel(nullptr);
+    }
+    
+    // Nạp checkpoint của --checkpoint; solve() sau đó chạy tiếp từ lời giải và bound đã lưu.
+    // CP-SAT không cho lưu trạng thái tìm kiếm bên trong (clause học được, LNS), nên resume
+    // là hint + chặn hàm mục tiêu + thời gian còn lại
+    bool loadCheckpoint(const string& path, string& error) {
+        string bytes;
+        if (!readCheckpointFile(path, bytes)) {
+            error = "cannot read " + path;
+            return false;
+        }
+        NSPByteReader r(bytes);
+        if (!readCheckpointHeader(r, NSP_CHECKPOINT_CPSAT, inputFingerprint(input), numNurses,
+                                  totalShifts, error)) {
+            return false;
+        }
+        ResumeState state;
+        int32_t numSolutions, randomSeed;
+        uint8_t optimal;
+        if (!r.get(numSolutions) || !r.get(state.objective) || !r.get(state.bound) ||
+            !r.get(state.searchMs) || !r.get(randomSeed) || !r.get(optimal) ||
+            !r.getCells(state.cells, numNurses, totalShifts) || !r.done()) {
+            error = "truncated or corrupt checkpoint";
+            return false;
+        }
+        state.active = true;
+        state.numSolutions = numSolutions;
+        state.randomSeed = randomSeed;
+        state.optimal = optimal != 0;
+        resume = std::move(state);
+        return true;
+    }
+    
+    // Sửa lịch sau sự cố: chỉ tối ưu lại vùng ±radius ca quanh các ca bị ảnh hưởng
+    // (mọi y tá), phần còn lại giữ nguyên lịch gốc. Hàm mục tiêu = chi phí + changeCost * số ô đổi.
+    // Y tá mất ca vì không làm được được giảm minShifts tương ứng. Vùng sửa nhân đôi tới
+    // khi có lời giải, phủ toàn bộ horizon hoặc hết disruption.timeLimit (mỗi lần chỉ được phần
+    // thời gian còn lại).
+    NSPSolution repair(const NSPSolution& base, const NSPDisruption& disruption) {
+        auto startTime = chrono::high_resolution_clock::now();
+        if (!base.feasible || (int)base.schedule.size() != numNurses) return base;
+        
+        NSPInput changed = input;
+        vector<char> affected(totalShifts, 0);
+        for (const auto& d : disruption.demandChanges) {
+            if (d.first < 0 || d.first >= totalShifts) continue;
+            changed.shifts[d.first].requiredNurses = d.second;
+            affected[d.first] = 1;
+        }
+        
+        RepairSpec spec;
+        spec.base = &base.schedule;
+        spec.unavailable.assign(numNurses, vector<char>(totalShifts, 0));
+        spec.changeBudget = disruption.changeBudget;
+        spec.changeCost = disruption.changeCost;
+        spec.hintOnly = disruption.hintOnly;
+        for (const auto& u : disruption.unavailable) {
+            int i = u.first, j = u.second;
+            if (i < 0 || i >= numNurses || j < 0 || j >= totalShifts || spec.unavailable[i][j]) continue;
+            spec.unavailable[i][j] = 1;
+            if (base.schedule[i][j]) {
+                Nurse& n = changed.nurses[i];
+                n.minShifts = max(0, n.minShifts - 1);
+                affected[j] = 1;
+            }
+        }
+        
+        NSPSolverOptions subOptions = options;
+        subOptions.symmetry = SymmetryMode::None;   // phá đối xứng mâu thuẫn với lịch gốc cố định
+        subOptions.hint = subOptions.fixHint = false;
+        subOptions.checkpointFile.clear();          // checkpoint chỉ dành cho lần giải chính
+        NSPSolver sub(changed, subOptions);
+        
+        NSPSolution solution;
+        solution.feasible = false;
+        for (int radius = max(1, disruption.radius); ; radius *= 2) {
+            double elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - startTime).count();
+            if (elapsed >= disruption.timeLimit) break;
+            sub.options.timeLimit = disruption.timeLimit - elapsed;
+            spec.inside.assign(numNurses, vector<char>(totalShifts, 0));
+            for (int j = 0; j < totalShifts; j++) {
+                bool near = false;
+                for (int a = max(0, j - radius); a <= min(totalShifts - 1, j + radius) && !near; a++) {
+                    near = affected[a];
+                }
+                if (near) {
+                    for (int i = 0; i < numNurses; i++) spec.inside[i][j] = 1;
+                }
+            }
+            solution = sub.solveModel(&spec);
+            if (!options.quiet) {
+                cout << "Repair ±" << radius << " ca: "
+                     << (solution.feasible ? "có lời giải" : "vô nghiệm") << endl;
+            }
+            if (solution.feasible || disruption.hintOnly || radius >= totalShifts) break;
+        }
+        
+        solution.solveTimeMs = chrono::duration<double, milli>(
+            chrono::high_resolution_clock::now() - startTime).count();
+        if (solution.feasible) {
+            solution.changedAssignments = 0;
+            for (int i = 0; i < numNurses; i++) {
+                for (int j = 0; j < totalShifts; j++) {
+                    solution.changedAssignments += solution.schedule[i][j] != base.schedule[i][j];
+                }
+            }
+        }
+        return solution;
+    }
+    
+private:
+    // Phần riêng của CP-SAT sau phần đầu NSPK:
+    //   int32 numSolutions, int64 objective, double bound, double searchMs, int32 randomSeed,
+    //   uint8 optimal, lịch tốt nhất
+    string checkpointBytes(int numSolutions, int64_t objective, double bound, double searchMs,
+                           int randomSeed, bool optimal, const vector<char>& cells) const {
+        NSPByteWriter w;
+        addCheckpointHeader(w, NSP_CHECKPOINT_CPSAT, inputFingerprint(input), numNurses, totalShifts);
+        w.add((int32_t)numSolutions);
+        w.add(objective);
+        w.add(bound);
+        w.add(searchMs);
+        w.add((int32_t)randomSeed);
+        w.add((uint8_t)optimal);
+        w.addCells(cells, numNurses, totalShifts);
+        return w.out;
+    }
+    
+    NSPSolution solveModel(const RepairSpec* repair) {
+        NSPSolution solution;
+        solution.feasible = false;
+        
+        auto startTime = chrono::high_resolution_clock::now();
         
-        // Sử dụng hệ số nguyên (nhân 100 để tránh số thực)
-        int c1 = static_cast<int>(input.costPerShift * 100);
-        int c2 = static_cast<int>(input.overtimeCost * 100);
-        int c3 = static_cast<int>(input.headNurseCost * 100);
+        // Tạo CP-SAT model
+        CpModelBuilder cp_model;
         
-        LinearExpr objective;
+        vector<vector<BoolVar>> x;
+        LinearExpr objective = options.compact ? buildCompactModel(cp_model, x)
+                                               : buildModel(cp_model, x);
+        if (options.automaton) {
+            addSequenceAutomata(cp_model, x);
+            if (!options.quiet) cout << "Automaton luật chuỗi ca: " << input.sequenceRules.size() << " luật, "
+                 << sequenceDfa.numStates << " trạng thái" << endl;
+        }
         
-        // Chi phí y tá thường
-        for (int i = 0; i < numNurses; i++) {
-            if (!input.nurses[i].isHeadNurse) {
-                for (int j = 0; j < totalShifts; j++) {
-                    objective += c1 * x[i][j];
-                }
+        // Phá đối xứng giữa các y tá hoán đổi được
+        vector<vector<int>> classes;
+        if (options.symmetry != SymmetryMode::None && !repair) {
+            classes = nurseClasses();
+            addSymmetryBreaking(cp_model, x, classes);
+            if (!options.quiet) {
+                cout << "Symmetry (" << (effectiveSymmetry() == SymmetryMode::Lex ? "lex" : "count")
+                     << "): " << classes.size() << " lớp, kích thước";
+                for (const vector<int>& c : classes) cout << " " << c.size();
+                cout << endl;
             }
         }
         
-        // Chi phí làm thêm giờ cho y tá thường
-        // overtime[i] = max(0, Σx[i][j] - N[i])
-        for (int i = 0; i < numNurses; i++) {
-            if (!input.nurses[i].isHeadNurse) {
-                IntVar overtime = cp_model.NewIntVar({0, input.nurses[i].maxShifts});
-                
-                vector<BoolVar> allShifts;
+        bool resuming = resume.active && !repair;
+        
+        // Resume: hint lời giải đã lưu (sắp lại theo lớp đối xứng như hint greedy)
+        if (resuming) {
+            vector<vector<int>> hint(numNurses, vector<int>(totalShifts, 0));
+            for (int i = 0; i < numNurses; i++) {
+                for (int j = 0; j < totalShifts; j++) hint[i][j] = resume.cells[(size_t)i * totalShifts + j];
+            }
+            if (!classes.empty()) orderHintForSymmetry(hint, classes);
+            for (int i = 0; i < numNurses; i++) {
                 for (int j = 0; j < totalShifts; j++) {
-                    allShifts.push_back(x[i][j]);
+                    if (options.compact && !isFree(i, j)) continue;
+                    cp_model.AddHint(x[i][j], hint[i][j] != 0);
                 }
-                
-                // overtime >= Σx[i][j] - N[i]
-                cp_model.AddGreaterOrEqual(
-                    overtime, 
-                    LinearExpr::Sum(allShifts) - input.nurses[i].minShifts);
-                
-                objective += c2 * overtime;
             }
         }
         
-        // Chi phí y tá trưởng
-        for (int i = 0; i < numNurses; i++) {
-            if (input.nurses[i].isHeadNurse) {
+        // Lời giải gợi ý từ greedy
+        if ((options.hint || options.fixHint) && !repair && !resuming) {
+            auto hintStart = chrono::high_resolution_clock::now();
+            vector<vector<int>> hint = buildGreedySchedule();
+            if (!classes.empty()) orderHintForSymmetry(hint, classes);
+            solution.hintViolations = countViolations(hint);
+            for (int i = 0; i < numNurses; i++) {
                 for (int j = 0; j < totalShifts; j++) {
-                    objective += c3 * x[i][j];
+                    if (options.compact && !isFree(i, j)) continue;
+                    cp_model.AddHint(x[i][j], hint[i][j] != 0);
                 }
             }
+            double hintMs = chrono::duration<double, milli>(
+                chrono::high_resolution_clock::now() - hintStart).count();
+            if (!options.quiet) cout << "Hint greedy: " << (solution.hintViolations == 0 ? "khả thi" : "KHÔNG khả thi")
+                 << " (" << solution.hintViolations << " ràng buộc vi phạm, "
+                 << fixed << setprecision(2) << hintMs << " ms)" << endl;
         }
         
+        if (repair) {
+            int changeWeight = static_cast<int>(round(repair->changeCost * 100));
+            objective += changeWeight * addRepairConstraints(cp_model, x, *repair);
+        }
+        // Lời giải đã có vẫn khả thi; bound cũ vẫn đúng vì mọi tùy chọn model giữ giá trị tối ưu
+        if (resuming) {
+            cp_model.AddLessOrEqual(objective, resume.objective);
+            cp_model.AddGreaterOrEqual(objective, (int64_t)ceil(resume.bound - 1e-6));
+        }
         cp_model.Minimize(objective);
         
+        const CpModelProto& proto = cp_model.Build();
+        auto buildEnd = chrono::high_resolution_clock::now();
+        solution.numVariables = proto.variables_size();
+        solution.numConstraints = proto.constraints_size();
+        if (!options.quiet) {
+            printModelStats(proto, chrono::duration<double, milli>(buildEnd - startTime).count());
+        }
+        
         // ==================== GIẢI BÀI TOÁN ====================
         SatParameters parameters;
-        parameters.set_max_time_in_seconds(300.0);  // Timeout 5 phút
-        parameters.set_num_search_workers(4);       // Đa luồng
+        parameters.set_max_time_in_seconds(options.timeLimit);  // Mặc định 5 phút
+        parameters.set_num_search_workers(options.numWorkers);  // Đa luồng
+        if (options.fixHint) {
+            parameters.set_fix_variables_to_their_hinted_value(true);
+        }
+        if (options.symmetryLevel >= 0) {
+            parameters.set_symmetry_level(options.symmetryLevel);
+        }
+        int randomSeed = options.randomSeed >= 0 ? options.randomSeed : (resuming ? resume.randomSeed : -1);
+        if (randomSeed >= 0) {
+            parameters.set_random_seed(randomSeed);
+        }
+        // Resume: chỉ dùng phần còn lại của giới hạn thời gian; hết giờ hoặc đã tối ưu thì
+        // cố định biến theo lời giải đã lưu (trả lại ngay lời giải đó)
+        bool resumeFinished = false;
+        if (resuming) {
+            double remaining = options.timeLimit - resume.searchMs / 1000.0;
+            resumeFinished = resume.optimal || remaining <= 0;
+            if (resumeFinished) {
+                parameters.set_fix_variables_to_their_hinted_value(true);
+            } else {
+                parameters.set_max_time_in_seconds(remaining);
+            }
+            if (!options.quiet) {
+                cout << "Resume: " << resume.numSolutions << " lời giải, cost " << fixed << setprecision(2)
+                     << resume.objective / 100.0 << ", bound " << resume.bound / 100.0 << ", đã tìm "
+                     << resume.searchMs / 1000.0 << " s"
+                     << (resumeFinished ? " (đã xong)" : "") << endl;
+            }
+        }
+        
+        // Model và tham số ghi trước khi giải: lần giải bị dừng giữa chừng vẫn replay được
+        if (!options.dumpPrefix.empty() &&
+            (!writeProtoFile(options.dumpPrefix + ".model.pb", proto) ||
+             !writeProtoFile(options.dumpPrefix + ".params.pb", parameters))) {
+            cerr << "Cannot write " << options.dumpPrefix << ".{model,params}.pb" << endl;
+        }
         
-        CpSolverResponse response = SolveWithParameters(cp_model.Build(), parameters);
+        CpSolverResponse response;
+        auto searchStart = chrono::high_resolution_clock::now();
+        bool printStream = (options.stream || !options.streamFile.empty()) && !options.quiet;
+        solution.pool = NSPSolutionPool(options.poolSize, options.poolDistance, numNurses, totalShifts);
+        // Checkpoint: observer chỉ dựng buffer, thread của writer ghi file; lời giải dồn dập
+        // lúc đầu được gộp (writer chỉ giữ buffer mới nhất)
+        unique_ptr<NSPCheckpointWriter> checkpoint;
+        if (!options.checkpointFile.empty() && !repair) {
+            checkpoint.reset(new NSPCheckpointWriter(options.checkpointFile));
+        }
+        double priorSearchMs = resuming ? resume.searchMs : 0;
+        int numSolutions = resuming ? resume.numSolutions : 0;
+        if (options.stream || !options.streamFile.empty() || options.recordTrace || options.progress ||
+            options.poolSize > 0 || checkpoint) {
+            // Anytime: observer được gọi (tuần tự) mỗi khi CP-SAT tìm được lời giải tốt hơn
+            vector<char> cells;
+            atomic<bool> stopRequested(false);
+            vector<uint64_t> poolWords;
+            Model model;
+            model.Add(NewSatParameters(parameters));
+            model.GetOrCreate<TimeLimit>()->RegisterExternalBooleanAsLimit(&stopRequested);
+            model.Add(NewFeasibleSolutionObserver([&](const CpSolverResponse& r) {
+                numSolutions++;
+                auto now = chrono::high_resolution_clock::now();
+                double t = chrono::duration<double, milli>(now - startTime).count();
+                double cost = r.objective_value() / 100.0;
+                double bound = r.best_objective_bound() / 100.0;
+                double gap = cost > 0 ? 100.0 * (cost - bound) / cost : 0.0;
+                double searchT = chrono::duration<double, milli>(now - searchStart).count();
+                if (options.recordTrace) solution.trace.emplace_back(searchT, cost);
+                if (options.progress && !options.progress(searchT, cost)) stopRequested = true;
+                // Chỉ đóng gói lời giải khi nó còn có thể vào pool
+                if (solution.pool.admits(0, cost)) {
+                    int wordsPerRow = solution.pool.wordsPerRow();
+                    poolWords.assign(solution.pool.numWords(), 0);
+                    for (int i = 0; i < numNurses; i++) {
+                        for (int j = 0; j < totalShifts; j++) {
+                            if (SolutionBooleanValue(r, x[i][j])) {
+                                poolWords[(size_t)i * wordsPerRow + j / 64] |= uint64_t(1) << (j % 64);
+                            }
+                        }
+                    }
+                    solution.pool.offer(poolWords.data(), 0, cost);
+                }
+                if (checkpoint) {
+                    cells.assign((size_t)numNurses * totalShifts, 0);
+                    for (int i = 0; i < numNurses; i++) {
+                        for (int j = 0; j < totalShifts; j++) {
+                            cells[(size_t)i * totalShifts + j] = SolutionBooleanValue(r, x[i][j]);
+                        }
+                    }
+                    checkpoint->submit(checkpointBytes(numSolutions, llround(r.objective_value()),
+                                                       r.best_objective_bound(), priorSearchMs + searchT,
+                                                       randomSeed, false, cells));
+                }
+                if (printStream) cout << "  [" << fixed << setprecision(0) << setw(8) << t << " ms] #"
+                     << numSolutions << " cost " << setprecision(2) << cost
+                     << "  bound " << bound << "  gap " << gap << "%" << endl;
+                
+                if (!options.streamFile.empty()) {
+                    vector<vector<int>> sched(numNurses, vector<int>(totalShifts, 0));
+                    for (int i = 0; i < numNurses; i++) {
+                        for (int j = 0; j < totalShifts; j++) {
+                            sched[i][j] = SolutionBooleanValue(r, x[i][j]) ? 1 : 0;
+                        }
+                    }
+                    if (!writeScheduleAtomic(options.streamFile, input, sched, cost, bound, t)) {
+                        cerr << "Cannot write " << options.streamFile << endl;
+                    }
+                }
+            }));
+            response = SolveCpModel(proto, &model);
+        } else {
+            response = SolveWithParameters(proto, parameters);
+        }
+        if (!options.dumpPrefix.empty() &&
+            !writeProtoFile(options.dumpPrefix + ".response.pb", response)) {
+            cerr << "Cannot write " << options.dumpPrefix << ".response.pb" << endl;
+        }
         
         auto endTime = chrono::high_resolution_clock::now();
         solution.solveTimeMs = chrono::duration<double, milli>(endTime - startTime).count();
+        solution.searchMs = chrono::duration<double, milli>(endTime - searchStart).count();
         
         // ==================== XỬ LÝ KẾT QUẢ ====================
         if (response.status() == CpSolverStatus::OPTIMAL || 
             response.status() == CpSolverStatus::FEASIBLE) {
             
             solution.feasible = true;
+            solution.optimal = response.status() == CpSolverStatus::OPTIMAL;
+            solution.bestBound = response.best_objective_bound() / 100.0;
             solution.schedule.resize(numNurses, vector<int>(totalShifts, 0));
             
-            double normalCost = 0, overtimeCost = 0, headNurseCost = 0;
+            double normalCost = 0, overtimeCost = 0, headNurseCost = 0, preferenceCost = 0;
             
             for (int i = 0; i < numNurses; i++) {
                 int totalWorked = 0;
@@ -303,6 +1428,7 @@ public:
                     if (SolutionBooleanValue(response, x[i][j])) {
                         solution.schedule[i][j] = 1;
                         totalWorked++;
+                        if (maskBit(input.nurses[i].avoid, j)) preferenceCost += input.preferenceCost;
                         
                         if (input.nurses[i].isHeadNurse) {
                             headNurseCost += input.headNurseCost;
@@ -322,7 +1448,29 @@ public:
             solution.normalCost = normalCost;
             solution.overtimeCost = overtimeCost;
             solution.headNurseCost = headNurseCost;
-            solution.totalCost = normalCost + overtimeCost + headNurseCost;
+            solution.preferenceCost = preferenceCost;
+            solution.totalCost = normalCost + overtimeCost + headNurseCost + preferenceCost;
+            if (resumeFinished) {
+                // Model đã cố định theo lời giải lưu: trạng thái và bound lấy từ checkpoint
+                solution.optimal = resume.optimal;
+                solution.bestBound = resume.bound / 100.0;
+            }
+        }
+        
+        // Checkpoint cuối mang bound và trạng thái tối ưu khi kết thúc
+        if (checkpoint) {
+            if (solution.feasible) {
+                vector<char> cells((size_t)numNurses * totalShifts);
+                for (int i = 0; i < numNurses; i++) {
+                    for (int j = 0; j < totalShifts; j++) cells[(size_t)i * totalShifts + j] = solution.schedule[i][j];
+                }
+                double bound = resumeFinished ? resume.bound : response.best_objective_bound();
+                checkpoint->submit(checkpointBytes(numSolutions, llround(response.objective_value()), bound,
+                                                   priorSearchMs + solution.searchMs, randomSeed,
+                                                   solution.optimal, cells));
+            }
+            checkpoint->flush();
+            solution.checkpointWrites = checkpoint->written();
         }
         
         return solution;
@@ -331,6 +1479,39 @@ public:
 
 // ==================== HIỂN THỊ KẾT QUẢ ====================
 
+// Thống kê lịch, tính trong một lượt qua ma trận lịch
+struct ScheduleStats {
+    vector<int> perNurse;     // Số ca mỗi y tá
+    vector<int> perShift;     // Số y tá mỗi ca
+    vector<int> histogram;    // histogram[k] = số y tá làm đúng k ca (k = 0..totalShifts)
+};
+
+ScheduleStats computeScheduleStats(const NSPInput& input, const NSPSolution& solution) {
+    int numNurses = input.nurses.size();
+    int totalShifts = input.numDays * input.numShiftsPerDay;
+    ScheduleStats stats;
+    stats.perNurse.assign(numNurses, 0);
+    stats.perShift.assign(totalShifts, 0);
+    stats.histogram.assign(totalShifts + 1, 0);
+    for (int i = 0; i < numNurses; i++) {
+        const vector<int>& row = solution.schedule[i];
+        int count = 0;
+        for (int j = 0; j < totalShifts; j++) {
+            count += row[j];
+            stats.perShift[j] += row[j];
+        }
+        stats.perNurse[i] = count;
+        stats.histogram[count]++;
+    }
+    return stats;
+}
+
+// Căn phải trong width byte (như setw cho chuỗi)
+void appendPadded(string& out, const string& text, size_t width) {
+    if (text.size() < width) out.append(width - text.size(), ' ');
+    out += text;
+}
+
 void printSchedule(const NSPInput& input, const NSPSolution& solution) {
     if (!solution.feasible) {
         cout << "Không tìm được lời giải khả thi!" << endl;
@@ -339,102 +1520,261 @@ void printSchedule(const NSPInput& input, const NSPSolution& solution) {
     
     int numNurses = input.nurses.size();
     int totalShifts = input.numDays * input.numShiftsPerDay;
+    ScheduleStats stats = computeScheduleStats(input, solution);
     
-    cout << "\n" << string(80, '=') << endl;
-    cout << "              LỊCH LÀM VIỆC Y TÁ - NURSE SCHEDULING PROBLEM" << endl;
-    cout << string(80, '=') << endl;
+    // Dựng toàn bộ bảng trong một buffer rồi ghi một lần
+    string out;
+    out.reserve((size_t)(numNurses + input.numDays + 40) * (24 + 8 * input.numDays));
+    string rule = string(15, '-') + "-+";
+    for (int day = 0; day < input.numDays; day++) rule += "-------+";
+    rule += "------+\n";
     
-    // Header
-    cout << setw(15) << "Y tá" << " |";
-    for (int day = 0; day < input.numDays; day++) {
-        cout << " " << getDayName(day) << " |";
-    }
-    cout << " Tổng |" << endl;
+    out += "\n" + string(80, '=') + "\n";
+    out += "              LỊCH LÀM VIỆC Y TÁ - NURSE SCHEDULING PROBLEM\n";
+    out += string(80, '=') + "\n";
     
-    cout << string(15, '-') << "-+";
+    // Header
+    appendPadded(out, "Y tá", 15);
+    out += " |";
     for (int day = 0; day < input.numDays; day++) {
-        cout << "-------+";
+        out += " ";
+        out += getDayName(day);
+        out += " |";
     }
-    cout << "------+" << endl;
+    out += " Tổng |\n";
+    out += rule;
     
     // Mỗi y tá
+    string shifts;
     for (int i = 0; i < numNurses; i++) {
-        cout << setw(15) << input.nurses[i].name << " |";
-        
-        int totalWorked = 0;
+        appendPadded(out, input.nurses[i].name, 15);
+        out += " |";
         for (int day = 0; day < input.numDays; day++) {
-            string shifts = "";
+            shifts.clear();
             for (int s = 0; s < input.numShiftsPerDay; s++) {
-                int idx = getShiftIndex(day, s, input.numShiftsPerDay);
-                if (solution.schedule[i][idx]) {
-                    shifts += (s == 0 ? "S" : (s == 1 ? "C" : "D"));
-                    totalWorked++;
+                if (solution.schedule[i][getShiftIndex(day, s, input.numShiftsPerDay)]) {
+                    shifts += getShiftLetter(s, input.numShiftsPerDay);
                 }
             }
             if (shifts.empty()) shifts = "-";
-            cout << setw(6) << shifts << " |";
+            appendPadded(out, shifts, 6);
+            out += " |";
         }
-        cout << setw(5) << totalWorked << " |" << endl;
+        appendPadded(out, to_string(stats.perNurse[i]), 5);
+        out += " |\n";
     }
-    
-    cout << string(15, '-') << "-+";
-    for (int day = 0; day < input.numDays; day++) {
-        cout << "-------+";
-    }
-    cout << "------+" << endl;
+    out += rule;
     
     // Thống kê số y tá mỗi ca
-    cout << "\n" << string(60, '-') << endl;
-    cout << "THỐNG KÊ SỐ Y TÁ MỖI CA:" << endl;
-    cout << setw(10) << "Ngày" << " | " << setw(10) << "Sáng" 
-         << " | " << setw(10) << "Chiều" << " | " << setw(10) << "Đêm" << endl;
-    cout << string(60, '-') << endl;
-    
+    out += "\n" + string(60, '-') + "\n";
+    out += "THỐNG KÊ SỐ Y TÁ MỖI CA:\n";
+    appendPadded(out, "Ngày", 10);
+    for (int s = 0; s < input.numShiftsPerDay; s++) {
+        char letter = getShiftLetter(s, input.numShiftsPerDay);
+        out += " | ";
+        appendPadded(out, letter == 'S' ? "Sáng" : letter == 'C' ? "Chiều"
+                        : letter == 'D' ? "Đêm" : "Ca " + to_string(s), 10);
+    }
+    out += "\n" + string(60, '-') + "\n";
     for (int day = 0; day < input.numDays; day++) {
-        cout << setw(10) << getDayName(day) << " |";
+        appendPadded(out, getDayName(day), 10);
+        out += " |";
         for (int s = 0; s < input.numShiftsPerDay; s++) {
-            int idx = getShiftIndex(day, s, input.numShiftsPerDay);
-            int count = 0;
-            for (int i = 0; i < numNurses; i++) {
-                count += solution.schedule[i][idx];
-            }
-            cout << setw(10) << count << " |";
+            appendPadded(out, to_string(stats.perShift[getShiftIndex(day, s, input.numShiftsPerDay)]), 10);
+            out += " |";
         }
-        cout << endl;
+        out += "\n";
     }
     
     // Chi phí
-    cout << "\n" << string(60, '=') << endl;
-    cout << "THỐNG KÊ CHI PHÍ:" << endl;
-    cout << string(60, '-') << endl;
-    cout << fixed << setprecision(2);
-    cout << "  Chi phí ca thường:    " << setw(15) << solution.normalCost << endl;
-    cout << "  Chi phí làm thêm:     " << setw(15) << solution.overtimeCost << endl;
-    cout << "  Chi phí y tá trưởng:  " << setw(15) << solution.headNurseCost << endl;
-    cout << string(60, '-') << endl;
-    cout << "  TỔNG CHI PHÍ:         " << setw(15) << solution.totalCost << endl;
-    cout << string(60, '=') << endl;
-    
-    cout << "\nThời gian giải: " << solution.solveTimeMs << " ms" << endl;
+    char line[128];
+    out += "\n" + string(60, '=') + "\n";
+    out += "THỐNG KÊ CHI PHÍ:\n";
+    out += string(60, '-') + "\n";
+    snprintf(line, sizeof(line), "  Chi phí ca thường:    %15.2f\n", solution.normalCost);
+    out += line;
+    snprintf(line, sizeof(line), "  Chi phí làm thêm:     %15.2f\n", solution.overtimeCost);
+    out += line;
+    snprintf(line, sizeof(line), "  Chi phí y tá trưởng:  %15.2f\n", solution.headNurseCost);
+    out += line;
+    if (solution.preferenceCost > 0) {
+        snprintf(line, sizeof(line), "  Phạt ca muốn tránh:   %15.2f\n", solution.preferenceCost);
+        out += line;
+    }
+    out += string(60, '-') + "\n";
+    snprintf(line, sizeof(line), "  TỔNG CHI PHÍ:         %15.2f\n", solution.totalCost);
+    out += line;
+    out += string(60, '=') + "\n";
+    snprintf(line, sizeof(line), "\nThời gian giải: %.2f ms\n", solution.solveTimeMs);
+    out += line;
     
     // Phân bố số ca
-    cout << "\n" << string(40, '-') << endl;
-    cout << "PHÂN BỐ SỐ CA LÀM VIỆC:" << endl;
-    vector<int> shiftDistribution(20, 0);
+    out += "\n" + string(40, '-') + "\n";
+    out += "PHÂN BỐ SỐ CA LÀM VIỆC:\n";
+    for (int k = 0; k <= totalShifts; k++) {
+        if (stats.histogram[k] > 0) {
+            snprintf(line, sizeof(line), "  %d ca: %d y tá (%.1f%%)\n", k, stats.histogram[k],
+                     100.0 * stats.histogram[k] / numNurses);
+            out += line;
+        }
+    }
+    
+    cout.write(out.data(), out.size());
+    cout.flush();
+}
+
+// ==================== XUẤT LỊCH ====================
+
+// Các writer định dạng thẳng vào một buffer cấp phát trước theo kích thước ước lượng,
+// rồi ghi file bằng một lệnh fwrite
+
+string jsonEscape(const string& s) {
+    string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+            continue;
+        }
+        out += c;
+    }
+    return out;
+}
+
+bool writeBuffer(const string& path, const char* data, size_t size) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data, 1, size, f) == size;
+    return fclose(f) == 0 && ok;
+}
+
+void appendInt(string& out, long long value) {
+    char buf[24];
+    auto res = to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr - buf);
+}
+
+void appendFixed(string& out, double value) {
+    char buf[48];
+    int n = snprintf(buf, sizeof(buf), "%.2f", value);
+    out.append(buf, n);
+}
+
+// CSV: nurse,s0,...,s{T-1},total — mỗi ô 0/1
+bool exportScheduleCsv(const string& path, const NSPInput& input, const NSPSolution& solution,
+                       const ScheduleStats& stats) {
+    int numNurses = input.nurses.size();
+    int totalShifts = input.numDays * input.numShiftsPerDay;
+    size_t nameBytes = 0;
+    for (const Nurse& n : input.nurses) nameBytes += n.name.size();
+    
+    string out;
+    out.reserve(16 + 8 * (size_t)totalShifts + nameBytes + (size_t)numNurses * (2 * totalShifts + 16));
+    out += "nurse";
+    for (int j = 0; j < totalShifts; j++) {
+        out += ",s";
+        appendInt(out, j);
+    }
+    out += ",total\n";
     for (int i = 0; i < numNurses; i++) {
-        int count = 0;
+        out += input.nurses[i].name;
+        const vector<int>& row = solution.schedule[i];
         for (int j = 0; j < totalShifts; j++) {
-            count += solution.schedule[i][j];
+            out += ',';
+            out += row[j] ? '1' : '0';
+        }
+        out += ',';
+        appendInt(out, stats.perNurse[i]);
+        out += '\n';
+    }
+    return writeBuffer(path, out.data(), out.size());
+}
+
+// Nhị phân (little-endian trên máy x86/ARM thông dụng):
+//   char[4] "NSPB", uint32 version = 1, uint32 numNurses, uint32 numShifts,
+//   uint32 shiftsPerDay, uint32 wordsPerRow, double totalCost,
+//   rồi numNurses hàng, mỗi hàng wordsPerRow uint64, bit (j % 64) của word j / 64 = ca j
+bool exportScheduleBinary(const string& path, const NSPInput& input, const NSPSolution& solution) {
+    uint32_t numNurses = input.nurses.size();
+    uint32_t totalShifts = input.numDays * input.numShiftsPerDay;
+    uint32_t wordsPerRow = (totalShifts + 63) / 64;
+    uint32_t header[6] = {0, 1, numNurses, totalShifts, (uint32_t)input.numShiftsPerDay, wordsPerRow};
+    memcpy(header, "NSPB", 4);
+    
+    size_t headerBytes = sizeof(header) + sizeof(double);
+    vector<uint64_t> words((size_t)numNurses * wordsPerRow, 0);
+    for (uint32_t i = 0; i < numNurses; i++) {
+        uint64_t* row = words.data() + (size_t)i * wordsPerRow;
+        for (uint32_t j = 0; j < totalShifts; j++) {
+            if (solution.schedule[i][j]) row[j / 64] |= uint64_t(1) << (j % 64);
         }
-        shiftDistribution[count]++;
     }
-    for (int s = 0; s < 20; s++) {
-        if (shiftDistribution[s] > 0) {
-            double percent = 100.0 * shiftDistribution[s] / numNurses;
-            cout << "  " << s << " ca: " << shiftDistribution[s] 
-                 << " y tá (" << fixed << setprecision(1) << percent << "%)" << endl;
+    
+    vector<char> out(headerBytes + words.size() * sizeof(uint64_t));
+    memcpy(out.data(), header, sizeof(header));
+    memcpy(out.data() + sizeof(header), &solution.totalCost, sizeof(double));
+    if (!words.empty()) {
+        memcpy(out.data() + headerBytes, words.data(), words.size() * sizeof(uint64_t));
+    }
+    return writeBuffer(path, out.data(), out.size());
+}
+
+// JSON: chi phí, nhu cầu đáp ứng mỗi ca, và mỗi y tá danh sách chỉ số ca được xếp
+bool exportScheduleJson(const string& path, const NSPInput& input, const NSPSolution& solution,
+                        const ScheduleStats& stats) {
+    int numNurses = input.nurses.size();
+    int totalShifts = input.numDays * input.numShiftsPerDay;
+    size_t assigned = 0, nameBytes = 0;
+    for (int i = 0; i < numNurses; i++) {
+        assigned += stats.perNurse[i];
+        nameBytes += input.nurses[i].name.size();
+    }
+    
+    string out;
+    out.reserve(256 + 12 * (size_t)totalShifts + nameBytes + 80 * (size_t)numNurses + 7 * assigned);
+    out += "{\"total_cost\":";
+    appendFixed(out, solution.totalCost);
+    out += ",\"normal_cost\":";
+    appendFixed(out, solution.normalCost);
+    out += ",\"overtime_cost\":";
+    appendFixed(out, solution.overtimeCost);
+    out += ",\"head_cost\":";
+    appendFixed(out, solution.headNurseCost);
+    out += ",\"preference_cost\":";
+    appendFixed(out, solution.preferenceCost);
+    out += ",\"num_days\":";
+    appendInt(out, input.numDays);
+    out += ",\"shifts_per_day\":";
+    appendInt(out, input.numShiftsPerDay);
+    out += ",\"coverage\":[";
+    for (int j = 0; j < totalShifts; j++) {
+        if (j) out += ',';
+        appendInt(out, stats.perShift[j]);
+    }
+    out += "],\"nurses\":[";
+    for (int i = 0; i < numNurses; i++) {
+        const Nurse& n = input.nurses[i];
+        if (i) out += ',';
+        out += "\n{\"name\":\"";
+        out += jsonEscape(n.name);
+        out += "\",\"head\":";
+        out += n.isHeadNurse ? "true" : "false";
+        out += ",\"total\":";
+        appendInt(out, stats.perNurse[i]);
+        out += ",\"shifts\":[";
+        bool first = true;
+        for (int j = 0; j < totalShifts; j++) {
+            if (!solution.schedule[i][j]) continue;
+            if (!first) out += ',';
+            first = false;
+            appendInt(out, j);
         }
+        out += "]}";
     }
+    out += "]}\n";
+    return writeBuffer(path, out.data(), out.size());
 }
 
 // ==================== TẠO DỮ LIỆU MẪU ====================
@@ -453,6 +1793,7 @@ NSPInput createSampleData() {
     input.costPerShift = 100;        // c1
     input.overtimeCost = 150;        // c2 = 1.5 * c1
     input.headNurseCost = 120;       // c3
+    input.sequenceRules = defaultSequenceRules();
     
     // Tạo y tá (mô phỏng bệnh viện trong bài báo)
     // 6 y tá trưởng + 40 y tá thường
@@ -521,6 +1862,7 @@ NSPInput createSmallTestData() {
     input.costPerShift = 1;
     input.overtimeCost = 1.5;
     input.headNurseCost = 1.2;
+    input.sequenceRules = defaultSequenceRules();
     
     // 2 y tá trưởng + 10 y tá thường
     for (int i = 0; i < 2; i++) {
@@ -559,9 +1901,535 @@ NSPInput createSmallTestData() {
     return input;
 }
 
+// ==================== ĐỌC INSTANCE TỪ FILE ====================
+
+// NSPInstance (nsp_backend.h) sang NSPInput: tên y tá lấy từ file text nếu có, nhu cầu kỹ năng
+// cộng qua các khoa (y tá điều động tự do), luật chuỗi ca mặc định
+NSPInput inputFromInstance(const NSPInstance& inst) {
+    NSPInput input;
+    input.numDays = inst.numDays;
+    input.numShiftsPerDay = inst.shiftsPerDay;
+    int words = inst.maskWords();
+    for (size_t i = 0; i < inst.nurses.size(); i++) {
+        const NSPNurse& n = inst.nurses[i];
+        Nurse nurse;
+        nurse.id = n.id;
+        nurse.name = i < inst.nurseNames.size() ? inst.nurseNames[i] : "YT" + to_string(n.id);
+        nurse.isHeadNurse = n.isHead;
+        nurse.isFemale = n.isFemale;
+        nurse.minShifts = (int)n.minShift;
+        nurse.maxShifts = (int)n.maxShift;
+        nurse.skills = n.skills;
+        if (!inst.unavailable.empty()) {
+            nurse.unavailable.assign(&inst.unavailable[i * words], &inst.unavailable[i * words] + words);
+        }
+        if (!inst.avoid.empty()) {
+            nurse.avoid.assign(&inst.avoid[i * words], &inst.avoid[i * words] + words);
+        }
+        input.nurses.push_back(nurse);
+    }
+    for (int day = 0; day < inst.numDays; day++) {
+        for (int s = 0; s < inst.shiftsPerDay; s++) {
+            input.shifts.push_back({day, s, inst.demandFor(day * inst.shiftsPerDay + s)});
+        }
+    }
+    input.minAfternoonShifts = inst.minAfternoon;
+    input.minNightShifts = inst.minNight;
+    input.minMorningShiftsHeadNurse = inst.minMorningPerHead;
+    input.minHeadNursesPerMorning = inst.minHeadPerMorning;
+    input.costPerShift = inst.costNormal;
+    input.overtimeCost = inst.costOvertime - inst.costNormal;   // c2 cộng thêm vào c1
+    input.headNurseCost = inst.costHead;
+    input.preferenceCost = inst.costPreference;
+    input.numSkills = inst.skillDemand.empty() ? 0 : inst.numSkills;
+    input.skillDemand = inst.skillDemand.empty() ? vector<int>() : inst.skillDemandByShift();
+    input.sequenceRules = defaultSequenceRules();
+    return input;
+}
+
+// Chiều ngược lại cho "base" của file text: nhu cầu theo loại ca lấy từ ngày đầu
+NSPInstance instanceFromInput(const NSPInput& input) {
+    NSPInstance inst;
+    inst.numDays = input.numDays;
+    inst.shiftsPerDay = input.numShiftsPerDay;
+    for (const Nurse& n : input.nurses) {
+        int i = inst.nurses.size();
+        inst.nurses.push_back({i, n.isHeadNurse, n.isFemale, (double)n.minShifts, (double)n.maxShifts,
+                               (uint8_t)n.skills});
+        inst.nurseNames.push_back(n.name);
+        for (int j = 0; j < inst.totalShifts(); j++) {
+            if (maskBit(n.unavailable, j)) inst.setMaskBit(inst.unavailable, i, j);
+            if (maskBit(n.avoid, j)) inst.setMaskBit(inst.avoid, i, j);
+        }
+    }
+    for (int s = 0; s < input.numShiftsPerDay; s++) inst.demand.push_back(input.shifts[s].requiredNurses);
+    inst.minAfternoon = input.minAfternoonShifts;
+    inst.minNight = input.minNightShifts;
+    inst.minMorningPerHead = input.minMorningShiftsHeadNurse;
+    inst.minHeadPerMorning = input.minHeadNursesPerMorning;
+    inst.costNormal = input.costPerShift;
+    inst.costOvertime = input.costPerShift + input.overtimeCost;
+    inst.costHead = input.headNurseCost;
+    inst.costPreference = input.preferenceCost;
+    if (!input.skillDemand.empty()) {
+        inst.numWards = 1;
+        inst.numSkills = input.numSkills;
+        inst.skillDemand = input.skillDemand;
+    }
+    return inst;
+}
+
+// Định dạng text: readInstanceText của nsp_backend.h (dùng chung với nsp_validate), thêm:
+//   base small|sample                  bắt đầu từ bộ dữ liệu có sẵn (tùy chọn)
+//   rule pattern 1?1 [ANCHOR]          luật chuỗi ca (dòng rule đầu tiên thay luật mặc định)
+//   rule window 5 2 [ANCHOR]
+bool readInstanceFile(const string& path, NSPInput& input, string& error) {
+    vector<SequenceRule> rules;
+    auto extraKey = [&rules](const string& key, istream& ls, NSPInstance& inst, bool& ok) {
+        if (key == "base") {
+            string name;
+            ok = bool(ls >> name) && (name == "small" || name == "sample");
+            if (ok) inst = instanceFromInput(name == "sample" ? createSampleData() : createSmallTestData());
+            return true;
+        }
+        if (key != "rule") return false;
+        SequenceRule r;
+        string kind;
+        ok = bool(ls >> kind);
+        if (ok && kind == "pattern") {
+            ok = bool(ls >> r.pattern) && r.pattern.find_first_not_of("1?") == string::npos;
+        } else if (ok && kind == "window") {
+            ok = bool(ls >> r.window >> r.maxWorked) && r.window > 0;
+        } else {
+            ok = false;
+        }
+        if (ok) {
+            if (!(ls >> r.anchorType)) r.anchorType = -1;
+            rules.push_back(r);
+        }
+        return true;
+    };
+    NSPInstance inst;
+    if (!readInstanceText(path, inst, error, extraKey)) return false;
+    input = inputFromInstance(inst);
+    if (!rules.empty()) input.sequenceRules = rules;
+    return true;
+}
+
+// ==================== BATCH MODE ====================
+
+// Danh sách instance: thư mục (mọi file *.nsp, sắp theo tên) hoặc manifest
+// (mỗi dòng một đường dẫn, tương đối theo thư mục chứa manifest)
+vector<string> listInstances(const string& path) {
+    namespace fs = std::filesystem;
+    vector<string> files;
+    error_code ec;
+    if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::directory_iterator(path, ec)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".nsp") {
+                files.push_back(entry.path().string());
+            }
+        }
+        sort(files.begin(), files.end());
+        return files;
+    }
+    
+    ifstream in(path);
+    fs::path base = fs::path(path).parent_path();
+    string line;
+    while (getline(in, line)) {
+        size_t hash = line.find('#');
+        if (hash != string::npos) line.erase(hash);
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty()) continue;
+        fs::path p(line);
+        files.push_back((p.is_absolute() ? p : base / p).string());
+    }
+    return files;
+}
+
+// Chia lõi: jobs instance chạy song song, mỗi instance workers CP-SAT worker.
+// Mặc định giữ ~4 worker/instance (CP-SAT tận dụng portfolio tốt ở mức này)
+// và dùng phần lõi còn lại cho song song mức instance.
+void splitCores(int numInstances, int cores, int& jobs, int& workers) {
+    cores = max(1, cores);
+    if (jobs <= 0 && workers <= 0) {
+        workers = min(4, cores);
+        jobs = max(1, min(numInstances, cores / workers));
+        workers = max(1, cores / jobs);
+    } else if (jobs <= 0) {
+        jobs = max(1, min(numInstances, cores / workers));
+    } else if (workers <= 0) {
+        workers = max(1, cores / jobs);
+    }
+}
+
+// Giải mọi instance, mỗi instance một dòng JSON (JSON Lines) ghi ra out theo thứ tự hoàn thành
+int runBatch(const string& path, NSPSolverOptions options, int jobs, const string& outFile) {
+    vector<string> files = listInstances(path);
+    if (files.empty()) {
+        cerr << "No instances in " << path << endl;
+        return 1;
+    }
+    
+    int cores = thread::hardware_concurrency();
+    splitCores(files.size(), cores, jobs, options.numWorkers);
+    options.quiet = true;
+    options.stream = false;
+    options.streamFile.clear();
+    if (!options.dumpPrefix.empty()) {
+        error_code ec;
+        std::filesystem::create_directories(options.dumpPrefix, ec);
+    }
+    
+    ofstream fileOut;
+    if (!outFile.empty()) {
+        fileOut.open(outFile);
+        if (!fileOut) {
+            cerr << "Cannot write " << outFile << endl;
+            return 1;
+        }
+    }
+    ostream& out = outFile.empty() ? cout : fileOut;
+    cerr << "Batch: " << files.size() << " instance, " << jobs << " song song x "
+         << options.numWorkers << " worker (" << cores << " lõi)" << endl;
+    
+    atomic<size_t> nextIndex(0);
+    atomic<int> numFailed(0);
+    mutex outMutex;
+    auto startTime = chrono::high_resolution_clock::now();
+    
+    auto worker = [&]() {
+        for (size_t k = nextIndex++; k < files.size(); k = nextIndex++) {
+            NSPInput input;
+            string error;
+            ostringstream rec;
+            rec << fixed << setprecision(2);
+            rec << "{\"instance\":\"" << jsonEscape(files[k]) << "\"";
+            if (!readInstanceFile(files[k], input, error)) {
+                numFailed++;
+                rec << ",\"status\":\"ERROR\",\"error\":\"" << jsonEscape(error) << "\"}";
+            } else {
+                NSPSolverOptions instanceOptions = options;
+                if (!options.dumpPrefix.empty()) {
+                    // Batch: --dump-model là thư mục, mỗi instance một bộ file theo tên instance
+                    instanceOptions.dumpPrefix = (std::filesystem::path(options.dumpPrefix) /
+                        std::filesystem::path(files[k]).stem()).string();
+                }
+                NSPSolution solution = NSPSolver(input, instanceOptions).solve();
+                const char* status = solution.optimal ? "OPTIMAL"
+                                   : solution.feasible ? "FEASIBLE" : "NO_SOLUTION";
+                if (!solution.feasible) numFailed++;
+                rec << ",\"status\":\"" << status << "\""
+                    << ",\"nurses\":" << input.nurses.size()
+                    << ",\"shifts\":" << input.numDays * input.numShiftsPerDay
+                    << ",\"workers\":" << options.numWorkers
+                    << ",\"solve_ms\":" << solution.solveTimeMs;
+                if (solution.feasible) {
+                    rec << ",\"total_cost\":" << solution.totalCost
+                        << ",\"best_bound\":" << solution.bestBound
+                        << ",\"normal_cost\":" << solution.normalCost
+                        << ",\"overtime_cost\":" << solution.overtimeCost
+                        << ",\"head_cost\":" << solution.headNurseCost
+                        << ",\"preference_cost\":" << solution.preferenceCost;
+                }
+                rec << "}";
+            }
+            lock_guard<mutex> lock(outMutex);
+            out << rec.str() << "\n";
+            out.flush();
+        }
+    };
+    
+    vector<thread> threads;
+    for (int t = 0; t < jobs; t++) threads.emplace_back(worker);
+    for (thread& t : threads) t.join();
+    
+    double totalMs = chrono::duration<double, milli>(
+        chrono::high_resolution_clock::now() - startTime).count();
+    cerr << "Batch xong: " << files.size() - numFailed << "/" << files.size()
+         << " có lời giải, " << fixed << setprecision(0) << totalMs << " ms" << endl;
+    return numFailed > 0 ? 2 : 0;
+}
+
+// ==================== BENCHMARK SỐ WORKER ====================
+
+vector<int> parseIntList(const string& text) {
+    vector<int> values;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == string::npos) comma = text.size();
+        if (comma > pos) values.push_back(atoi(text.substr(pos, comma - pos).c_str()));
+        pos = comma + 1;
+    }
+    return values;
+}
+
+struct WorkerBenchRun {
+    int workers;
+    int seed;
+    NSPSolution solution;
+};
+
+// Thời điểm (ms) đầu tiên trace đạt chi phí <= target, -1 nếu không đạt
+double timeToReach(const vector<pair<double, double>>& trace, double target) {
+    for (const auto& p : trace) {
+        if (p.second <= target + 1e-9) return p.first;
+    }
+    return -1;
+}
+
+// Trung vị của các giá trị >= 0 (-1 nếu không có)
+double medianOf(vector<double> values) {
+    values.erase(remove_if(values.begin(), values.end(), [](double v) { return v < 0; }),
+                 values.end());
+    if (values.empty()) return -1;
+    sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+// Lưới (số worker × seed) trên cùng một instance. Đo từ lúc bắt đầu tìm kiếm:
+// lời giải đầu tiên, lời giải trong 1% của chi phí tốt nhất mọi lần chạy, chứng minh tối ưu.
+// Bảng in trung vị theo seed (cột OPT = số lần chạy chứng minh được tối ưu).
+void runWorkerBench(const NSPInput& input, NSPSolverOptions options,
+                    const vector<int>& workerList, int numSeeds) {
+    options.quiet = true;
+    options.stream = false;
+    options.streamFile.clear();
+    options.recordTrace = true;
+    int baseSeed = max(0, options.randomSeed);
+    
+    vector<WorkerBenchRun> runs;
+    double best = numeric_limits<double>::infinity();
+    for (int workers : workerList) {
+        for (int r = 0; r < numSeeds; r++) {
+            options.numWorkers = workers;
+            options.randomSeed = baseSeed + r;
+            NSPSolution solution = NSPSolver(input, options).solve();
+            if (solution.feasible) best = min(best, solution.totalCost);
+            cerr << "  workers " << workers << " seed " << options.randomSeed << ": "
+                 << (solution.optimal ? "OPTIMAL" : solution.feasible ? "FEASIBLE" : "NO_SOLUTION")
+                 << " " << fixed << setprecision(0) << solution.searchMs << " ms" << endl;
+            runs.push_back({workers, options.randomSeed, solution});
+        }
+    }
+    
+    cout << "\n--- WORKER SCALING (" << numSeeds << " seed mỗi mức, seed = "
+         << baseSeed << " + r, best = " << fixed << setprecision(2) << best << ") ---" << endl;
+    cout << setw(8) << "WORKERS" << setw(12) << "FIRST_MS" << setw(12) << "WITHIN1%_MS"
+         << setw(12) << "OPTIMAL_MS" << setw(12) << "TOTAL_MS" << setw(10) << "SPEEDUP"
+         << setw(6) << "OPT" << setw(14) << "BEST_COST" << endl;
+    
+    double baseTotal = 0;
+    for (int workers : workerList) {
+        vector<double> first, within, optimal, total;
+        int numOptimal = 0;
+        double bestCost = numeric_limits<double>::infinity();
+        for (const WorkerBenchRun& run : runs) {
+            if (run.workers != workers) continue;
+            const NSPSolution& s = run.solution;
+            first.push_back(s.trace.empty() ? -1 : s.trace.front().first);
+            within.push_back(timeToReach(s.trace, best * 1.01));
+            optimal.push_back(s.optimal ? s.searchMs : -1);
+            total.push_back(s.searchMs);
+            numOptimal += s.optimal;
+            if (s.feasible) bestCost = min(bestCost, s.totalCost);
+        }
+        double medTotal = medianOf(total);
+        if (baseTotal == 0) baseTotal = medTotal;
+        
+        auto cell = [](double v) {
+            ostringstream os;
+            if (v < 0) os << "-";
+            else os << fixed << setprecision(1) << v;
+            return os.str();
+        };
+        cout << setw(8) << workers << setw(12) << cell(medianOf(first))
+             << setw(12) << cell(medianOf(within)) << setw(12) << cell(medianOf(optimal))
+             << setw(12) << cell(medTotal)
+             << setw(10) << fixed << setprecision(2) << (medTotal > 0 ? baseTotal / medTotal : 0.0)
+             << setw(4) << numOptimal << "/" << numSeeds
+             << setw(14) << bestCost << endl;
+    }
+    cout << "(trung vị theo seed; '-' = không lần chạy nào đạt; SPEEDUP theo TOTAL_MS so với dòng đầu)" << endl;
+}
+
+} // namespace nsp_cpsat
+
+// ==================== BACKEND ====================
+
+class CpSatBackend : public NSPBackend {
+    nsp_cpsat::NSPInput input;
+    NSPBackendResult result;
+    NSPBackendStats runStats;
+
+public:
+    const char* name() const override { return "cpsat"; }
+
+    // Chuyển NSPInstance sang NSPInput; model CP-SAT được dựng trong NSPSolver::solve
+    // nên thời gian dựng model được cộng vào buildMs sau khi giải
+    bool build(const NSPInstance& inst) override {
+        using namespace nsp_cpsat;
+        auto t0 = chrono::high_resolution_clock::now();
+        input = inputFromInstance(inst);
+        
+        runStats = NSPBackendStats();
+        runStats.buildMs = chrono::duration<double, milli>(
+            chrono::high_resolution_clock::now() - t0).count();
+        return true;
+    }
+    
+    bool solve(double timeLimitSec) override {
+        using namespace nsp_cpsat;
+        NSPSolverOptions options;
+        options.quiet = true;
+        options.progress = progress;
+        if (timeLimitSec > 0) options.timeLimit = timeLimitSec;
+        NSPSolution sol = NSPSolver(input, options).solve();
+        
+        runStats.buildMs += sol.solveTimeMs - sol.searchMs;
+        runStats.solveMs = sol.searchMs;
+        runStats.numVariables = sol.numVariables;
+        runStats.numConstraints = sol.numConstraints;
+        runStats.status = sol.optimal ? "OPTIMAL" : sol.feasible ? "FEASIBLE" : "NO_SOLUTION";
+        result.feasible = sol.feasible;
+        result.optimal = sol.optimal;
+        result.cost = sol.totalCost;
+        int totalShifts = input.numDays * input.numShiftsPerDay;
+        result.schedule.assign(input.nurses.size() * (size_t)totalShifts, 0);
+        for (size_t i = 0; i < sol.schedule.size(); i++) {
+            for (int j = 0; j < totalShifts; j++) {
+                result.schedule[i * totalShifts + j] = (char)sol.schedule[i][j];
+            }
+        }
+        return true;
+    }
+    
+    const NSPBackendResult& solution() const override { return result; }
+    const NSPBackendStats& stats() const override { return runStats; }
+};
+
+unique_ptr<NSPBackend> makeCpSatBackend() {
+    return unique_ptr<NSPBackend>(new CpSatBackend());
+}
+
 // ==================== MAIN ====================
 
-int main() {
+#ifndef NSP_BACKEND_ONLY
+int main(int argc, char** argv) {
+    using namespace nsp_cpsat;
+    NSPSolverOptions options;
+    string dataset, instanceFile, batchPath, batchOut, repairSpec;
+    int changeBudget = -1;
+    double repairTimeLimit = 1.0;
+    vector<int> benchWorkers;
+    int benchSeeds = 3;
+    string exportCsv, exportBin, exportJson, poolOut, resumeFile;
+    bool print = true;
+    int jobs = 0;
+    options.numWorkers = 0;      // 0 = tự chọn (4 khi giải một instance)
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--compact") {
+            options.compact = true;
+        } else if (arg == "--hint") {
+            options.hint = true;
+        } else if (arg == "--fix-hint") {
+            options.fixHint = true;
+        } else if (arg == "--symmetry" && a + 1 < argc) {
+            string mode = argv[++a];
+            if (mode == "none") options.symmetry = SymmetryMode::None;
+            else if (mode == "count") options.symmetry = SymmetryMode::Count;
+            else if (mode == "lex") options.symmetry = SymmetryMode::Lex;
+            else {
+                cerr << "Unknown symmetry mode: " << mode << endl;
+                return 1;
+            }
+        } else if (arg == "--symmetry-level" && a + 1 < argc) {
+            options.symmetryLevel = atoi(argv[++a]);
+        } else if (arg == "--stream") {
+            options.stream = true;
+        } else if (arg == "--stream-file" && a + 1 < argc) {
+            options.streamFile = argv[++a];
+        } else if (arg == "--automaton") {
+            options.automaton = true;
+        } else if (arg == "--dataset" && a + 1 < argc) {
+            dataset = argv[++a];
+        } else if (arg == "--instance" && a + 1 < argc) {
+            instanceFile = argv[++a];
+        } else if (arg == "--batch" && a + 1 < argc) {
+            batchPath = argv[++a];
+        } else if (arg == "--jobs" && a + 1 < argc) {
+            jobs = atoi(argv[++a]);
+        } else if (arg == "--workers" && a + 1 < argc) {
+            options.numWorkers = atoi(argv[++a]);
+        } else if (arg == "--time-limit" && a + 1 < argc) {
+            options.timeLimit = atof(argv[++a]);
+        } else if (arg == "--out" && a + 1 < argc) {
+            batchOut = argv[++a];
+        } else if (arg == "--seed" && a + 1 < argc) {
+            options.randomSeed = atoi(argv[++a]);
+        } else if (arg == "--bench-workers" && a + 1 < argc) {
+            benchWorkers = parseIntList(argv[++a]);
+        } else if (arg == "--bench-seeds" && a + 1 < argc) {
+            benchSeeds = max(1, atoi(argv[++a]));
+        } else if (arg == "--export-csv" && a + 1 < argc) {
+            exportCsv = argv[++a];
+        } else if (arg == "--export-bin" && a + 1 < argc) {
+            exportBin = argv[++a];
+        } else if (arg == "--export-json" && a + 1 < argc) {
+            exportJson = argv[++a];
+        } else if (arg == "--no-print") {
+            print = false;
+        } else if (arg == "--dump-model" && a + 1 < argc) {
+            options.dumpPrefix = argv[++a];
+        } else if (arg == "--repair" && a + 1 < argc) {
+            repairSpec = argv[++a];
+        } else if (arg == "--change-budget" && a + 1 < argc) {
+            changeBudget = atoi(argv[++a]);
+        } else if (arg == "--repair-time-limit" && a + 1 < argc) {
+            repairTimeLimit = atof(argv[++a]);
+        } else if (arg == "--pool" && a + 1 < argc) {
+            options.poolSize = atoi(argv[++a]);
+        } else if (arg == "--pool-distance" && a + 1 < argc) {
+            options.poolDistance = atoi(argv[++a]);
+        } else if (arg == "--pool-out" && a + 1 < argc) {
+            poolOut = argv[++a];
+        } else if (arg == "--checkpoint" && a + 1 < argc) {
+            options.checkpointFile = argv[++a];
+        } else if (arg == "--resume" && a + 1 < argc) {
+            resumeFile = argv[++a];
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            cerr << "Usage: " << argv[0] << " [--compact] [--hint] [--fix-hint]"
+                 << " [--symmetry none|count|lex] [--symmetry-level 0-4]"
+                 << " [--stream] [--stream-file FILE] [--automaton]"
+                 << " [--dataset small|sample | --instance FILE]"
+                 << " [--batch DIR|MANIFEST [--jobs N] [--out FILE]]"
+                 << " [--workers N] [--time-limit S]"
+                 << " [--repair I:A-B[,...] [--change-budget K] [--repair-time-limit S]]"
+                 << " [--dump-model PREFIX] [--seed N]"
+                 << " [--bench-workers 1,2,4,... [--bench-seeds R]]"
+                 << " [--export-csv FILE] [--export-bin FILE] [--export-json FILE] [--no-print]"
+                 << " [--pool K [--pool-distance D] [--pool-out PREFIX]]"
+                 << " [--checkpoint FILE] [--resume FILE]" << endl;
+            return 1;
+        }
+    }
+    
+    if (!resumeFile.empty() && options.checkpointFile.empty()) options.checkpointFile = resumeFile;
+    if (!options.checkpointFile.empty() && (!batchPath.empty() || !benchWorkers.empty())) {
+        cerr << "--checkpoint / --resume need a single instance (not --batch / --bench-workers)" << endl;
+        return 1;
+    }
+    if (!batchPath.empty()) {
+        return runBatch(batchPath, options, jobs, batchOut);
+    }
+    if (options.numWorkers <= 0) options.numWorkers = 4;
+
     cout << R"(
 ╔═══════════════════════════════════════════════════════════════════════════════╗
 ║     NURSE SCHEDULING PROBLEM - Multi-Commodity Network Flow Model             ║
@@ -569,17 +2437,28 @@ int main() {
 ╚═══════════════════════════════════════════════════════════════════════════════╝
 )" << endl;
 
-    // Chọn dữ liệu test
-    cout << "Chọn bộ dữ liệu:" << endl;
-    cout << "  1. Dữ liệu nhỏ (12 y tá, 7 ngày) - Test nhanh" << endl;
-    cout << "  2. Dữ liệu thực tế (46 y tá, 7 ngày) - Theo bài báo" << endl;
-    cout << "Nhập lựa chọn (1 hoặc 2): ";
-    
-    int choice;
-    cin >> choice;
-    
     NSPInput input;
-    if (choice == 2) {
+    int choice = 0;
+    if (!instanceFile.empty()) {
+        string error;
+        if (!readInstanceFile(instanceFile, input, error)) {
+            cerr << error << endl;
+            return 1;
+        }
+    } else if (!dataset.empty()) {
+        choice = dataset == "sample" ? 2 : 1;
+    } else {
+        // Chọn dữ liệu test
+        cout << "Chọn bộ dữ liệu:" << endl;
+        cout << "  1. Dữ liệu nhỏ (12 y tá, 7 ngày) - Test nhanh" << endl;
+        cout << "  2. Dữ liệu thực tế (46 y tá, 7 ngày) - Theo bài báo" << endl;
+        cout << "Nhập lựa chọn (1 hoặc 2): ";
+        cin >> choice;
+    }
+    
+    if (!instanceFile.empty()) {
+        cout << "Instance: " << instanceFile << endl;
+    } else if (choice == 2) {
         cout << "\nĐang tạo dữ liệu theo case study bài báo..." << endl;
         input = createSampleData();
     } else {
@@ -591,12 +2470,71 @@ int main() {
     cout << "Số ca: " << input.numDays * input.numShiftsPerDay << endl;
     cout << "Số biến: " << input.nurses.size() * input.numDays * input.numShiftsPerDay << endl;
     
+    if (!benchWorkers.empty()) {
+        runWorkerBench(input, options, benchWorkers, benchSeeds);
+        return 0;
+    }
+    
     cout << "\nĐang giải bài toán..." << endl;
     
-    NSPSolver solver(input);
+    NSPSolver solver(input, options);
+    if (!resumeFile.empty()) {
+        string error;
+        if (!solver.loadCheckpoint(resumeFile, error)) {
+            cerr << resumeFile << ": " << error << endl;
+            return 1;
+        }
+    }
     NSPSolution solution = solver.solve();
     
-    printSchedule(input, solution);
+    if (print) printSchedule(input, solution);
+    if (!options.checkpointFile.empty()) {
+        cout << "CHECKPOINT_WRITES=" << solution.checkpointWrites << endl;
+    }
+    
+    if (solution.feasible && !(exportCsv.empty() && exportBin.empty() && exportJson.empty())) {
+        auto exportStart = chrono::high_resolution_clock::now();
+        ScheduleStats stats = computeScheduleStats(input, solution);
+        bool ok = true;
+        if (!exportCsv.empty() && !exportScheduleCsv(exportCsv, input, solution, stats)) {
+            cerr << "Cannot write " << exportCsv << endl;
+            ok = false;
+        }
+        if (!exportBin.empty() && !exportScheduleBinary(exportBin, input, solution)) {
+            cerr << "Cannot write " << exportBin << endl;
+            ok = false;
+        }
+        if (!exportJson.empty() && !exportScheduleJson(exportJson, input, solution, stats)) {
+            cerr << "Cannot write " << exportJson << endl;
+            ok = false;
+        }
+        cout << "EXPORT_MS=" << fixed << setprecision(2) << chrono::duration<double, milli>(
+            chrono::high_resolution_clock::now() - exportStart).count() << endl;
+        if (!ok) return 1;
+    }
+    
+    if (solution.pool.size() > 0) {
+        vector<const NSPPoolEntry*> ranked = solution.pool.ranked();
+        cout << "\n--- POOL (" << ranked.size() << " lời giải, cách nhau >= "
+             << solution.pool.minDistance() << " ô) ---" << endl;
+        for (size_t k = 0; k < ranked.size(); k++) {
+            cout << "  #" << k + 1 << " cost " << fixed << setprecision(2) << ranked[k]->cost
+                 << ", distance to #1 "
+                 << solution.pool.distance(ranked[0]->words.data(), ranked[k]->words.data()) << endl;
+        }
+        cout << "POOL_SIZE=" << solution.pool.size() << endl;
+        cout << "POOL_MIN_DISTANCE=" << solution.pool.minPairDistance() << endl;
+        cout << "POOL_OFFERED=" << solution.pool.offered() << endl;
+        cout << "POOL_DISTANCE_CHECKS=" << solution.pool.distanceChecks() << endl;
+        if (!poolOut.empty()) {
+            int written = solution.pool.exportBinary(poolOut, input.numShiftsPerDay);
+            if (written < 0) {
+                cerr << "Cannot write " << poolOut << ".*.bin" << endl;
+                return 1;
+            }
+            cout << "POOL_FILES=" << written << endl;
+        }
+    }
     
     if (solution.feasible) {
         cout << "\n✓ Tìm được lời giải tối ưu!" << endl;
@@ -604,5 +2542,37 @@ int main() {
         cout << "\n✗ Không tìm được lời giải khả thi!" << endl;
     }
     
+    if (!repairSpec.empty() && solution.feasible) {
+        NSPDisruption disruption;
+        disruption.changeBudget = changeBudget;
+        disruption.timeLimit = repairTimeLimit;
+        stringstream items(repairSpec);
+        string item;
+        while (getline(items, item, ',')) {
+            int nurse, from, to;
+            if (sscanf(item.c_str(), "%d:%d-%d", &nurse, &from, &to) == 3) {
+                for (int j = from; j <= to; j++) disruption.unavailable.emplace_back(nurse, j);
+            } else if (sscanf(item.c_str(), "%d:%d", &nurse, &from) == 2) {
+                disruption.unavailable.emplace_back(nurse, from);
+            } else {
+                cerr << "Invalid --repair item: " << item << endl;
+                return 1;
+            }
+        }
+        
+        cout << "\nĐang sửa lịch sau sự cố (" << disruption.unavailable.size() << " ô)..." << endl;
+        NSPSolution repaired = solver.repair(solution, disruption);
+        if (repaired.feasible) {
+            if (print) printSchedule(input, repaired);
+            cout << "REPAIR_STATUS=" << (repaired.optimal ? "OPTIMAL" : "FEASIBLE") << endl;
+            cout << "REPAIR_CHANGES=" << repaired.changedAssignments << endl;
+            cout << "REPAIR_COST=" << fixed << setprecision(2) << repaired.totalCost << endl;
+            cout << "REPAIR_MS=" << repaired.solveTimeMs << endl;
+        } else {
+            cout << "REPAIR_STATUS=INFEASIBLE" << endl;
+        }
+    }
+    
     return 0;
-}
\ No newline at end of file
+}
+#endif
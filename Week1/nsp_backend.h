@@ -0,0 +1,684 @@
+/**
+ * Nurse Scheduling Problem (NSP) - instance chung và giao diện backend
+ *
+ * Dùng chung bởi nsp.cpp (CP-SAT), nsp_highs.cpp (HiGHS) và nsp_standalone.cpp (heuristic),
+ * để mọi backend giải cùng một instance và được chấm bằng cùng một hàm (evaluateSchedule).
+ * Mỗi file backend cung cấp một factory make*Backend(); biên dịch với -DNSP_BACKEND_ONLY
+ * để bỏ main() khi link chung vào nsp_bench.
+ *
+ * Ô lịch: schedule[i * totalShifts + j], j = day * shiftsPerDay + s
+ * (s = 0 sáng, 1 chiều, 2 đêm; các backend HiGHS/heuristic yêu cầu shiftsPerDay = 3)
+ * Instance lớn lưu ở định dạng nhị phân NSPI (writeInstanceBinary / readInstanceBinary),
+ * sinh bởi nsp_gen; instance nhỏ viết tay ở định dạng text (readInstanceText, dùng chung
+ * cho nsp --instance và nsp_validate).
+ *
+ * Mask theo y tá (unavailable, avoid): numNurses * maskWords() word uint64, hàng i bắt đầu ở
+ * word i * maskWords(), ca j là bit j % 64 của word j / 64 (cùng bố cục với lịch bit-packed).
+ *
+ * Kỹ năng (#12): mỗi y tá có tập kỹ năng dạng bitmask (tối đa NSP_MAX_SKILLS), nhu cầu cho theo
+ * (khoa, kỹ năng, ca). Y tá điều động tự do giữa các khoa nên chỉ tổng theo (kỹ năng, ca) ảnh hưởng
+ * tới tính khả thi: model không cần biến theo khoa. Một y tá phủ tối đa một suất trong ca, nên
+ * điều kiện đủ người là điều kiện Hall trên mọi tập kỹ năng K có nhu cầu trong ca:
+ * số y tá làm ca j có ít nhất một kỹ năng thuộc K >= tổng nhu cầu của K (skillCoverageRows).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cerrno>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+const int NSP_MAX_SKILLS = 8;
+
+// Cùng bố cục với struct Nurse cũ của nsp_highs / nsp_standalone
+struct NSPNurse {
+    int id;
+    bool isHead;
+    bool isFemale;
+    double minShift;
+    double maxShift;
+    uint8_t skills = 0;               // bit k = có kỹ năng k (#12)
+};
+
+struct NSPInstance {
+    std::string name;
+    int numDays = 7;
+    int shiftsPerDay = 3;
+    std::vector<NSPNurse> nurses;
+    std::vector<int> demand;          // #1  nhu cầu theo loại ca (size = shiftsPerDay)
+    std::vector<int> demandAt;        // #1  nhu cầu từng ca (size = totalShifts), rỗng = theo demand
+    int minAfternoon = 0;             // #4  ca chiều tối thiểu mỗi y tá thường
+    int minNight = 0;                 // #5  ca đêm tối thiểu mỗi y tá thường
+    int minHeadPerMorning = 0;        // #7  số y tá trưởng tối thiểu mỗi ca sáng (Rust/Python/HiGHS)
+    int minMorningPerHead = 0;        // #7' số ca sáng tối thiểu mỗi y tá trưởng (bài báo, nsp.cpp)
+    double costNormal = 0;            // chi phí một ca y tá thường
+    double costOvertime = 0;          // chi phí một ca vượt minShift (thay cho costNormal)
+    double costHead = 0;              // chi phí một ca y tá trưởng
+    std::vector<uint64_t> unavailable;  // #11 ô y tá không làm được (nghỉ phép, đào tạo), rỗng = không có
+    std::vector<uint64_t> avoid;        // ô y tá muốn tránh, rỗng = không có
+    double costPreference = 0;        // phạt mỗi ca làm rơi vào ô avoid
+    int numWards = 0;                 // #12 số khoa, 0 = không có nhu cầu theo kỹ năng
+    int numSkills = 0;                // #12 số kỹ năng (<= NSP_MAX_SKILLS)
+    std::vector<int> skillDemand;     // #12 [(ward * numSkills + skill) * totalShifts + j]
+    std::vector<std::string> nurseNames;  // tên y tá trong file text, rỗng = không có
+
+    int totalShifts() const { return numDays * shiftsPerDay; }
+    int demandFor(int j) const { return demandAt.empty() ? demand[j % shiftsPerDay] : demandAt[j]; }
+    int maskWords() const { return (totalShifts() + 63) / 64; }
+    bool maskBit(const std::vector<uint64_t>& mask, int i, int j) const {
+        return !mask.empty() && ((mask[(size_t)i * maskWords() + j / 64] >> (j % 64)) & 1);
+    }
+    bool isUnavailable(int i, int j) const { return maskBit(unavailable, i, j); }
+    bool isAvoided(int i, int j) const { return maskBit(avoid, i, j); }
+    int skillDemandAt(int ward, int skill, int j) const {
+        return skillDemand[((size_t)ward * numSkills + skill) * totalShifts() + j];
+    }
+    // Nhu cầu kỹ năng cộng qua mọi khoa: [skill * totalShifts + j]
+    std::vector<int> skillDemandByShift() const {
+        int T = totalShifts();
+        std::vector<int> total((size_t)numSkills * T, 0);
+        for (int w = 0; w < numWards; w++) {
+            for (int k = 0; k < numSkills; k++) {
+                for (int j = 0; j < T; j++) total[k * T + j] += skillDemandAt(w, k, j);
+            }
+        }
+        return total;
+    }
+    // Bật bit (i, j); mask rỗng được cấp phát theo số y tá hiện có
+    void setMaskBit(std::vector<uint64_t>& mask, int i, int j) const {
+        if (mask.empty()) mask.assign(nurses.size() * (size_t)maskWords(), 0);
+        mask[(size_t)i * maskWords() + j / 64] |= uint64_t(1) << (j % 64);
+    }
+};
+
+// Instance tham chiếu của bản Rust/Python (Week8) và nsp_highs / nsp_standalone:
+// numHead y tá trưởng (nữ, 5-9 ca), còn lại y tá thường (6-9 ca, nữ từ y tá thường thứ 664).
+// Giữ tỉ lệ mặc định khi thu nhỏ để benchmark nhanh.
+inline NSPInstance makeReferenceInstance(int numNurses = 1983, int numHead = 1234) {
+    NSPInstance inst;
+    inst.name = "reference-" + std::to_string(numNurses);
+    double scale = numNurses / 1983.0;
+    for (int i = 0; i < numHead; i++) {
+        inst.nurses.push_back({i, true, true, 5.0, 9.0});
+    }
+    int firstFemale = (int)(664 * scale);
+    for (int i = 0; i < numNurses - numHead; i++) {
+        inst.nurses.push_back({i + numHead, false, i >= firstFemale, 6.0, 9.0});
+    }
+    inst.demand = {(int)(542 * scale), (int)(438 * scale), (int)(225 * scale)};
+    inst.minAfternoon = 2;
+    inst.minNight = 1;
+    inst.minHeadPerMorning = (int)(150 * scale);
+    inst.costNormal = 1000.0;
+    inst.costOvertime = 1200.0;
+    inst.costHead = 1500.0;
+    return inst;
+}
+
+// Hàng Hall của #12: ca j cần >= required y tá có ít nhất một kỹ năng trong skills
+struct NSPSkillRow {
+    int shift;
+    uint8_t skills;
+    int required;
+};
+
+// Mọi tập con khác rỗng của các kỹ năng có nhu cầu trong từng ca (tối đa 2^NSP_MAX_SKILLS - 1
+// hàng mỗi ca), theo thứ tự ca; byShift = nhu cầu theo [skill * T + j] (skillDemandByShift)
+inline std::vector<NSPSkillRow> skillCoverageRows(int numSkills, int T, const std::vector<int>& byShift) {
+    std::vector<NSPSkillRow> rows;
+    for (int j = 0; j < T && numSkills > 0; j++) {
+        unsigned demanded = 0;
+        for (int k = 0; k < numSkills; k++) {
+            if (byShift[k * T + j] > 0) demanded |= 1u << k;
+        }
+        for (unsigned K = demanded; K; K = (K - 1) & demanded) {
+            int required = 0;
+            for (int k = 0; k < numSkills; k++) {
+                if (K >> k & 1) required += byShift[k * T + j];
+            }
+            rows.push_back({j, (uint8_t)K, required});
+        }
+    }
+    return rows;
+}
+
+inline std::vector<NSPSkillRow> skillCoverageRows(const NSPInstance& inst) {
+    return skillCoverageRows(inst.numSkills, inst.totalShifts(), inst.skillDemandByShift());
+}
+
+// Số y tá phủ từng hàng Hall từ histogram tập kỹ năng của y tá làm ca: hist[j * 256 + skills]
+inline void skillRowCover(const std::vector<NSPSkillRow>& rows, const std::vector<int>& hist,
+                          std::vector<int>& cover) {
+    cover.assign(rows.size(), 0);
+    for (size_t r = 0; r < rows.size(); r++) {
+        const int* h = &hist[(size_t)rows[r].shift * 256];
+        for (int m = 1; m < 256; m++) {
+            if (m & rows[r].skills) cover[r] += h[m];
+        }
+    }
+}
+
+// Chấm một lịch theo #1-#12 của instance: trả về số ràng buộc vi phạm,
+// *cost = chi phí theo định nghĩa chung (ca thường, ca vượt minShift, ca y tá trưởng,
+// phạt ô avoid)
+inline int evaluateSchedule(const NSPInstance& inst, const std::vector<char>& schedule,
+                            double* cost) {
+    int T = inst.totalShifts(), S = inst.shiftsPerDay;
+    int numNurses = inst.nurses.size();
+    int violations = 0;
+    double total = 0;
+    std::vector<int> cover(T, 0), female(T, 0), headMorning(inst.numDays, 0);
+    std::vector<NSPSkillRow> skillRows = skillCoverageRows(inst);
+    std::vector<int> skillHist(skillRows.empty() ? 0 : (size_t)T * 256, 0), skillCover;
+
+    for (int i = 0; i < numNurses; i++) {
+        const NSPNurse& n = inst.nurses[i];
+        const char* row = schedule.data() + (size_t)i * T;
+        int worked = 0, afternoon = 0, night = 0, morning = 0;
+        for (int j = 0; j < T; j++) {
+            if (!row[j]) continue;
+            worked++;
+            cover[j]++;
+            if (!skillHist.empty()) skillHist[(size_t)j * 256 + n.skills]++;
+            if (inst.isUnavailable(i, j)) violations++;                         // #11
+            if (inst.isAvoided(i, j)) total += inst.costPreference;
+            if (n.isFemale) female[j]++;
+            int s = j % S;
+            if (s == 0) morning++;
+            if (s == 1) afternoon++;
+            if (s == S - 1 && S > 1) night++;
+            if (n.isHead && s == 0) headMorning[j / S]++;
+        }
+        if (worked < n.minShift) violations++;                                  // #2
+        if (worked > n.maxShift) violations++;                                  // #3
+        if (n.isHead) {
+            if (worked != morning) violations++;                                // #6
+            if (morning < inst.minMorningPerHead) violations++;                 // #7'
+            total += worked * inst.costHead;
+            continue;
+        }
+        if (S >= 3 && afternoon < inst.minAfternoon) violations++;              // #4
+        if (S >= 2 && night < inst.minNight) violations++;                      // #5
+        for (int j = 0; j + 2 < T; j++) {
+            if (row[j] && row[j + 2]) violations++;                             // #9
+        }
+        for (int j = 0; j + 4 < T; j++) {
+            if (row[j] + row[j + 1] + row[j + 2] + row[j + 3] + row[j + 4] > 2) violations++;  // #10
+        }
+        int overtime = worked > n.minShift ? worked - (int)n.minShift : 0;
+        total += (worked - overtime) * inst.costNormal + overtime * inst.costOvertime;
+    }
+    for (int j = 0; j < T; j++) {
+        if (cover[j] < inst.demandFor(j)) violations++;                         // #1
+        if (female[j] < 1) violations++;                                        // #8
+    }
+    for (int d = 0; d < inst.numDays; d++) {
+        if (headMorning[d] < inst.minHeadPerMorning) violations++;             // #7
+    }
+    skillRowCover(skillRows, skillHist, skillCover);
+    for (size_t r = 0; r < skillRows.size(); r++) {
+        if (skillCover[r] < skillRows[r].required) violations++;               // #12
+    }
+    if (cost) *cost = total;
+    return violations;
+}
+
+// ==================== HASH ====================
+
+// FNV-1a 64 bit: tag cache model của nsp_highs, dấu vân tay instance của checkpoint
+struct NSPHasher {
+    uint64_t h = 1469598103934665603ULL;
+    void mix(const void* data, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        for (size_t k = 0; k < len; k++) {
+            h ^= p[k];
+            h *= 1099511628211ULL;
+        }
+    }
+    template <class T>
+    void add(const T& value) { mix(&value, sizeof(T)); }
+};
+
+// ==================== GHI FILE ATOMIC ====================
+
+// fsync file tmp đã ghi xong, rename đè lên PATH rồi fsync thư mục chứa PATH: bên đọc chỉ thấy
+// file cũ hoặc file mới đầy đủ, kể cả khi máy bị preempt ngay sau đó (page cache chưa xuống đĩa)
+inline bool commitFileAtomic(const std::string& tmp, const std::string& path) {
+#if !defined(_WIN32)
+    int fd = open(tmp.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    if (!ok) return false;
+#endif
+    if (rename(tmp.c_str(), path.c_str()) != 0) return false;
+#if !defined(_WIN32)
+    size_t slash = path.find_last_of('/');
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    fd = open(dir.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    // Một số filesystem không hỗ trợ fsync thư mục (EINVAL): rename vẫn atomic, bỏ qua
+    ok = fsync(fd) == 0 || errno == EINVAL;
+    close(fd);
+    return ok;
+#else
+    return true;
+#endif
+}
+
+// Ghi PATH.tmp rồi commitFileAtomic
+inline bool writeFileAtomic(const std::string& path, const void* data, size_t len) {
+    std::string tmp = path + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = fwrite(data, 1, len, f) == len;
+    ok = fclose(f) == 0 && ok;
+    return ok && commitFileAtomic(tmp, path);
+}
+
+// ==================== FILE INSTANCE NHỊ PHÂN ====================
+
+// Little-endian:
+//   char[4] "NSPI", uint32 version = 2, uint32 numNurses, uint32 numDays, uint32 shiftsPerDay,
+//   uint32 flags (bit 0: có demandAt, bit 1: có mask unavailable, bit 2: có mask avoid,
+//   bit 3: có nhu cầu kỹ năng),
+//   int32 minAfternoon, minNight, minHeadPerMorning, minMorningPerHead,
+//   double costNormal, costOvertime, costHead, costPreference (v1 không có costPreference),
+//   int32 demand[shiftsPerDay], [int32 demandAt[numDays * shiftsPerDay]],
+//   [int32 numWards, numSkills, skillDemand[numWards * numSkills * numDays * shiftsPerDay]],
+//   rồi numNurses bản ghi NSPNurseRecord (8 byte, id = thứ tự trong file), mỗi bản ghi theo sau
+//   bởi [uint64 unavailable[maskWords]] [uint64 avoid[maskWords]] nếu flags có bit tương ứng
+//   (mask nằm cạnh bản ghi để nsp_gen ghi dạng stream). Đọc được cả file version 1.
+struct NSPNurseRecord {
+    uint8_t flags;                    // bit 0 trưởng, bit 1 nữ
+    uint8_t skills;                   // #12, 0 ở file cũ
+    uint16_t minShift;
+    uint16_t maxShift;
+    uint16_t reserved2;
+};
+
+inline NSPNurseRecord toNurseRecord(const NSPNurse& n) {
+    NSPNurseRecord r = {};
+    r.flags = (n.isHead ? 1 : 0) | (n.isFemale ? 2 : 0);
+    r.skills = n.skills;
+    r.minShift = (uint16_t)n.minShift;
+    r.maxShift = (uint16_t)n.maxShift;
+    return r;
+}
+
+// Phần đầu file (mọi thứ trước bản ghi y tá); inst.nurses không cần có sẵn khi ghi dạng stream,
+// khi đó hasUnavailable / hasAvoid cho biết các bản ghi sẽ kèm mask nào
+inline std::string instanceHeaderBytes(const NSPInstance& inst, uint32_t numNurses,
+                                       bool hasUnavailable, bool hasAvoid) {
+    std::string out;
+    auto put = [&out](const void* p, size_t n) { out.append(static_cast<const char*>(p), n); };
+    uint32_t flags = (inst.demandAt.empty() ? 0u : 1u) | (hasUnavailable ? 2u : 0u) |
+                     (hasAvoid ? 4u : 0u) | (inst.skillDemand.empty() ? 0u : 8u);
+    uint32_t head[5] = {2, numNurses, (uint32_t)inst.numDays, (uint32_t)inst.shiftsPerDay, flags};
+    int32_t limits[4] = {inst.minAfternoon, inst.minNight, inst.minHeadPerMorning,
+                         inst.minMorningPerHead};
+    double costs[4] = {inst.costNormal, inst.costOvertime, inst.costHead, inst.costPreference};
+    put("NSPI", 4);
+    put(head, sizeof(head));
+    put(limits, sizeof(limits));
+    put(costs, sizeof(costs));
+    for (int d : inst.demand) put(&d, sizeof(int32_t));
+    for (int d : inst.demandAt) put(&d, sizeof(int32_t));
+    if (!inst.skillDemand.empty()) {
+        int32_t dims[2] = {inst.numWards, inst.numSkills};
+        put(dims, sizeof(dims));
+        for (int d : inst.skillDemand) put(&d, sizeof(int32_t));
+    }
+    return out;
+}
+
+inline std::string instanceHeaderBytes(const NSPInstance& inst, uint32_t numNurses) {
+    return instanceHeaderBytes(inst, numNurses, !inst.unavailable.empty(), !inst.avoid.empty());
+}
+
+// Bản ghi y tá kèm các mask của nó (nullptr = file không có mask đó)
+inline void appendNurseBytes(std::string& out, const NSPNurseRecord& record,
+                             const uint64_t* unavailable, const uint64_t* avoid, int maskWords) {
+    out.append(reinterpret_cast<const char*>(&record), sizeof(record));
+    if (unavailable) out.append(reinterpret_cast<const char*>(unavailable), maskWords * sizeof(uint64_t));
+    if (avoid) out.append(reinterpret_cast<const char*>(avoid), maskWords * sizeof(uint64_t));
+}
+
+inline bool writeInstanceBinary(const std::string& path, const NSPInstance& inst) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    std::string data = instanceHeaderBytes(inst, inst.nurses.size());
+    int words = inst.maskWords();
+    for (size_t i = 0; i < inst.nurses.size(); i++) {
+        appendNurseBytes(data, toNurseRecord(inst.nurses[i]),
+                         inst.unavailable.empty() ? nullptr : &inst.unavailable[i * words],
+                         inst.avoid.empty() ? nullptr : &inst.avoid[i * words], words);
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    return fclose(f) == 0 && ok;
+}
+
+inline bool readInstanceBinary(const std::string& path, NSPInstance& inst, std::string& error) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::string data;
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+    fclose(f);
+
+    size_t pos = 0;
+    auto take = [&](void* dst, size_t len) {
+        if (pos + len > data.size()) return false;
+        memcpy(dst, data.data() + pos, len);
+        pos += len;
+        return true;
+    };
+    char magic[4];
+    uint32_t head[5];
+    int32_t limits[4];
+    double costs[4] = {0, 0, 0, 0};
+    if (!take(magic, 4) || memcmp(magic, "NSPI", 4) != 0 || !take(head, sizeof(head)) ||
+        !take(limits, sizeof(limits)) || !take(costs, (head[0] >= 2 ? 4 : 3) * sizeof(double))) {
+        error = path + ": not an NSPI file";
+        return false;
+    }
+    if ((head[0] != 1 && head[0] != 2) || head[2] == 0 || head[3] == 0) {
+        error = path + ": unsupported NSPI version or empty horizon";
+        return false;
+    }
+    inst = NSPInstance();
+    inst.name = path;
+    inst.numDays = head[2];
+    inst.shiftsPerDay = head[3];
+    inst.minAfternoon = limits[0];
+    inst.minNight = limits[1];
+    inst.minHeadPerMorning = limits[2];
+    inst.minMorningPerHead = limits[3];
+    inst.costNormal = costs[0];
+    inst.costOvertime = costs[1];
+    inst.costHead = costs[2];
+    inst.costPreference = costs[3];
+    inst.demand.resize(inst.shiftsPerDay);
+    if (head[4] & 1) inst.demandAt.resize(inst.totalShifts());
+    if (!take(inst.demand.data(), inst.demand.size() * sizeof(int32_t)) ||
+        !take(inst.demandAt.data(), inst.demandAt.size() * sizeof(int32_t))) {
+        error = path + ": size does not match header";
+        return false;
+    }
+    if (head[0] >= 2 && (head[4] & 8)) {
+        int32_t dims[2];
+        if (!take(dims, sizeof(dims)) || dims[0] <= 0 || dims[1] <= 0 || dims[1] > NSP_MAX_SKILLS) {
+            error = path + ": invalid skill demand header";
+            return false;
+        }
+        inst.numWards = dims[0];
+        inst.numSkills = dims[1];
+        inst.skillDemand.resize((size_t)dims[0] * dims[1] * inst.totalShifts());
+        if (!take(inst.skillDemand.data(), inst.skillDemand.size() * sizeof(int32_t))) {
+            error = path + ": size does not match header";
+            return false;
+        }
+    }
+    size_t words = inst.maskWords();
+    bool hasUnavailable = head[0] >= 2 && (head[4] & 2), hasAvoid = head[0] >= 2 && (head[4] & 4);
+    size_t stride = sizeof(NSPNurseRecord) + (hasUnavailable + hasAvoid) * words * sizeof(uint64_t);
+    if (data.size() - pos != head[1] * stride) {
+        error = path + ": size does not match header";
+        return false;
+    }
+    inst.nurses.resize(head[1]);
+    if (hasUnavailable) inst.unavailable.resize(head[1] * words);
+    if (hasAvoid) inst.avoid.resize(head[1] * words);
+    for (size_t i = 0; i < head[1]; i++) {
+        NSPNurseRecord r;
+        take(&r, sizeof(r));
+        inst.nurses[i] = {(int)i, (r.flags & 1) != 0, (r.flags & 2) != 0,
+                          (double)r.minShift, (double)r.maxShift, r.skills};
+        if (hasUnavailable) take(&inst.unavailable[i * words], words * sizeof(uint64_t));
+        if (hasAvoid) take(&inst.avoid[i * words], words * sizeof(uint64_t));
+    }
+    return true;
+}
+
+// ==================== FILE INSTANCE TEXT ====================
+
+// Mỗi dòng một lệnh, '#' là chú thích:
+//   days 7 / shifts_per_day 3
+//   min_afternoon 1 / min_night 1 / min_morning_head 4 / min_head_per_morning 0
+//   cost_per_shift 100 / overtime_cost 150 / head_cost 120
+//                                      overtime_cost là phần cộng thêm vào cost_per_shift cho mỗi
+//                                      ca vượt min (costOvertime = cost_per_shift + overtime_cost);
+//                                      không có dòng nào thì mặc định mọi chi phí là 1
+//   demand 4 3 3                       nhu cầu theo loại ca, mọi ngày
+//   demand_at DAY SHIFT N              ghi đè nhu cầu một ca
+//   nurse NAME head|normal female|male MIN MAX
+//                                      dòng nurse đầu tiên thay danh sách y tá có sẵn (base)
+//   unavailable NURSE FROM [TO]        (11) y tá thứ NURSE (0-based) không làm các ca FROM..TO
+//   avoid NURSE FROM [TO]              y tá muốn tránh các ca FROM..TO (j = day * S + s)
+//   preference_cost 20                 phạt mỗi ca rơi vào ô avoid
+//   skills NURSE K1 [K2 ...]           (12) kỹ năng của y tá thứ NURSE (0 <= K < 8)
+//   skill_demand WARD SKILL DAY SHIFT N   (12) nhu cầu kỹ năng SKILL của khoa WARD;
+//                                      nhiều dòng cùng (khoa, kỹ năng, ca) được cộng dồn
+// Khóa khác chuyển cho extraKey (nsp.cpp: base, rule), trả về false nếu không nhận khóa đó;
+// ok = false khi dòng sai cú pháp. extraKey có thể ghi đè inst (base) nhưng phải giữ
+// costOvertime = costNormal + phần cộng thêm.
+typedef std::function<bool(const std::string& key, std::istream& args, NSPInstance& inst, bool& ok)>
+    NSPTextKeyFn;
+
+inline bool readInstanceText(const std::string& path, NSPInstance& inst, std::string& error,
+                             const NSPTextKeyFn& extraKey = nullptr) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    inst = NSPInstance();
+    inst.name = path;
+    double overtimeExtra = 1;
+    inst.costNormal = inst.costHead = 1;
+    inst.costOvertime = inst.costNormal + overtimeExtra;
+    bool customNurses = false;
+    std::vector<std::array<int, 3>> overrides;          // demand_at DAY SHIFT N
+    std::vector<std::array<int, 4>> maskRanges;         // {0 unavailable | 1 avoid, NURSE, FROM, TO}
+    std::vector<std::array<int, 2>> nurseSkills;        // {NURSE, SKILL}
+    std::vector<std::array<int, 5>> skillDemand;        // {WARD, SKILL, DAY, SHIFT, N}
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream ls(line);
+        std::string key;
+        if (!(ls >> key)) continue;
+
+        bool ok = true;
+        if (key == "days") {
+            ok = bool(ls >> inst.numDays) && inst.numDays > 0;
+        } else if (key == "shifts_per_day") {
+            ok = bool(ls >> inst.shiftsPerDay) && inst.shiftsPerDay > 0;
+        } else if (key == "min_afternoon") {
+            ok = bool(ls >> inst.minAfternoon);
+        } else if (key == "min_night") {
+            ok = bool(ls >> inst.minNight);
+        } else if (key == "min_morning_head") {
+            ok = bool(ls >> inst.minMorningPerHead);
+        } else if (key == "min_head_per_morning") {
+            ok = bool(ls >> inst.minHeadPerMorning);
+        } else if (key == "cost_per_shift") {
+            ok = bool(ls >> inst.costNormal);
+            inst.costOvertime = inst.costNormal + overtimeExtra;
+        } else if (key == "overtime_cost") {
+            ok = bool(ls >> overtimeExtra);
+            inst.costOvertime = inst.costNormal + overtimeExtra;
+        } else if (key == "head_cost") {
+            ok = bool(ls >> inst.costHead);
+        } else if (key == "preference_cost") {
+            ok = bool(ls >> inst.costPreference);
+        } else if (key == "unavailable" || key == "avoid") {
+            int nurse, from, to;
+            ok = bool(ls >> nurse >> from);
+            if (ok && !(ls >> to)) to = from;
+            if (ok) maskRanges.push_back({key == "avoid", nurse, from, to});
+        } else if (key == "skills") {
+            int nurse, skill;
+            ok = bool(ls >> nurse);
+            while (ok && ls >> skill) {
+                ok = skill >= 0 && skill < NSP_MAX_SKILLS;
+                nurseSkills.push_back({nurse, skill});
+            }
+        } else if (key == "skill_demand") {
+            std::array<int, 5> d;
+            ok = bool(ls >> d[0] >> d[1] >> d[2] >> d[3] >> d[4]) && d[0] >= 0 && d[1] >= 0 &&
+                 d[1] < NSP_MAX_SKILLS;
+            if (ok) skillDemand.push_back(d);
+        } else if (key == "demand") {
+            inst.demand.clear();
+            int d;
+            while (ls >> d) inst.demand.push_back(d);
+            ok = !inst.demand.empty();
+        } else if (key == "demand_at") {
+            int day, shift, n;
+            ok = bool(ls >> day >> shift >> n);
+            if (ok) overrides.push_back({day, shift, n});
+        } else if (key == "nurse") {
+            std::string name, role, gender;
+            int minShifts, maxShifts;
+            ok = bool(ls >> name >> role >> gender >> minShifts >> maxShifts);
+            if (ok) {
+                if (!customNurses) {
+                    inst.nurses.clear();
+                    inst.nurseNames.clear();
+                    inst.unavailable.clear();
+                    inst.avoid.clear();
+                }
+                customNurses = true;
+                inst.nurses.push_back({(int)inst.nurses.size(), role == "head", gender == "female",
+                                       (double)minShifts, (double)maxShifts});
+                inst.nurseNames.push_back(name);
+            }
+        } else if (extraKey && extraKey(key, ls, inst, ok)) {
+            overtimeExtra = inst.costOvertime - inst.costNormal;
+        } else {
+            error = path + ":" + std::to_string(lineNo) + ": unknown key '" + key + "'";
+            return false;
+        }
+        if (!ok) {
+            error = path + ":" + std::to_string(lineNo) + ": invalid line '" + line + "'";
+            return false;
+        }
+    }
+    if (inst.nurses.empty()) {
+        error = path + ": no nurses";
+        return false;
+    }
+    if ((int)inst.demand.size() != inst.shiftsPerDay) {
+        error = path + ": demand must list " + std::to_string(inst.shiftsPerDay) + " values";
+        return false;
+    }
+    if (!overrides.empty()) {
+        if (inst.demandAt.empty()) {
+            inst.demandAt.resize(inst.totalShifts());
+            for (int j = 0; j < inst.totalShifts(); j++) inst.demandAt[j] = inst.demand[j % inst.shiftsPerDay];
+        }
+        for (const auto& o : overrides) {
+            if (o[0] < 0 || o[0] >= inst.numDays || o[1] < 0 || o[1] >= inst.shiftsPerDay) {
+                error = path + ": demand_at " + std::to_string(o[0]) + " " + std::to_string(o[1]) +
+                        " out of range";
+                return false;
+            }
+            inst.demandAt[o[0] * inst.shiftsPerDay + o[1]] = o[2];
+        }
+    }
+    for (const auto& m : maskRanges) {
+        if (m[1] < 0 || m[1] >= (int)inst.nurses.size() || m[2] < 0 || m[2] > m[3] ||
+            m[3] >= inst.totalShifts()) {
+            error = path + ": " + (m[0] ? "avoid " : "unavailable ") + std::to_string(m[1]) + " " +
+                    std::to_string(m[2]) + " " + std::to_string(m[3]) + " out of range";
+            return false;
+        }
+        for (int j = m[2]; j <= m[3]; j++) inst.setMaskBit(m[0] ? inst.avoid : inst.unavailable, m[1], j);
+    }
+    for (const auto& ns : nurseSkills) {
+        if (ns[0] < 0 || ns[0] >= (int)inst.nurses.size()) {
+            error = path + ": skills " + std::to_string(ns[0]) + " out of range";
+            return false;
+        }
+        inst.nurses[ns[0]].skills |= 1 << ns[1];
+        inst.numSkills = std::max(inst.numSkills, ns[1] + 1);
+    }
+    for (const auto& d : skillDemand) {
+        if (d[2] < 0 || d[2] >= inst.numDays || d[3] < 0 || d[3] >= inst.shiftsPerDay) {
+            error = path + ": skill_demand day/shift out of range";
+            return false;
+        }
+        inst.numWards = std::max(inst.numWards, d[0] + 1);
+        inst.numSkills = std::max(inst.numSkills, d[1] + 1);
+    }
+    if (!skillDemand.empty()) {
+        inst.skillDemand.assign((size_t)inst.numWards * inst.numSkills * inst.totalShifts(), 0);
+        for (const auto& d : skillDemand) {
+            inst.skillDemand[((size_t)d[0] * inst.numSkills + d[1]) * inst.totalShifts() +
+                             d[2] * inst.shiftsPerDay + d[3]] += d[4];
+        }
+    }
+    return true;
+}
+
+// ==================== BACKEND ====================
+
+struct NSPBackendResult {
+    bool feasible = false;            // theo backend (solver báo khả thi / heuristic không vi phạm)
+    bool optimal = false;             // backend chứng minh tối ưu
+    double cost = 0;                  // chi phí backend báo
+    std::vector<char> schedule;       // numNurses * totalShifts
+};
+
+struct NSPBackendStats {
+    double buildMs = 0;
+    double solveMs = 0;
+    long numVariables = 0;
+    long numConstraints = 0;
+    std::string status;
+};
+
+// Gọi mỗi khi backend có lời giải tốt hơn (ms từ lúc bắt đầu solve, chi phí);
+// trả về false để dừng sớm và giữ lời giải tốt nhất hiện có
+typedef std::function<bool(double elapsedMs, double cost)> NSPProgressFn;
+
+class NSPBackend {
+protected:
+    NSPProgressFn progress;
+
+public:
+    virtual ~NSPBackend() = default;
+    void setProgress(NSPProgressFn fn) { progress = std::move(fn); }
+    virtual const char* name() const = 0;
+    // Dựng model cho instance; false nếu backend không hỗ trợ instance
+    virtual bool build(const NSPInstance& instance) = 0;
+    virtual bool solve(double timeLimitSec) = 0;
+    virtual const NSPBackendResult& solution() const = 0;
+    virtual const NSPBackendStats& stats() const = 0;
+};
+
+std::unique_ptr<NSPBackend> makeCpSatBackend();       // nsp.cpp
+std::unique_ptr<NSPBackend> makeHighsBackend();       // nsp_highs.cpp
+std::unique_ptr<NSPBackend> makeHeuristicBackend();   // nsp_standalone.cpp
@@ -0,0 +1,281 @@
+/**
+ * Nurse Scheduling Problem (NSP) - So sánh các backend trên cùng instance
+ * Mỗi backend (CP-SAT, HiGHS, heuristic) giải cùng một NSPInstance và được chấm lại
+ * bằng evaluateSchedule() trong nsp_backend.h, nên chi phí / vi phạm so sánh trực tiếp được.
+ * Mỗi lần chạy nằm trong một process con riêng: lỗi hoặc bộ nhớ của backend này
+ * không ảnh hưởng backend khác, và MAX_RSS đo bằng wait4() là của riêng lần chạy đó.
+ *
+ * Compile: g++ -O3 -std=c++17 -DNSP_BACKEND_ONLY nsp_bench.cpp nsp.cpp nsp_highs.cpp \
+ *              nsp_standalone.cpp -lortools -lhighs -o nsp_bench
+ *
+ * Chạy:    ./nsp_bench                                   (instance tham chiếu 1983 y tá)
+ *          ./nsp_bench --nurses 200 --heads 120 --time-limit 30
+ *          ./nsp_bench --backends cpsat,highs --repeats 3
+ *          ./nsp_bench --instance w.nspi                   (instance sinh bởi nsp_gen)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <sstream>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "nsp_backend.h"
+
+using namespace std;
+
+// Kết quả process con gửi về qua pipe (kích thước cố định, không cần serialize)
+struct BenchRecord {
+    int supported;
+    int feasible;
+    int optimal;
+    int violations;
+    double buildMs;
+    double solveMs;
+    double backendCost;
+    double evaluatedCost;
+    long numVariables;
+    long numConstraints;
+    char status[32];
+};
+
+struct BenchRow {
+    string backend;
+    int repeat;
+    bool ok;                   // process con kết thúc bình thường và gửi đủ record
+    BenchRecord record;
+    double wallMs;
+    double cpuMs;              // user + sys của process con
+    double maxRssMb;
+};
+
+unique_ptr<NSPBackend> makeBackend(const string& name) {
+    if (name == "cpsat") return makeCpSatBackend();
+    if (name == "highs") return makeHighsBackend();
+    if (name == "heuristic") return makeHeuristicBackend();
+    return nullptr;
+}
+
+vector<string> splitList(const string& text) {
+    vector<string> items;
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Chạy trong process con: build + solve + chấm lại, ghi record vào fd
+void runChild(const string& backendName, const NSPInstance& inst, double timeLimit, int fd) {
+    // Log của solver không lẫn vào bảng kết quả
+    int devNull = open("/dev/null", O_WRONLY);
+    if (devNull >= 0) {
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+    }
+
+    BenchRecord record;
+    memset(&record, 0, sizeof(record));
+    unique_ptr<NSPBackend> backend = makeBackend(backendName);
+    if (backend && backend->build(inst)) {
+        record.supported = 1;
+        backend->solve(timeLimit);
+        const NSPBackendResult& result = backend->solution();
+        const NSPBackendStats& stats = backend->stats();
+        record.feasible = result.feasible;
+        record.optimal = result.optimal;
+        record.buildMs = stats.buildMs;
+        record.solveMs = stats.solveMs;
+        record.backendCost = result.cost;
+        record.numVariables = stats.numVariables;
+        record.numConstraints = stats.numConstraints;
+        strncpy(record.status, stats.status.c_str(), sizeof(record.status) - 1);
+        if (result.schedule.size() == inst.nurses.size() * (size_t)inst.totalShifts()) {
+            record.violations = evaluateSchedule(inst, result.schedule, &record.evaluatedCost);
+        } else {
+            record.violations = -1;
+        }
+    } else {
+        strncpy(record.status, "UNSUPPORTED", sizeof(record.status) - 1);
+    }
+    ssize_t written = write(fd, &record, sizeof(record));
+    _exit(written == (ssize_t)sizeof(record) ? 0 : 1);
+}
+
+BenchRow runOnce(const string& backendName, const NSPInstance& inst, double timeLimit, int repeat) {
+    BenchRow row;
+    row.backend = backendName;
+    row.repeat = repeat;
+    row.ok = false;
+    row.wallMs = row.cpuMs = row.maxRssMb = 0;
+    memset(&row.record, 0, sizeof(row.record));
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return row;
+    }
+    cout.flush();
+    timeval start, end;
+    gettimeofday(&start, nullptr);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return row;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        runChild(backendName, inst, timeLimit, fds[1]);
+    }
+    close(fds[1]);
+
+    // Record nhỏ hơn PIPE_BUF nên một lần write của con là nguyên tử
+    ssize_t got = read(fds[0], &row.record, sizeof(row.record));
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    wait4(pid, &status, 0, &usage);
+    gettimeofday(&end, nullptr);
+
+    row.ok = got == (ssize_t)sizeof(row.record) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    if (!row.ok) {
+        strncpy(row.record.status, WIFSIGNALED(status) ? "CRASHED" : "ERROR",
+                sizeof(row.record.status) - 1);
+    }
+    row.wallMs = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_usec - start.tv_usec) / 1000.0;
+    row.cpuMs = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+                (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+    row.maxRssMb = usage.ru_maxrss / 1024.0;     // Linux: ru_maxrss tính bằng KB
+    return row;
+}
+
+void printRow(const BenchRow& row) {
+    const BenchRecord& r = row.record;
+    cout << left << setw(11) << row.backend << right << setw(4) << row.repeat
+         << fixed << setprecision(1)
+         << setw(11) << r.buildMs << setw(11) << r.solveMs
+         << setw(11) << row.wallMs << setw(11) << row.cpuMs
+         << setprecision(0) << setw(13) << r.backendCost << setw(13) << r.evaluatedCost
+         << setw(6) << r.violations << "  " << left << setw(12) << r.status << right
+         << setprecision(1) << setw(9) << row.maxRssMb
+         << setw(10) << r.numVariables << setw(10) << r.numConstraints << endl;
+}
+
+void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " [options]\n"
+         << "  --nurses N          số y tá của instance tham chiếu (mặc định 1983)\n"
+         << "  --heads H           số y tá trưởng (mặc định 1234, co theo --nurses)\n"
+         << "  --instance FILE     instance NSPI (nsp_gen) thay cho instance tham chiếu\n"
+         << "  --backends LIST     cpsat,highs,heuristic (mặc định tất cả)\n"
+         << "  --time-limit S      giới hạn thời gian mỗi lần giải (mặc định 60)\n"
+         << "  --repeats R         số lần chạy mỗi backend (mặc định 1)\n";
+}
+
+// ==================== MAIN ====================
+
+int main(int argc, char** argv) {
+    int numNurses = 1983, numHead = -1, repeats = 1;
+    double timeLimit = 60.0;
+    vector<string> backends = {"cpsat", "highs", "heuristic"};
+    string instanceFile;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--nurses" && a + 1 < argc) {
+            numNurses = atoi(argv[++a]);
+        } else if (arg == "--heads" && a + 1 < argc) {
+            numHead = atoi(argv[++a]);
+        } else if (arg == "--instance" && a + 1 < argc) {
+            instanceFile = argv[++a];
+        } else if (arg == "--backends" && a + 1 < argc) {
+            backends = splitList(argv[++a]);
+        } else if (arg == "--time-limit" && a + 1 < argc) {
+            timeLimit = atof(argv[++a]);
+        } else if (arg == "--repeats" && a + 1 < argc) {
+            repeats = max(1, atoi(argv[++a]));
+        } else if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (numHead < 0) numHead = (int)(1234 * (numNurses / 1983.0));
+    if (numNurses <= 0 || numHead > numNurses) {
+        cerr << "Invalid --nurses / --heads" << endl;
+        return 1;
+    }
+    for (const string& name : backends) {
+        if (!makeBackend(name)) {
+            cerr << "Unknown backend: " << name << endl;
+            return 1;
+        }
+    }
+
+    NSPInstance inst;
+    if (instanceFile.empty()) {
+        inst = makeReferenceInstance(numNurses, numHead);
+    } else {
+        string error;
+        if (!readInstanceBinary(instanceFile, inst, error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        numHead = count_if(inst.nurses.begin(), inst.nurses.end(),
+                           [](const NSPNurse& n) { return n.isHead; });
+    }
+    cout << "Instance: " << inst.name << " (" << inst.nurses.size() << " y tá, " << numHead
+         << " trưởng, " << inst.numDays << " ngày x " << inst.shiftsPerDay << " ca)" << endl;
+    cout << "Time limit: " << timeLimit << "s, repeats: " << repeats << "\n" << endl;
+
+    cout << left << setw(11) << "BACKEND" << right << setw(4) << "#"
+         << setw(11) << "BUILD_MS" << setw(11) << "SOLVE_MS"
+         << setw(11) << "WALL_MS" << setw(11) << "CPU_MS"
+         << setw(13) << "COST" << setw(13) << "EVAL_COST"
+         << setw(6) << "VIOL" << "  " << left << setw(12) << "STATUS" << right
+         << setw(9) << "RSS_MB" << setw(10) << "VARS" << setw(10) << "CONS" << endl;
+    cout << string(132, '-') << endl;
+
+    vector<BenchRow> rows;
+    for (const string& name : backends) {
+        for (int r = 1; r <= repeats; r++) {
+            rows.push_back(runOnce(name, inst, timeLimit, r));
+            printRow(rows.back());
+        }
+    }
+
+    // Tóm tắt: lần chạy nhanh nhất của mỗi backend, chi phí theo evaluateSchedule
+    cout << "\n--- TÓM TẮT (best of " << repeats << ") ---" << endl;
+    for (const string& name : backends) {
+        const BenchRow* best = nullptr;
+        for (const BenchRow& row : rows) {
+            if (row.backend != name || !row.ok || !row.record.supported) continue;
+            if (!best || row.wallMs < best->wallMs) best = &row;
+        }
+        if (!best) {
+            cout << name << ": không có kết quả" << endl;
+            continue;
+        }
+        const BenchRecord& r = best->record;
+        cout << name << ": TOTAL_MS=" << fixed << setprecision(2) << best->wallMs
+             << " TOTAL_COST=" << r.evaluatedCost << " VIOLATIONS=" << r.violations
+             << " STATUS=" << r.status << " MAX_RSS_MB=" << setprecision(1) << best->maxRssMb
+             << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,295 @@
+/**
+ * libnsp - cài đặt C ABI (nsp_capi.h) trên giao diện NSPBackend
+ * Exception C++ không được vượt qua biên ABI: mọi hàm export bắt lại và trả NSP_ERR_INTERNAL.
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <exception>
+#include <cstddef>
+#include <cstring>
+
+#include "nsp_backend.h"
+#include "nsp_capi.h"
+
+using namespace std;
+
+struct nsp_solver {
+    unique_ptr<NSPBackend> backend;
+    NSPInstance instance;             // bản sao từ nsp_instance_view, dùng lại capacity mỗi lần build
+    bool built = false;
+    bool solved = false;
+    bool cancelled = false;
+    nsp_progress_fn progressFn = nullptr;
+    void* progressUser = nullptr;
+    string lastError;
+};
+
+namespace {
+
+nsp_status fail(nsp_solver* solver, nsp_status status, const string& message) {
+    if (solver) solver->lastError = message;
+    return status;
+}
+
+// Kiểm tra view và chép sang NSPInstance (O(num_nurses), không cấp phát lại nếu đủ chỗ)
+nsp_status readInstance(const nsp_instance_view* view, NSPInstance& inst, string& error) {
+    // Bên gọi biên dịch với header cũ (v1 chưa có demand_at, v2 chưa có mask, v3 chưa có kỹ năng)
+    // vẫn được chấp nhận
+    if (!view || view->struct_size < offsetof(nsp_instance_view, demand_at)) {
+        error = "instance is NULL or struct_size too small";
+        return NSP_ERR_INVALID_ARGUMENT;
+    }
+    if (view->num_nurses < 0 || view->num_days <= 0 || view->shifts_per_day <= 0) {
+        error = "num_nurses must be >= 0, num_days and shifts_per_day > 0";
+        return NSP_ERR_INVALID_ARGUMENT;
+    }
+    if (view->num_nurses > 0 && (!view->is_head || !view->is_female ||
+                                 !view->min_shifts || !view->max_shifts)) {
+        error = "per-nurse arrays must not be NULL";
+        return NSP_ERR_INVALID_ARGUMENT;
+    }
+    if (!view->demand) {
+        error = "demand must not be NULL";
+        return NSP_ERR_INVALID_ARGUMENT;
+    }
+
+    inst.numDays = view->num_days;
+    inst.shiftsPerDay = view->shifts_per_day;
+    inst.nurses.resize(view->num_nurses);
+    for (int i = 0; i < view->num_nurses; i++) {
+        inst.nurses[i] = {i, view->is_head[i] != 0, view->is_female[i] != 0,
+                          (double)view->min_shifts[i], (double)view->max_shifts[i]};
+    }
+    inst.demand.assign(view->demand, view->demand + view->shifts_per_day);
+    inst.demandAt.clear();
+    if (view->struct_size >= offsetof(nsp_instance_view, demand_at) + sizeof(view->demand_at) &&
+        view->demand_at) {
+        inst.demandAt.assign(view->demand_at,
+                             view->demand_at + (size_t)view->num_days * view->shifts_per_day);
+    }
+    inst.minAfternoon = view->min_afternoon;
+    inst.minNight = view->min_night;
+    inst.minHeadPerMorning = view->min_head_per_morning;
+    inst.minMorningPerHead = view->min_morning_per_head;
+    inst.costNormal = view->cost_normal;
+    inst.costOvertime = view->cost_overtime;
+    inst.costHead = view->cost_head;
+    inst.unavailable.clear();
+    inst.avoid.clear();
+    inst.costPreference = 0;
+    if (view->struct_size >= offsetof(nsp_instance_view, cost_preference) + sizeof(view->cost_preference)) {
+        size_t words = (size_t)view->num_nurses * inst.maskWords();
+        if (view->unavailable) inst.unavailable.assign(view->unavailable, view->unavailable + words);
+        if (view->avoid) inst.avoid.assign(view->avoid, view->avoid + words);
+        inst.costPreference = view->cost_preference;
+    }
+    inst.numWards = inst.numSkills = 0;
+    inst.skillDemand.clear();
+    if (view->struct_size >= offsetof(nsp_instance_view, skill_demand) + sizeof(view->skill_demand)) {
+        if (view->num_skills < 0 || view->num_skills > NSP_MAX_SKILLS || view->num_wards < 0) {
+            error = "num_skills must be in [0, 8] and num_wards >= 0";
+            return NSP_ERR_INVALID_ARGUMENT;
+        }
+        for (int i = 0; view->skills && i < view->num_nurses; i++) inst.nurses[i].skills = view->skills[i];
+        if (view->skill_demand && view->num_wards > 0 && view->num_skills > 0) {
+            inst.numWards = view->num_wards;
+            inst.numSkills = view->num_skills;
+            inst.skillDemand.assign(view->skill_demand, view->skill_demand +
+                                    (size_t)inst.numWards * inst.numSkills * inst.totalShifts());
+        }
+    }
+    return NSP_OK;
+}
+
+// vector<char> (1 byte / ô) <-> hàng uint64 của bên gọi
+void packSchedule(const vector<char>& cells, size_t numNurses, size_t totalShifts,
+                  size_t wordsPerRow, uint64_t* words) {
+    memset(words, 0, numNurses * wordsPerRow * sizeof(uint64_t));
+    for (size_t i = 0; i < numNurses; i++) {
+        const char* src = cells.data() + i * totalShifts;
+        uint64_t* row = words + i * wordsPerRow;
+        for (size_t j = 0; j < totalShifts; j++) {
+            if (src[j]) row[j / 64] |= uint64_t(1) << (j % 64);
+        }
+    }
+}
+
+void unpackSchedule(const uint64_t* words, size_t numNurses, size_t totalShifts,
+                    size_t wordsPerRow, vector<char>& cells) {
+    cells.resize(numNurses * totalShifts);
+    for (size_t i = 0; i < numNurses; i++) {
+        const uint64_t* row = words + i * wordsPerRow;
+        char* dst = cells.data() + i * totalShifts;
+        for (size_t j = 0; j < totalShifts; j++) dst[j] = (row[j / 64] >> (j % 64)) & 1;
+    }
+}
+
+} // namespace
+
+// ==================== C ABI ====================
+
+extern "C" {
+
+NSP_API uint32_t nsp_api_version(void) {
+    return NSP_API_VERSION;
+}
+
+NSP_API const char* nsp_status_string(nsp_status status) {
+    switch (status) {
+        case NSP_OK:                   return "OK";
+        case NSP_ERR_INVALID_ARGUMENT: return "INVALID_ARGUMENT";
+        case NSP_ERR_UNSUPPORTED:      return "UNSUPPORTED";
+        case NSP_ERR_BUFFER_TOO_SMALL: return "BUFFER_TOO_SMALL";
+        case NSP_ERR_NO_MODEL:         return "NO_MODEL";
+        case NSP_ERR_SOLVER:           return "SOLVER";
+        case NSP_ERR_INTERNAL:         return "INTERNAL";
+    }
+    return "UNKNOWN";
+}
+
+NSP_API nsp_solver* nsp_solver_create(const char* backend) {
+    if (!backend) return nullptr;
+    try {
+        unique_ptr<NSPBackend> impl;
+#ifndef NSP_CAPI_NO_CPSAT
+        if (strcmp(backend, "cpsat") == 0) impl = makeCpSatBackend();
+#endif
+#ifndef NSP_CAPI_NO_HIGHS
+        if (strcmp(backend, "highs") == 0) impl = makeHighsBackend();
+#endif
+        if (strcmp(backend, "heuristic") == 0) impl = makeHeuristicBackend();
+        if (!impl) return nullptr;
+        nsp_solver* solver = new nsp_solver();
+        solver->backend = move(impl);
+        return solver;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+NSP_API void nsp_solver_destroy(nsp_solver* solver) {
+    delete solver;
+}
+
+NSP_API const char* nsp_solver_last_error(const nsp_solver* solver) {
+    return solver ? solver->lastError.c_str() : "solver is NULL";
+}
+
+NSP_API void nsp_solver_set_progress(nsp_solver* solver, nsp_progress_fn fn, void* user_data) {
+    if (!solver) return;
+    solver->progressFn = fn;
+    solver->progressUser = user_data;
+}
+
+NSP_API nsp_status nsp_solver_build(nsp_solver* solver, const nsp_instance_view* instance) {
+    if (!solver) return NSP_ERR_INVALID_ARGUMENT;
+    try {
+        solver->built = solver->solved = false;
+        string error;
+        nsp_status status = readInstance(instance, solver->instance, error);
+        if (status != NSP_OK) return fail(solver, status, error);
+        if (!solver->backend->build(solver->instance)) {
+            return fail(solver, NSP_ERR_UNSUPPORTED,
+                        string(solver->backend->name()) + " does not support this instance");
+        }
+        solver->built = true;
+        solver->lastError.clear();
+        return NSP_OK;
+    } catch (const exception& e) {
+        return fail(solver, NSP_ERR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(solver, NSP_ERR_INTERNAL, "unknown exception");
+    }
+}
+
+NSP_API nsp_status nsp_solver_solve(nsp_solver* solver, double time_limit_sec, nsp_result* out) {
+    if (!solver) return NSP_ERR_INVALID_ARGUMENT;
+    if (out && out->struct_size < sizeof(nsp_result)) {
+        return fail(solver, NSP_ERR_INVALID_ARGUMENT, "result struct_size too small");
+    }
+    if (!solver->built) return fail(solver, NSP_ERR_NO_MODEL, "nsp_solver_build has not succeeded");
+    try {
+        solver->cancelled = false;
+        if (solver->progressFn) {
+            solver->backend->setProgress([solver](double elapsedMs, double cost) {
+                if (solver->progressFn(solver->progressUser, elapsedMs, cost) != 0) {
+                    solver->cancelled = true;
+                }
+                return !solver->cancelled;
+            });
+        } else {
+            solver->backend->setProgress(nullptr);
+        }
+        bool ok = solver->backend->solve(time_limit_sec);
+        solver->solved = true;
+
+        const NSPBackendResult& result = solver->backend->solution();
+        const NSPBackendStats& stats = solver->backend->stats();
+        if (out) {
+            size_t structSize = out->struct_size;
+            memset(out, 0, sizeof(nsp_result));
+            out->struct_size = structSize;
+            out->feasible = result.feasible;
+            out->optimal = result.optimal;
+            out->cancelled = solver->cancelled;
+            out->cost = result.cost;
+            out->build_ms = stats.buildMs;
+            out->solve_ms = stats.solveMs;
+            out->num_variables = stats.numVariables;
+            out->num_constraints = stats.numConstraints;
+            out->violations = evaluateSchedule(solver->instance, result.schedule,
+                                               &out->evaluated_cost);
+        }
+        if (!ok) return fail(solver, NSP_ERR_SOLVER, solver->backend->name() + string(": ") + stats.status);
+        solver->lastError.clear();
+        return NSP_OK;
+    } catch (const exception& e) {
+        return fail(solver, NSP_ERR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(solver, NSP_ERR_INTERNAL, "unknown exception");
+    }
+}
+
+NSP_API nsp_status nsp_solver_get_schedule(const nsp_solver* solver, uint64_t* words,
+                                           size_t num_words) {
+    if (!solver || !words) return NSP_ERR_INVALID_ARGUMENT;
+    if (!solver->solved) return NSP_ERR_NO_MODEL;
+    const NSPInstance& inst = solver->instance;
+    size_t wordsPerRow = nsp_schedule_words_per_row(inst.numDays, inst.shiftsPerDay);
+    if (num_words < inst.nurses.size() * wordsPerRow) return NSP_ERR_BUFFER_TOO_SMALL;
+    packSchedule(solver->backend->solution().schedule, inst.nurses.size(), inst.totalShifts(),
+                 wordsPerRow, words);
+    return NSP_OK;
+}
+
+NSP_API size_t nsp_schedule_words_per_row(int32_t num_days, int32_t shifts_per_day) {
+    if (num_days <= 0 || shifts_per_day <= 0) return 0;
+    return ((size_t)num_days * shifts_per_day + 63) / 64;
+}
+
+NSP_API nsp_status nsp_evaluate(const nsp_instance_view* instance, const uint64_t* words,
+                                size_t num_words, double* cost, int32_t* violations) {
+    try {
+        NSPInstance inst;
+        string error;
+        nsp_status status = readInstance(instance, inst, error);
+        if (status != NSP_OK) return status;
+        size_t wordsPerRow = nsp_schedule_words_per_row(inst.numDays, inst.shiftsPerDay);
+        if (!words && !inst.nurses.empty()) return NSP_ERR_INVALID_ARGUMENT;
+        if (num_words < inst.nurses.size() * wordsPerRow) return NSP_ERR_BUFFER_TOO_SMALL;
+
+        vector<char> cells;
+        unpackSchedule(words, inst.nurses.size(), inst.totalShifts(), wordsPerRow, cells);
+        double total = 0;
+        int v = evaluateSchedule(inst, cells, &total);
+        if (cost) *cost = total;
+        if (violations) *violations = v;
+        return NSP_OK;
+    } catch (...) {
+        return NSP_ERR_INTERNAL;
+    }
+}
+
+} // extern "C"
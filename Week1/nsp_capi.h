@@ -0,0 +1,130 @@
+/**
+ * libnsp - C ABI cho các solver NSP (CP-SAT / HiGHS / heuristic)
+ *
+ * Dành cho service Rust / Python gọi trực tiếp trong process thay vì spawn nsp_* và đọc stdout.
+ * Mọi buffer do bên gọi cấp phát và sở hữu: thư viện chỉ đọc instance từ các mảng phẳng
+ * và ghi lịch (bit-packed) vào buffer bên gọi đưa vào, không trả về con trỏ cần free.
+ *
+ * Build:   g++ -O3 -std=c++17 -fPIC -shared -fvisibility=hidden -DNSP_BACKEND_ONLY \
+ *              nsp_capi.cpp nsp.cpp nsp_highs.cpp nsp_standalone.cpp \
+ *              -lortools -lhighs -o libnsp.so
+ *          Chỉ heuristic (không cần OR-Tools / HiGHS):
+ *          g++ -O3 -std=c++17 -fPIC -shared -fvisibility=hidden -DNSP_BACKEND_ONLY \
+ *              -DNSP_CAPI_NO_CPSAT -DNSP_CAPI_NO_HIGHS nsp_capi.cpp nsp_standalone.cpp -o libnsp.so
+ *
+ * Lịch bit-packed: nurse i chiếm words_per_row uint64 liên tiếp từ word i * words_per_row;
+ * ca j (j = day * shifts_per_day + s) là bit (j % 64) của word j / 64 trong hàng đó.
+ * Cùng bố cục với phần thân file .bin của nsp --export-bin.
+ *
+ * Luồng: một nsp_solver không an toàn khi gọi đồng thời; các handle khác nhau thì dùng
+ * song song được. Struct trong file này chỉ được thêm field ở cuối (struct_size để nhận biết).
+ */
+
+#ifndef NSP_CAPI_H
+#define NSP_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define NSP_API __declspec(dllexport)
+#else
+#define NSP_API __attribute__((visibility("default")))
+#endif
+
+#define NSP_API_VERSION 4
+
+typedef enum nsp_status {
+    NSP_OK = 0,
+    NSP_ERR_INVALID_ARGUMENT = 1,   /* con trỏ NULL, kích thước âm, struct_size quá nhỏ */
+    NSP_ERR_UNSUPPORTED = 2,        /* backend không hỗ trợ instance (vd. shifts_per_day != 3) */
+    NSP_ERR_BUFFER_TOO_SMALL = 3,
+    NSP_ERR_NO_MODEL = 4,           /* solve / get_schedule trước build hoặc solve */
+    NSP_ERR_SOLVER = 5,             /* solver báo lỗi */
+    NSP_ERR_INTERNAL = 6            /* exception C++ bị chặn ở biên ABI */
+} nsp_status;
+
+/* Instance dạng mảng phẳng, mảng per-nurse có num_nurses phần tử, demand có shifts_per_day */
+typedef struct nsp_instance_view {
+    size_t struct_size;             /* = sizeof(nsp_instance_view) */
+    int32_t num_nurses;
+    int32_t num_days;
+    int32_t shifts_per_day;
+    const uint8_t* is_head;
+    const uint8_t* is_female;
+    const int32_t* min_shifts;
+    const int32_t* max_shifts;
+    const int32_t* demand;          /* #1 theo loại ca */
+    int32_t min_afternoon;          /* #4 */
+    int32_t min_night;              /* #5 */
+    int32_t min_head_per_morning;   /* #7 */
+    int32_t min_morning_per_head;   /* #7' */
+    double cost_normal;
+    double cost_overtime;           /* chi phí một ca vượt min_shifts (thay cho cost_normal) */
+    double cost_head;
+    /* Thêm ở v2: nhu cầu từng ca (num_days * shifts_per_day), NULL = theo demand */
+    const int32_t* demand_at;
+    /* Thêm ở v3: mask num_nurses * words_per_row (cùng bố cục với lịch bit-packed), NULL = không có */
+    const uint64_t* unavailable;    /* #11 ô y tá không làm được */
+    const uint64_t* avoid;          /* ô y tá muốn tránh, mỗi ca làm tốn cost_preference */
+    double cost_preference;
+    /* Thêm ở v4 (#12): bitmask kỹ năng mỗi y tá (NULL = không kỹ năng), nhu cầu theo
+       (khoa, kỹ năng, ca) tại [(ward * num_skills + skill) * num_days * shifts_per_day + j],
+       NULL hoặc num_wards = 0 = không có; num_skills <= 8 */
+    const uint8_t* skills;
+    int32_t num_wards;
+    int32_t num_skills;
+    const int32_t* skill_demand;
+} nsp_instance_view;
+
+typedef struct nsp_result {
+    size_t struct_size;             /* = sizeof(nsp_result) */
+    int32_t feasible;
+    int32_t optimal;
+    int32_t cancelled;              /* progress callback yêu cầu dừng */
+    int32_t violations;             /* chấm lại theo #1-#12 (evaluateSchedule) */
+    double cost;                    /* chi phí backend báo */
+    double evaluated_cost;          /* chi phí tính lại từ lịch */
+    double build_ms;
+    double solve_ms;
+    int64_t num_variables;
+    int64_t num_constraints;
+} nsp_result;
+
+/* Gọi mỗi khi có lời giải tốt hơn; trả về khác 0 để dừng sớm (giữ lời giải tốt nhất) */
+typedef int (*nsp_progress_fn)(void* user_data, double elapsed_ms, double cost);
+
+typedef struct nsp_solver nsp_solver;
+
+NSP_API uint32_t nsp_api_version(void);
+NSP_API const char* nsp_status_string(nsp_status status);
+
+/* backend: "cpsat", "highs" hoặc "heuristic"; NULL nếu không có trong bản build này */
+NSP_API nsp_solver* nsp_solver_create(const char* backend);
+NSP_API void nsp_solver_destroy(nsp_solver* solver);
+/* Thông báo lỗi của lần gọi thất bại gần nhất; con trỏ hợp lệ đến lần gọi kế tiếp */
+NSP_API const char* nsp_solver_last_error(const nsp_solver* solver);
+NSP_API void nsp_solver_set_progress(nsp_solver* solver, nsp_progress_fn fn, void* user_data);
+
+/* Dựng model cho instance; gọi lại với instance khác để dùng lại handle */
+NSP_API nsp_status nsp_solver_build(nsp_solver* solver, const nsp_instance_view* instance);
+/* time_limit_sec <= 0: mặc định của backend; out có thể NULL */
+NSP_API nsp_status nsp_solver_solve(nsp_solver* solver, double time_limit_sec, nsp_result* out);
+/* Ghi lịch của lần solve gần nhất; cần num_words >= num_nurses * words_per_row */
+NSP_API nsp_status nsp_solver_get_schedule(const nsp_solver* solver, uint64_t* words,
+                                           size_t num_words);
+
+NSP_API size_t nsp_schedule_words_per_row(int32_t num_days, int32_t shifts_per_day);
+/* Chấm một lịch bit-packed bất kỳ, không cần handle */
+NSP_API nsp_status nsp_evaluate(const nsp_instance_view* instance, const uint64_t* words,
+                                size_t num_words, double* cost, int32_t* violations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NSP_CAPI_H */
@@ -0,0 +1,229 @@
+/**
+ * Nurse Scheduling Problem (NSP) - Checkpoint trạng thái solver ra file nhị phân
+ *
+ * Bố cục chung (little-endian):
+ *   char[4] "NSPK", uint32 version = 1, uint32 kind (1 = heuristic, 2 = CP-SAT),
+ *   uint64 hash instance, uint32 numNurses, uint32 totalShifts, rồi phần riêng của từng solver
+ *   (xem NSPSolver::checkpointBytes trong nsp_standalone.cpp / nsp.cpp). Lịch lưu bit-packed
+ *   theo bố cục NSPB (hàng y tá i gồm (totalShifts + 63) / 64 uint64).
+ *
+ * NSPCheckpointWriter ghi ở thread riêng: solver chỉ dựng buffer byte rồi submit() (không chờ
+ * I/O). Buffer mới thay buffer chưa kịp ghi, nên thread tìm kiếm không bao giờ bị chặn bởi đĩa
+ * chậm. Mỗi lần ghi qua writeFileAtomic (nsp_backend.h): PATH.tmp, fsync, rename, fsync thư mục,
+ * nên preempt giữa chừng vẫn còn một checkpoint đầy đủ trên đĩa.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nsp_backend.h"
+
+const uint32_t NSP_CHECKPOINT_VERSION = 1;
+const uint32_t NSP_CHECKPOINT_HEURISTIC = 1;
+const uint32_t NSP_CHECKPOINT_CPSAT = 2;
+
+// Hash (NSPHasher) đúng các byte NSPI của instance (writeInstanceBinary), không phụ thuộc tên instance
+inline uint64_t instanceFingerprint(const NSPInstance& inst) {
+    NSPHasher hasher;
+    std::string bytes = instanceHeaderBytes(inst, inst.nurses.size());
+    int words = inst.maskWords();
+    for (size_t i = 0; i < inst.nurses.size(); i++) {
+        appendNurseBytes(bytes, toNurseRecord(inst.nurses[i]),
+                         inst.unavailable.empty() ? nullptr : &inst.unavailable[i * words],
+                         inst.avoid.empty() ? nullptr : &inst.avoid[i * words], words);
+    }
+    hasher.mix(bytes.data(), bytes.size());
+    return hasher.h;
+}
+
+struct NSPByteWriter {
+    std::string out;
+    void put(const void* p, size_t n) { out.append(static_cast<const char*>(p), n); }
+    template <class T>
+    void add(const T& value) { put(&value, sizeof(T)); }
+    void addString(const std::string& s) {
+        add((uint32_t)s.size());
+        put(s.data(), s.size());
+    }
+    // Lịch dạng ô 0/1 (cells[i * totalShifts + j]) thành các hàng bit-packed
+    void addCells(const std::vector<char>& cells, int numNurses, int totalShifts) {
+        int words = (totalShifts + 63) / 64;
+        std::vector<uint64_t> row(words);
+        for (int i = 0; i < numNurses; i++) {
+            std::fill(row.begin(), row.end(), 0);
+            const char* src = cells.data() + (size_t)i * totalShifts;
+            for (int j = 0; j < totalShifts; j++) row[j / 64] |= uint64_t(src[j] != 0) << (j % 64);
+            put(row.data(), words * sizeof(uint64_t));
+        }
+    }
+};
+
+struct NSPByteReader {
+    const std::string& data;
+    size_t pos = 0;
+    explicit NSPByteReader(const std::string& bytes) : data(bytes) {}
+    bool take(void* dst, size_t len) {
+        if (pos + len > data.size()) return false;
+        memcpy(dst, data.data() + pos, len);
+        pos += len;
+        return true;
+    }
+    template <class T>
+    bool get(T& value) { return take(&value, sizeof(T)); }
+    bool getString(std::string& s) {
+        uint32_t len;
+        if (!get(len) || pos + len > data.size()) return false;
+        s.assign(data.data() + pos, len);
+        pos += len;
+        return true;
+    }
+    bool getCells(std::vector<char>& cells, int numNurses, int totalShifts) {
+        int words = (totalShifts + 63) / 64;
+        std::vector<uint64_t> row(words);
+        cells.assign((size_t)numNurses * totalShifts, 0);
+        for (int i = 0; i < numNurses; i++) {
+            if (!take(row.data(), words * sizeof(uint64_t))) return false;
+            for (int j = 0; j < totalShifts; j++) cells[(size_t)i * totalShifts + j] = (row[j / 64] >> (j % 64)) & 1;
+        }
+        return true;
+    }
+    bool done() const { return pos == data.size(); }
+};
+
+inline void addCheckpointHeader(NSPByteWriter& w, uint32_t kind, uint64_t hash, int numNurses,
+                                int totalShifts) {
+    w.put("NSPK", 4);
+    w.add(NSP_CHECKPOINT_VERSION);
+    w.add(kind);
+    w.add(hash);
+    w.add((uint32_t)numNurses);
+    w.add((uint32_t)totalShifts);
+}
+
+// Kiểm phần đầu khớp solver và instance đang chạy; error mô tả chỗ không khớp
+inline bool readCheckpointHeader(NSPByteReader& r, uint32_t kind, uint64_t hash, int numNurses,
+                                 int totalShifts, std::string& error) {
+    char magic[4];
+    uint32_t version, fileKind, nurses, shifts;
+    uint64_t fileHash;
+    if (!r.take(magic, 4) || memcmp(magic, "NSPK", 4) != 0 || !r.get(version) || !r.get(fileKind) ||
+        !r.get(fileHash) || !r.get(nurses) || !r.get(shifts)) {
+        error = "not an NSPK checkpoint";
+        return false;
+    }
+    if (version != NSP_CHECKPOINT_VERSION) {
+        error = "unsupported checkpoint version " + std::to_string(version);
+        return false;
+    }
+    if (fileKind != kind) {
+        error = fileKind == NSP_CHECKPOINT_CPSAT ? "checkpoint was written by the CP-SAT solver"
+                                                 : "checkpoint was written by the heuristic solver";
+        return false;
+    }
+    if (fileHash != hash || (int)nurses != numNurses || (int)shifts != totalShifts) {
+        error = "checkpoint belongs to a different instance";
+        return false;
+    }
+    return true;
+}
+
+inline bool readCheckpointFile(const std::string& path, std::string& data) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+    data.clear();
+    char buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.append(buf, n);
+    bool ok = !ferror(f);
+    fclose(f);
+    return ok;
+}
+
+class NSPCheckpointWriter {
+public:
+    explicit NSPCheckpointWriter(std::string path) : path_(std::move(path)), worker_([this] { run(); }) {}
+
+    ~NSPCheckpointWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        worker_.join();
+    }
+
+    NSPCheckpointWriter(const NSPCheckpointWriter&) = delete;
+    NSPCheckpointWriter& operator=(const NSPCheckpointWriter&) = delete;
+
+    const std::string& path() const { return path_; }
+
+    // Không chờ I/O; buffer chưa ghi trước đó (nếu có) bị thay
+    void submit(std::string bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = std::move(bytes);
+            hasPending_ = true;
+            submitted_++;
+        }
+        wake_.notify_all();
+    }
+
+    // Chờ buffer cuối cùng được ghi xong (khi kết thúc solve)
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [this] { return !hasPending_ && !writing_; });
+    }
+
+    long submitted() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return submitted_;
+    }
+    long written() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return written_;
+    }
+    long failed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return failed_;
+    }
+
+private:
+    std::string path_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_, idle_;
+    std::string pending_;
+    bool hasPending_ = false, writing_ = false, stop_ = false;
+    long submitted_ = 0, written_ = 0, failed_ = 0;
+    std::thread worker_;   // khai báo cuối: khởi động sau khi các field trên đã sẵn sàng
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            wake_.wait(lock, [this] { return hasPending_ || stop_; });
+            if (!hasPending_) break;
+            std::string bytes = std::move(pending_);
+            hasPending_ = false;
+            writing_ = true;
+            lock.unlock();
+            bool ok = writeAtomic(bytes);
+            lock.lock();
+            writing_ = false;
+            (ok ? written_ : failed_)++;
+            idle_.notify_all();
+        }
+        idle_.notify_all();
+    }
+
+    bool writeAtomic(const std::string& bytes) const {
+        return writeFileAtomic(path_, bytes.data(), bytes.size());
+    }
+};
@@ -0,0 +1,524 @@
+/**
+ * Nurse Scheduling Problem (NSP) - Sinh instance tổng hợp ở quy mô tùy ý
+ * Ghi dạng stream ra file NSPI (nsp_backend.h) hoặc định dạng text của nsp --instance.
+ * Y tá sinh theo khối cố định, mỗi khối một RNG seed từ (seed, chỉ số khối): cùng seed cho
+ * cùng file với mọi số thread. Bộ nhớ chỉ cần cho threads x khối, không cho cả instance.
+ * Compile: g++ -O3 -std=c++17 -pthread nsp_gen.cpp -o nsp_gen
+ *
+ * Chạy:    ./nsp_gen --nurses 1000000 --out big.nspi
+ *          ./nsp_gen --nurses 20000 --tightness 0.6 --day-curve weekday --noise 0.1 --seed 7 --out w.nspi
+ *          ./nsp_gen --nurses 60 --heads 0.2 --format text --out ward.txt   (cho nsp --instance)
+ *          ./nsp_gen --nurses 5000 --unavailable 0.05 --avoid 0.1 --out leave.nspi
+ *          ./nsp_gen --nurses 20000 --wards 40 --skills 4 --skill-rate 0.3 --out wards.nspi
+ *
+ * Mặc định theo tỉ lệ của instance tham chiếu 1983 y tá (62% trưởng, 11% y tá thường là nữ,
+ * nhu cầu 542/438/225, tightness = tổng nhu cầu / tổng maxShift ~ 0.47).
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "nsp_backend.h"
+
+using namespace std;
+
+// ==================== CẤU HÌNH ====================
+
+struct Range {
+    int lo, hi;
+};
+
+struct GenOptions {
+    long numNurses = 1983;
+    int numDays = 7;
+    int shiftsPerDay = 3;
+    double headRatio = 1234.0 / 1983.0;
+    double headFemaleRatio = 1.0;
+    double femaleRatio = 85.0 / 749.0;        // trong y tá thường
+    Range headMin = {5, 5}, headMax = {9, 9};
+    Range regularMin = {6, 6}, regularMax = {9, 9};
+    double tightness = 8435.0 / 17847.0;      // tổng nhu cầu / tổng maxShift kỳ vọng
+    vector<double> shiftWeights;              // rỗng = 542:438:225 (3 ca) hoặc đều
+    string dayCurve = "flat";                 // flat | weekday | sine | w1,w2,...
+    double noise = 0;                         // nhiễu nhân ±noise trên từng ca
+    double headPerMorning = 150.0 / 1234.0;   // #7 theo tỉ lệ số y tá trưởng
+    int minMorningPerHead = 0;
+    int minAfternoon = 2, minNight = 1;
+    double costNormal = 1000, costOvertime = 1200, costHead = 1500;
+    double unavailableRate = 0;               // xác suất y tá nghỉ cả một ngày (#11)
+    double avoidRate = 0;                     // xác suất y tá muốn tránh một ca
+    double costPreference = 100;
+    int numWards = 1;
+    int numSkills = 0;                        // #12, 0 = không sinh kỹ năng
+    double skillRate = 0.3;                   // xác suất y tá có từng kỹ năng
+    double skillShare = 0.3;                  // phần nhu cầu mỗi ca cần kỹ năng, chia đều theo kỹ năng
+    uint64_t seed = 1;
+    int threads = 0;
+    long blockSize = 1 << 16;
+    string out;
+    bool text = false;
+};
+
+bool parseRange(const string& text, Range& r) {
+    size_t dash = text.find('-');
+    r.lo = atoi(text.c_str());
+    r.hi = dash == string::npos ? r.lo : atoi(text.c_str() + dash + 1);
+    return r.lo >= 0 && r.hi >= r.lo && r.hi <= 65535;
+}
+
+bool parseWeights(const string& text, vector<double>& weights) {
+    weights.clear();
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        char* end = nullptr;
+        double w = strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || w < 0) return false;
+        weights.push_back(w);
+    }
+    return !weights.empty();
+}
+
+// SplitMix64: seed độc lập cho từng khối từ (seed, block)
+uint64_t mixSeed(uint64_t seed, uint64_t block) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (block + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// ==================== NHU CẦU ====================
+
+vector<double> dayWeights(const string& curve, int numDays, string& error) {
+    vector<double> w(numDays, 1.0);
+    if (curve == "flat") return w;
+    if (curve == "weekday") {
+        // Thứ 2-6 đủ, thứ 7 85%, chủ nhật 75%
+        for (int d = 0; d < numDays; d++) w[d] = d % 7 == 5 ? 0.85 : d % 7 == 6 ? 0.75 : 1.0;
+        return w;
+    }
+    if (curve == "sine") {
+        for (int d = 0; d < numDays; d++) w[d] = 1.0 + 0.2 * sin(2.0 * M_PI * d / 7.0);
+        return w;
+    }
+    vector<double> list;
+    if (!parseWeights(curve, list)) {
+        error = "invalid --day-curve " + curve;
+        return {};
+    }
+    for (int d = 0; d < numDays; d++) w[d] = list[d % list.size()];   // lặp theo chu kỳ
+    return w;
+}
+
+// Điền inst.demand / inst.demandAt; demandAt chỉ giữ lại khi khác nhau giữa các ngày
+bool buildDemand(const GenOptions& opt, long numHead, NSPInstance& inst, string& error) {
+    int S = opt.shiftsPerDay, D = opt.numDays;
+    vector<double> sw = opt.shiftWeights;
+    if (sw.empty()) sw = S == 3 ? vector<double>{542, 438, 225} : vector<double>(S, 1.0);
+    if ((int)sw.size() != S) {
+        error = "--shift-weights needs " + to_string(S) + " values";
+        return false;
+    }
+    vector<double> dw = dayWeights(opt.dayCurve, D, error);
+    if (dw.empty()) return false;
+    double swSum = 0, dwSum = 0;
+    for (double w : sw) swSum += w;
+    for (double w : dw) dwSum += w;
+    if (swSum <= 0 || dwSum <= 0) {
+        error = "weights must not all be zero";
+        return false;
+    }
+
+    long numRegular = opt.numNurses - numHead;
+    double capacity = numHead * (opt.headMax.lo + opt.headMax.hi) / 2.0 +
+                      numRegular * (opt.regularMax.lo + opt.regularMax.hi) / 2.0;
+    double total = opt.tightness * capacity;
+
+    mt19937_64 rng(mixSeed(opt.seed, ~0ULL));
+    uniform_real_distribution<double> unit(-1.0, 1.0);
+    inst.demandAt.assign(D * S, 0);
+    for (int d = 0; d < D; d++) {
+        for (int s = 0; s < S; s++) {
+            double v = total * (dw[d] / dwSum) * (sw[s] / swSum);
+            if (opt.noise > 0) v *= 1.0 + opt.noise * unit(rng);
+            inst.demandAt[d * S + s] = max(0, (int)lround(v));
+        }
+    }
+    inst.demand.assign(S, 0);
+    bool uniform = true;
+    for (int s = 0; s < S; s++) {
+        double sum = 0;
+        for (int d = 0; d < D; d++) {
+            sum += inst.demandAt[d * S + s];
+            if (inst.demandAt[d * S + s] != inst.demandAt[s]) uniform = false;
+        }
+        inst.demand[s] = (int)lround(sum / D);
+    }
+    if (uniform) inst.demandAt.clear();
+    return true;
+}
+
+// #12: nhu cầu kỹ năng k ở ca j = skillShare / numSkills x nhu cầu ca j, chia cho các khoa
+// theo trọng số ngẫu nhiên riêng từng (kỹ năng, ca); RNG riêng nên không đổi inst.demand
+void buildSkillDemand(const GenOptions& opt, NSPInstance& inst) {
+    if (opt.numSkills <= 0) return;
+    int T = inst.totalShifts();
+    inst.numWards = opt.numWards;
+    inst.numSkills = opt.numSkills;
+    inst.skillDemand.assign((size_t)opt.numWards * opt.numSkills * T, 0);
+    mt19937_64 rng(mixSeed(opt.seed ^ 0x5A5A5A5A5A5A5A5AULL, ~0ULL));
+    uniform_real_distribution<double> unit(0.5, 1.5);
+    vector<double> weights(opt.numWards);
+    for (int k = 0; k < opt.numSkills; k++) {
+        for (int j = 0; j < T; j++) {
+            double total = inst.demandFor(j) * opt.skillShare / opt.numSkills, sum = 0;
+            for (double& w : weights) sum += w = unit(rng);
+            // Làm tròn lũy kế để tổng qua các khoa đúng bằng lround(total)
+            double acc = 0;
+            long given = 0;
+            for (int w = 0; w < opt.numWards; w++) {
+                acc += total * weights[w] / sum;
+                long upTo = lround(acc);
+                inst.skillDemand[((size_t)w * opt.numSkills + k) * T + j] = (int)(upTo - given);
+                given = upTo;
+            }
+        }
+    }
+}
+
+// ==================== SINH Y TÁ ====================
+
+// Mask của y tá [begin, end), RNG riêng để bật / tắt mask không đổi thuộc tính y tá cùng seed
+void generateMasks(const GenOptions& opt, long block, long begin, long end,
+                   vector<uint64_t>& unavailable, vector<uint64_t>& avoid) {
+    int T = opt.numDays * opt.shiftsPerDay, W = (T + 63) / 64;
+    mt19937_64 rng(mixSeed(opt.seed ^ 0xA5A5A5A5A5A5A5A5ULL, block));
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    unavailable.assign(opt.unavailableRate > 0 ? (end - begin) * W : 0, 0);
+    avoid.assign(opt.avoidRate > 0 ? (end - begin) * W : 0, 0);
+    for (long i = 0; i < end - begin; i++) {
+        for (int d = 0; d < opt.numDays && !unavailable.empty(); d++) {
+            if (unit(rng) >= opt.unavailableRate) continue;
+            for (int j = d * opt.shiftsPerDay; j < (d + 1) * opt.shiftsPerDay; j++) {
+                unavailable[i * W + j / 64] |= uint64_t(1) << (j % 64);
+            }
+        }
+        for (int j = 0; j < T && !avoid.empty(); j++) {
+            if (unit(rng) < opt.avoidRate) avoid[i * W + j / 64] |= uint64_t(1) << (j % 64);
+        }
+    }
+}
+
+// Kỹ năng của y tá trong khối, RNG riêng như generateMasks
+void generateSkills(const GenOptions& opt, long block, vector<NSPNurse>& nurses) {
+    if (opt.numSkills <= 0) return;
+    mt19937_64 rng(mixSeed(opt.seed ^ 0x3C3C3C3C3C3C3C3CULL, block));
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    for (NSPNurse& n : nurses) {
+        for (int k = 0; k < opt.numSkills; k++) {
+            if (unit(rng) < opt.skillRate) n.skills |= 1u << k;
+        }
+    }
+}
+
+// Y tá [begin, end): trưởng là numHead y tá đầu tiên (như instance tham chiếu)
+void generateBlock(const GenOptions& opt, long numHead, long block, long begin, long end,
+                   vector<NSPNurse>& out) {
+    mt19937_64 rng(mixSeed(opt.seed, block));
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    out.clear();
+    for (long i = begin; i < end; i++) {
+        bool head = i < numHead;
+        const Range& minR = head ? opt.headMin : opt.regularMin;
+        const Range& maxR = head ? opt.headMax : opt.regularMax;
+        int minShift = uniform_int_distribution<int>(minR.lo, minR.hi)(rng);
+        int maxShift = max(minShift, uniform_int_distribution<int>(maxR.lo, maxR.hi)(rng));
+        bool female = unit(rng) < (head ? opt.headFemaleRatio : opt.femaleRatio);
+        out.push_back({(int)i, head, female, (double)minShift, (double)maxShift});
+    }
+}
+
+// Dạng text: mỗi đoạn ca liên tiếp của mask thành một dòng "KEY NURSE FROM TO"
+void appendMaskLines(string& buf, const char* key, int nurse, const uint64_t* mask, int T) {
+    char line[64];
+    for (int j = 0; j < T; j++) {
+        if (!((mask[j / 64] >> (j % 64)) & 1)) continue;
+        int from = j;
+        while (j + 1 < T && ((mask[(j + 1) / 64] >> ((j + 1) % 64)) & 1)) j++;
+        int len = snprintf(line, sizeof(line), "%s %d %d %d\n", key, nurse, from, j);
+        buf.append(line, len);
+    }
+}
+
+void appendNurses(string& buf, const vector<NSPNurse>& nurses, const vector<uint64_t>& unavailable,
+                  const vector<uint64_t>& avoid, int T, bool text) {
+    int W = (T + 63) / 64;
+    if (!text) {
+        size_t stride = sizeof(NSPNurseRecord) +
+                        ((unavailable.empty() ? 0 : W) + (avoid.empty() ? 0 : W)) * sizeof(uint64_t);
+        buf.reserve(buf.size() + nurses.size() * stride);
+        for (size_t k = 0; k < nurses.size(); k++) {
+            appendNurseBytes(buf, toNurseRecord(nurses[k]),
+                             unavailable.empty() ? nullptr : &unavailable[k * W],
+                             avoid.empty() ? nullptr : &avoid[k * W], W);
+        }
+        return;
+    }
+    char line[96];
+    for (size_t k = 0; k < nurses.size(); k++) {
+        const NSPNurse& n = nurses[k];
+        int len = snprintf(line, sizeof(line), "nurse YT%d %s %s %d %d\n", n.id,
+                           n.isHead ? "head" : "normal", n.isFemale ? "female" : "male",
+                           (int)n.minShift, (int)n.maxShift);
+        buf.append(line, len);
+        if (!unavailable.empty()) appendMaskLines(buf, "unavailable", n.id, &unavailable[k * W], T);
+        if (!avoid.empty()) appendMaskLines(buf, "avoid", n.id, &avoid[k * W], T);
+        if (n.skills) {
+            string skills = "skills " + to_string(n.id);
+            for (int b = 0; b < NSP_MAX_SKILLS; b++) {
+                if ((n.skills >> b) & 1) skills += " " + to_string(b);
+            }
+            buf += skills + "\n";
+        }
+    }
+}
+
+// Phần đầu file text (readInstanceText của nsp_backend.h)
+string textHeader(const NSPInstance& inst, const GenOptions& opt) {
+    ostringstream out;
+    out << "# nsp_gen --nurses " << opt.numNurses << " --seed " << opt.seed << "\n"
+        << "days " << inst.numDays << "\n"
+        << "shifts_per_day " << inst.shiftsPerDay << "\n"
+        << "min_afternoon " << inst.minAfternoon << "\n"
+        << "min_night " << inst.minNight << "\n"
+        << "min_morning_head " << inst.minMorningPerHead << "\n"
+        << "min_head_per_morning " << inst.minHeadPerMorning << "\n"
+        << "cost_per_shift " << inst.costNormal << "\n"
+        << "overtime_cost " << inst.costOvertime - inst.costNormal << "\n"
+        << "head_cost " << inst.costHead << "\n";
+    if (opt.avoidRate > 0) out << "preference_cost " << inst.costPreference << "\n";
+    out << "demand";
+    for (int d : inst.demand) out << " " << d;
+    out << "\n";
+    for (int j = 0; j < (int)inst.demandAt.size(); j++) {
+        out << "demand_at " << j / inst.shiftsPerDay << " " << j % inst.shiftsPerDay << " "
+            << inst.demandAt[j] << "\n";
+    }
+    int T = inst.totalShifts();
+    for (int w = 0; w < inst.numWards && !inst.skillDemand.empty(); w++) {
+        for (int k = 0; k < inst.numSkills; k++) {
+            for (int j = 0; j < T; j++) {
+                int n = inst.skillDemandAt(w, k, j);
+                if (n > 0) {
+                    out << "skill_demand " << w << " " << k << " " << j / inst.shiftsPerDay << " "
+                        << j % inst.shiftsPerDay << " " << n << "\n";
+                }
+            }
+        }
+    }
+    return out.str();
+}
+
+void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " --out FILE [options]\n"
+         << "  --nurses N              số y tá (mặc định 1983)\n"
+         << "  --days D / --shifts S   số ngày / số ca mỗi ngày (7 / 3)\n"
+         << "  --heads R               tỉ lệ y tá trưởng (0.622)\n"
+         << "  --female R              tỉ lệ nữ trong y tá thường (0.113)\n"
+         << "  --head-female R         tỉ lệ nữ trong y tá trưởng (1.0)\n"
+         << "  --head-min A-B / --head-max A-B        min/max ca y tá trưởng (5 / 9)\n"
+         << "  --regular-min A-B / --regular-max A-B  min/max ca y tá thường (6 / 9)\n"
+         << "  --tightness T           tổng nhu cầu / tổng maxShift (0.47)\n"
+         << "  --shift-weights w,...   tỉ lệ nhu cầu theo loại ca (542,438,225)\n"
+         << "  --day-curve C           flat | weekday | sine | w1,w2,... (flat)\n"
+         << "  --noise X               nhiễu ±X trên nhu cầu từng ca (0)\n"
+         << "  --head-per-morning R    #7 = R x số y tá trưởng (0.12)\n"
+         << "  --min-morning-head K    #7' (0)\n"
+         << "  --min-afternoon K / --min-night K     #4 / #5 (2 / 1)\n"
+         << "  --unavailable R         xác suất y tá nghỉ cả một ngày, #11 (0)\n"
+         << "  --avoid R               xác suất y tá muốn tránh một ca (0)\n"
+         << "  --preference-cost C     phạt mỗi ca rơi vào ô avoid (100)\n"
+         << "  --wards N / --skills K  số khoa / số kỹ năng (<= 8) của nhu cầu #12 (1 / 0)\n"
+         << "  --skill-rate R          xác suất y tá có từng kỹ năng (0.3)\n"
+         << "  --skill-share S         phần nhu cầu mỗi ca cần kỹ năng (0.3)\n"
+         << "  --seed N / --threads N / --block N\n"
+         << "  --format bin|text       NSPI nhị phân (mặc định) hoặc text cho nsp --instance\n";
+}
+
+// ==================== MAIN ====================
+
+int main(int argc, char** argv) {
+    GenOptions opt;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        bool hasValue = a + 1 < argc;
+        string value = hasValue ? argv[a + 1] : "";
+        bool ok = hasValue;
+        if (arg == "--nurses") opt.numNurses = atol(value.c_str());
+        else if (arg == "--days") opt.numDays = atoi(value.c_str());
+        else if (arg == "--shifts") opt.shiftsPerDay = atoi(value.c_str());
+        else if (arg == "--heads") opt.headRatio = atof(value.c_str());
+        else if (arg == "--female") opt.femaleRatio = atof(value.c_str());
+        else if (arg == "--head-female") opt.headFemaleRatio = atof(value.c_str());
+        else if (arg == "--head-min") ok = parseRange(value, opt.headMin);
+        else if (arg == "--head-max") ok = parseRange(value, opt.headMax);
+        else if (arg == "--regular-min") ok = parseRange(value, opt.regularMin);
+        else if (arg == "--regular-max") ok = parseRange(value, opt.regularMax);
+        else if (arg == "--tightness") opt.tightness = atof(value.c_str());
+        else if (arg == "--shift-weights") ok = parseWeights(value, opt.shiftWeights);
+        else if (arg == "--day-curve") opt.dayCurve = value;
+        else if (arg == "--noise") opt.noise = atof(value.c_str());
+        else if (arg == "--head-per-morning") opt.headPerMorning = atof(value.c_str());
+        else if (arg == "--min-morning-head") opt.minMorningPerHead = atoi(value.c_str());
+        else if (arg == "--min-afternoon") opt.minAfternoon = atoi(value.c_str());
+        else if (arg == "--min-night") opt.minNight = atoi(value.c_str());
+        else if (arg == "--unavailable") opt.unavailableRate = atof(value.c_str());
+        else if (arg == "--avoid") opt.avoidRate = atof(value.c_str());
+        else if (arg == "--preference-cost") opt.costPreference = atof(value.c_str());
+        else if (arg == "--wards") opt.numWards = atoi(value.c_str());
+        else if (arg == "--skills") opt.numSkills = atoi(value.c_str());
+        else if (arg == "--skill-rate") opt.skillRate = atof(value.c_str());
+        else if (arg == "--skill-share") opt.skillShare = atof(value.c_str());
+        else if (arg == "--seed") opt.seed = strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--threads") opt.threads = atoi(value.c_str());
+        else if (arg == "--block") opt.blockSize = max(1L, atol(value.c_str()));
+        else if (arg == "--out") opt.out = value;
+        else if (arg == "--format") {
+            ok = value == "bin" || value == "text";
+            opt.text = value == "text";
+        } else if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!ok) {
+            cerr << "Invalid value for " << arg << endl;
+            return 1;
+        }
+        a++;
+    }
+    if (opt.out.empty() || opt.numNurses <= 0 || opt.numNurses > INT32_MAX || opt.numDays <= 0 ||
+        opt.shiftsPerDay <= 0 || opt.headRatio < 0 || opt.headRatio > 1 || opt.tightness < 0 ||
+        opt.numWards <= 0 || opt.numSkills < 0 || opt.numSkills > NSP_MAX_SKILLS || opt.skillShare < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+    long numHead = lround(opt.numNurses * opt.headRatio);
+    NSPInstance inst;
+    inst.numDays = opt.numDays;
+    inst.shiftsPerDay = opt.shiftsPerDay;
+    inst.minAfternoon = opt.minAfternoon;
+    inst.minNight = opt.minNight;
+    inst.minHeadPerMorning = (int)lround(numHead * opt.headPerMorning);
+    inst.minMorningPerHead = opt.minMorningPerHead;
+    inst.costNormal = opt.costNormal;
+    inst.costOvertime = opt.costOvertime;
+    inst.costHead = opt.costHead;
+    inst.costPreference = opt.avoidRate > 0 ? opt.costPreference : 0;
+    string error;
+    if (!buildDemand(opt, numHead, inst, error)) {
+        cerr << error << endl;
+        return 1;
+    }
+    buildSkillDemand(opt, inst);
+
+    FILE* f = fopen(opt.out.c_str(), "wb");
+    if (!f) {
+        cerr << "Cannot write " << opt.out << endl;
+        return 1;
+    }
+    string header = opt.text ? textHeader(inst, opt)
+                             : instanceHeaderBytes(inst, opt.numNurses, opt.unavailableRate > 0,
+                                                   opt.avoidRate > 0);
+    bool ok = fwrite(header.data(), 1, header.size(), f) == header.size();
+    size_t bytes = header.size();
+
+    // Mỗi đợt: mỗi thread sinh một khối vào buffer riêng, rồi ghi các khối theo thứ tự
+    int numThreads = opt.threads > 0 ? opt.threads : max(1u, thread::hardware_concurrency());
+    long numBlocks = (opt.numNurses + opt.blockSize - 1) / opt.blockSize;
+    vector<vector<NSPNurse>> nurses(numThreads);
+    vector<vector<uint64_t>> unavailable(numThreads), avoid(numThreads);
+    vector<string> buffers(numThreads);
+    long females = 0, minSum = 0, maxSum = 0, unavailableShifts = 0, avoidShifts = 0;
+    vector<long> skilled(NSP_MAX_SKILLS, 0);
+    for (long wave = 0; wave < numBlocks && ok; wave += numThreads) {
+        int active = (int)min<long>(numThreads, numBlocks - wave);
+        vector<thread> workers;
+        auto work = [&](int t) {
+            long block = wave + t;
+            long begin = block * opt.blockSize, end = min(opt.numNurses, begin + opt.blockSize);
+            generateBlock(opt, numHead, block, begin, end, nurses[t]);
+            generateSkills(opt, block, nurses[t]);
+            generateMasks(opt, block, begin, end, unavailable[t], avoid[t]);
+            buffers[t].clear();
+            appendNurses(buffers[t], nurses[t], unavailable[t], avoid[t], inst.totalShifts(), opt.text);
+        };
+        for (int t = 1; t < active; t++) workers.emplace_back(work, t);
+        work(0);
+        for (thread& w : workers) w.join();
+        for (int t = 0; t < active && ok; t++) {
+            ok = fwrite(buffers[t].data(), 1, buffers[t].size(), f) == buffers[t].size();
+            bytes += buffers[t].size();
+            for (const NSPNurse& n : nurses[t]) {
+                females += n.isFemale;
+                minSum += (long)n.minShift;
+                maxSum += (long)n.maxShift;
+                for (int k = 0; k < opt.numSkills; k++) skilled[k] += (n.skills >> k) & 1;
+            }
+            for (uint64_t w : unavailable[t]) unavailableShifts += __builtin_popcountll(w);
+            for (uint64_t w : avoid[t]) avoidShifts += __builtin_popcountll(w);
+        }
+    }
+    ok = fclose(f) == 0 && ok;
+    if (!ok) {
+        cerr << "Write failed: " << opt.out << endl;
+        return 1;
+    }
+    double genMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+    long totalDemand = 0;
+    for (int j = 0; j < inst.totalShifts(); j++) totalDemand += inst.demandFor(j);
+    cout << "NURSES=" << opt.numNurses << endl;
+    cout << "HEADS=" << numHead << endl;
+    cout << "FEMALE=" << females << endl;
+    cout << "DEMAND=";
+    for (int s = 0; s < inst.shiftsPerDay; s++) cout << (s ? "," : "") << inst.demand[s];
+    cout << (inst.demandAt.empty() ? "" : " (theo ngày)") << endl;
+    cout << "TOTAL_DEMAND=" << totalDemand << endl;
+    cout << "SUM_MIN_SHIFTS=" << minSum << endl;
+    cout << "SUM_MAX_SHIFTS=" << maxSum << endl;
+    cout << "TIGHTNESS=" << fixed << setprecision(3)
+         << (maxSum > 0 ? (double)totalDemand / maxSum : 0.0) << endl;
+    if (opt.unavailableRate > 0) cout << "UNAVAILABLE_SHIFTS=" << unavailableShifts << endl;
+    if (opt.avoidRate > 0) cout << "AVOID_SHIFTS=" << avoidShifts << endl;
+    if (opt.numSkills > 0) {
+        long skillDemand = 0;
+        for (int d : inst.skillDemand) skillDemand += d;
+        cout << "WARDS=" << opt.numWards << endl;
+        cout << "SKILLED=";
+        for (int k = 0; k < opt.numSkills; k++) cout << (k ? "," : "") << skilled[k];
+        cout << endl;
+        cout << "SKILL_DEMAND=" << skillDemand << endl;
+        cout << "SKILL_ROWS=" << skillCoverageRows(inst).size() << endl;
+    }
+    cout << "SEED=" << opt.seed << endl;
+    cout << "BYTES=" << bytes << endl;
+    cout << "GEN_MS=" << setprecision(2) << genMs << endl;
+    return 0;
+}
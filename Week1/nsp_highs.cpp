@@ -2,6 +2,20 @@
  * Nurse Scheduling Problem (NSP) - C++ gọi HiGHS solver
  * Dùng HiGHS C API, cùng data như Rust/Python
  * Compile: g++ -O3 -std=c++17 nsp_highs.cpp -lhighs -o nsp_highs
+ *
+ * Chạy:    ./nsp_highs                  (sinh đủ mọi ràng buộc #9, #10)
+ *          ./nsp_highs --lazy-windows   (cut loop: chỉ thêm hàng #9/#10 bị vi phạm)
+ *          ./nsp_highs --sweep-demand sang=500:560:10
+ *                                       (giữ model, chỉ đổi cận hàng nhu cầu rồi giải lại)
+ *          ./nsp_highs --progress-csv progress.csv
+ *                                       (ghi timeline incumbent / bound / gap ra CSV)
+ *          ./nsp_highs --threads 4 --time-limit 60 --mip-rel-gap 0.001
+ *                                       (tùy chọn HiGHS, xem --help)
+ *          ./nsp_highs --bench-threads 1,2,4,8,16 --bench-repeats 3
+ *                                       (benchmark scaling theo số luồng)
+ *          ./nsp_highs --model-cache cache/ (lưu/đọc model MPS theo hash tham số)
+ *
+ * Instance: makeReferenceInstance() trong nsp_backend.h; HighsBackend là backend "highs" của nsp_bench
  */
 
 #include <iostream>
@@ -10,6 +24,15 @@
 #include <chrono>
 #include <cstring>
 #include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <memory>
+
+#include "nsp_backend.h"
 
 // HiGHS C API
 extern "C" {
@@ -18,74 +41,434 @@ extern "C" {
 
 using namespace std;
 
-// ==================== CẤU HÌNH ====================
+namespace nsp_highs {
 
-const int NUM_NURSES    = 1983;
-const int NUM_DAYS      = 7;
-const int NUM_SHIFTS    = 3;           // sang, chieu, toi
-const int NUM_HEAD_NUR  = 1234;
+// ==================== CẤU TRÚC ====================
 
-const double COST_NORMAL  = 1000.0;
-const double COST_OVERTIME = 1200.0;
-const double COST_HEAD    = 1500.0;
+// Instance (số y tá, nhu cầu, chi phí, ...) lấy từ NSPInstance, xem nsp_backend.h
+typedef NSPNurse Nurse;
 
-const double MIN_AFTERNOON = 2.0;
-const double MIN_NIGHT     = 1.0;
-const double MIN_HEAD      = 150.0;
+// ==================== LAZY #9/#10 ====================
 
-const double DEMAND[3]    = {542.0, 438.0, 225.0};
+// Gói x[i,*,*] của một y tá thành bit: bit j = 1 nếu làm ca j (j = d * numShifts + s)
+void packNurseBits(const vector<double>& colValue, int base, int totalShift,
+                   vector<uint64_t>& words) {
+    fill(words.begin(), words.end(), 0);
+    for (int j = 0; j < totalShift; j++) {
+        if (colValue[base + j] > 0.5) words[j >> 6] |= uint64_t(1) << (j & 63);
+    }
+}
 
-const int NUM_VARIABLES  = NUM_NURSES * NUM_DAYS * NUM_SHIFTS;  // 41643
+// Lấy 64 bit bắt đầu tại vị trí pos (có thể vắt qua 2 word)
+inline uint64_t bitsAt(const vector<uint64_t>& words, int pos) {
+    int q = pos >> 6, r = pos & 63;
+    uint64_t v = words[q] >> r;
+    if (r != 0 && q + 1 < (int)words.size()) v |= words[q + 1] << (64 - r);
+    return v;
+}
 
-// ==================== CẤU TRÚC ====================
+// Hàng cắt cần thêm vào model (row-wise, cùng định dạng với Highs_addRows)
+struct CutRows {
+    vector<double> lower, upper;
+    vector<int> start, index;
+    vector<double> value;
+
+    void add(const int* cols, int n, double ub) {
+        start.push_back((int)index.size());
+        for (int t = 0; t < n; t++) {
+            index.push_back(cols[t]);
+            value.push_back(1.0);
+        }
+        lower.push_back(-1e30);
+        upper.push_back(ub);
+    }
+    int size() const { return (int)lower.size(); }
+};
+
+// Quét lời giải, trả về các hàng #9 (x[j] + x[j+2] <= 1) và #10 (5 ca liên tiếp <= 2) bị vi phạm
+CutRows findViolatedWindows(const vector<double>& colValue, const vector<int>& norNurses,
+                            int totalShift, int& numPair, int& numWindow) {
+    CutRows cuts;
+    numPair = numWindow = 0;
+    vector<uint64_t> words((totalShift + 63) / 64);
+
+    for (int i : norNurses) {
+        int base = i * totalShift;
+        packNurseBits(colValue, base, totalShift, words);
+
+        int worked = 0;
+        for (uint64_t w : words) worked += __builtin_popcountll(w);
+        if (worked < 2) continue;
+
+        // #9: bit j của (m & (m >> 2)) = 1 khi làm cả ca j và j+2
+        for (int pos = 0; pos < totalShift - 2; pos += 62) {
+            uint64_t m = bitsAt(words, pos);
+            uint64_t hits = m & (m >> 2);
+            int span = min(62, totalShift - 2 - pos);
+            hits &= (uint64_t(1) << span) - 1;
+            while (hits) {
+                int j = pos + __builtin_ctzll(hits);
+                int cols[2] = {base + j, base + j + 2};
+                cuts.add(cols, 2, 1.0);
+                numPair++;
+                hits &= hits - 1;
+            }
+        }
 
-struct Nurse {
-    int id;
-    bool isHead;
-    bool isFemale;
-    double minShift;
-    double maxShift;
+        // #10: cửa sổ 5 ca có > 2 ca làm việc
+        if (worked < 3) continue;
+        for (int j = 0; j < totalShift - 4; j++) {
+            if (__builtin_popcountll(bitsAt(words, j) & 0x1F) > 2) {
+                int cols[5] = {base + j, base + j + 1, base + j + 2, base + j + 3, base + j + 4};
+                cuts.add(cols, 5, 2.0);
+                numWindow++;
+            }
+        }
+    }
+    return cuts;
+}
+
+struct LazyStats {
+    int rounds = 0;
+    int pairRows = 0;
+    int windowRows = 0;
 };
 
-// ==================== BUILD MODEL ====================
+// ==================== PROGRESS LOG ====================
 
-int main() {
-    cout << R"(
-╔════════════════════════════════════════════════════════════════╗
-║     NSP - C++ gọi HiGHS solver (C API)                     ║
-║     So sánh với Rust + good_lp + highs-sys                 ║
-╚════════════════════════════════════════════════════════════════╝
-)" << endl;
+struct ProgressEvent {
+    double timeMs;        // tính từ lúc bắt đầu giải
+    const char* kind;     // "incumbent" | "bound"
+    int round;            // vòng cut loop (0 nếu không lazy)
+    double primal;        // incumbent tốt nhất
+    double dual;          // best bound
+    double gap;           // gap tương đối
+    int64_t nodes;
+};
 
-    cout << "Data: " << NUM_NURSES << " nurses, " << NUM_DAYS << " days, "
-         << NUM_SHIFTS << " shifts" << endl;
-    cout << "Variables: " << NUM_VARIABLES << " binary" << endl;
+struct ProgressLog {
+    chrono::high_resolution_clock::time_point start;
+    int round = 0;
+    vector<ProgressEvent> events;
+    double lastBound = -1e30;
+    double lastRecordMs = -1e30;
+    double firstIncumbentMs = -1.0;
+    int numIncumbents = 0;
+
+    double elapsedMs() const {
+        return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+    }
 
-    // ========== XÂY DỰNG DỮ LIỆU ==========
+    bool writeCsv(const string& path) const {
+        ofstream out(path);
+        if (!out) return false;
+        out << "time_ms,event,round,primal_bound,dual_bound,gap,nodes\n";
+        out << fixed;
+        for (const ProgressEvent& e : events) {
+            out << setprecision(2) << e.timeMs << ',' << e.kind << ',' << e.round << ','
+                << setprecision(2) << e.primal << ',' << e.dual << ','
+                << setprecision(6) << e.gap << ',' << e.nodes << '\n';
+        }
+        return (bool)out;
+    }
+};
 
-    vector<Nurse> nurses;
-    vector<int> headNurses, norNurses, femaleNurses;
+// Callback HiGHS: mỗi incumbent mới được ghi ngay; bound/gap lấy mẫu từ MipInterrupt
+// (gọi rất dày) nên chỉ ghi khi bound đổi hoặc đã qua 1 giây.
+void progressCallback(int callbackType, const char* /*message*/,
+                      const HighsCallbackDataOut* out, HighsCallbackDataIn* /*in*/,
+                      void* userData) {
+    ProgressLog* log = static_cast<ProgressLog*>(userData);
+    double t = log->elapsedMs();
+
+    if (callbackType == kHighsCallbackMipImprovingSolution) {
+        log->events.push_back({t, "incumbent", log->round, out->objective_function_value,
+                               out->mip_dual_bound, out->mip_gap, out->mip_node_count});
+        log->numIncumbents++;
+        if (log->firstIncumbentMs < 0) log->firstIncumbentMs = t;
+        cout << "  [" << fixed << setprecision(0) << setw(8) << t << " ms] incumbent "
+             << out->objective_function_value << "  bound " << out->mip_dual_bound
+             << "  gap " << setprecision(2) << 100.0 * out->mip_gap << "%"
+             << "  nodes " << out->mip_node_count << endl;
+        log->lastRecordMs = t;
+        log->lastBound = out->mip_dual_bound;
+    } else if (callbackType == kHighsCallbackMipInterrupt) {
+        bool boundMoved = fabs(out->mip_dual_bound - log->lastBound) > 1e-6 * max(1.0, fabs(log->lastBound));
+        if (boundMoved || t - log->lastRecordMs >= 1000.0) {
+            log->events.push_back({t, "bound", log->round, out->mip_primal_bound,
+                                   out->mip_dual_bound, out->mip_gap, out->mip_node_count});
+            log->lastRecordMs = t;
+            log->lastBound = out->mip_dual_bound;
+        }
+    }
+}
 
-    for (int i = 0; i < NUM_HEAD_NUR; i++) {
-        nurses.push_back({i, true, true, 5.0, 9.0});
+// Callback của HighsBackend: chuyển incumbent mới cho NSPProgressFn. HiGHS chỉ đọc
+// user_interrupt ở các callback *Interrupt nên yêu cầu dừng được trả ở MipInterrupt kế tiếp.
+struct BackendProgress {
+    const NSPProgressFn* fn;
+    chrono::high_resolution_clock::time_point start;
+    bool stop = false;
+};
+
+void backendProgressCallback(int callbackType, const char* /*message*/,
+                             const HighsCallbackDataOut* out, HighsCallbackDataIn* in,
+                             void* userData) {
+    BackendProgress* p = static_cast<BackendProgress*>(userData);
+    if (callbackType == kHighsCallbackMipImprovingSolution) {
+        double t = chrono::duration<double, milli>(
+            chrono::high_resolution_clock::now() - p->start).count();
+        if (!(*p->fn)(t, out->objective_function_value)) p->stop = true;
+    } else if (callbackType == kHighsCallbackMipInterrupt && p->stop && in) {
+        in->user_interrupt = 1;
     }
-    for (int i = 0; i < NUM_NURSES - NUM_HEAD_NUR; i++) {
-        nurses.push_back({i + NUM_HEAD_NUR, false, i >= 664, 6.0, 9.0});
+}
+
+// Highs_run, sau đó (nếu lazy) thêm hàng #9/#10 bị vi phạm và giải lại cho đến khi sạch.
+// colValue/rowValue nhận lời giải cuối cùng.
+HighsInt runHighs(void* highs, bool lazyWindows, const vector<int>& norNurses,
+                  int totalShift, vector<double>& colValue, vector<double>& rowValue,
+                  LazyStats& lazy, ProgressLog* progress = nullptr) {
+    if (progress) progress->round = 0;
+    HighsInt runStatus = Highs_run(highs);
+    rowValue.resize(Highs_getNumRow(highs));
+    Highs_getSolution(highs, colValue.data(), nullptr, rowValue.data(), nullptr);
+
+    // ---- CUT LOOP ----
+    while (lazyWindows && runStatus != kHighsStatusError &&
+           Highs_getModelStatus(highs) == kHighsModelStatusOptimal) {
+        int numPair = 0, numWindow = 0;
+        CutRows cuts = findViolatedWindows(colValue, norNurses, totalShift, numPair, numWindow);
+        if (cuts.size() == 0) break;
+
+        lazy.rounds++;
+        lazy.pairRows += numPair;
+        lazy.windowRows += numWindow;
+        cout << "  Round " << lazy.rounds << ": +" << numPair << " rows #9, +"
+             << numWindow << " rows #10" << endl;
+
+        Highs_addRows(highs, cuts.size(), cuts.lower.data(), cuts.upper.data(),
+                      (int)cuts.index.size(), cuts.start.data(),
+                      cuts.index.data(), cuts.value.data());
+
+        // Warm start từ lời giải trước (HiGHS tự sửa nếu nó vi phạm hàng mới)
+        Highs_setSolution(highs, colValue.data(), nullptr, nullptr, nullptr);
+
+        if (progress) progress->round = lazy.rounds;
+        runStatus = Highs_run(highs);
+        rowValue.resize(Highs_getNumRow(highs));
+        Highs_getSolution(highs, colValue.data(), nullptr, rowValue.data(), nullptr);
     }
+    return runStatus;
+}
 
-    for (int i = 0; i < NUM_NURSES; i++) {
-        if (nurses[i].isHead) headNurses.push_back(i);
-        else norNurses.push_back(i);
-        if (nurses[i].isFemale) femaleNurses.push_back(i);
+// ==================== SWEEP DEMAND ====================
+
+// "--sweep-demand S=V1,V2,..." hoặc "S=FROM:TO:STEP", S = 0/1/2 hoặc sang/chieu/toi
+bool parseSweep(const string& spec, int& shift, vector<double>& values) {
+    size_t eq = spec.find('=');
+    if (eq == string::npos) return false;
+    string sh = spec.substr(0, eq);
+    if (sh == "0" || sh == "sang") shift = 0;
+    else if (sh == "1" || sh == "chieu") shift = 1;
+    else if (sh == "2" || sh == "toi") shift = 2;
+    else return false;
+
+    string rest = spec.substr(eq + 1);
+    values.clear();
+    if (rest.find(':') != string::npos) {
+        double from, to, step;
+        if (sscanf(rest.c_str(), "%lf:%lf:%lf", &from, &to, &step) != 3 || step == 0.0) return false;
+        for (double v = from; step > 0 ? v <= to + 1e-9 : v >= to - 1e-9; v += step) {
+            values.push_back(v);
+        }
+    } else {
+        size_t pos = 0;
+        while (pos <= rest.size()) {
+            size_t comma = rest.find(',', pos);
+            if (comma == string::npos) comma = rest.size();
+            if (comma > pos) values.push_back(atof(rest.substr(pos, comma - pos).c_str()));
+            pos = comma + 1;
+        }
     }
+    return !values.empty();
+}
 
-    // ========== XÂY DỰNG MODEL CHO HIGHS ==========
+const char* modelStatusName(HighsInt modelStatus) {
+    switch (modelStatus) {
+        case kHighsModelStatusOptimal:    return "OPTIMAL";
+        case kHighsModelStatusInfeasible: return "INFEASIBLE";
+        case kHighsModelStatusTimeLimit:  return "TIME_LIMIT";
+        case kHighsModelStatusIterationLimit: return "ITERATION_LIMIT";
+        case kHighsModelStatusSolutionLimit:  return "SOLUTION_LIMIT";
+        case kHighsModelStatusInterrupt:  return "INTERRUPT";
+        case kHighsModelStatusUnboundedOrInfeasible: return "UNBOUNDED_OR_INFEASIBLE";
+        default:                          return "OTHER";
+    }
+}
 
-    auto buildStart = chrono::high_resolution_clock::now();
+// ==================== TÙY CHỌN HIGHS ====================
+
+struct SolverOptions {
+    int threads = 0;            // 0 = HiGHS tự chọn
+    double timeLimit = -1.0;    // giây, < 0 = không giới hạn
+    double mipRelGap = -1.0;    // < 0 = mặc định HiGHS (1e-4)
+    double mipAbsGap = -1.0;    // < 0 = mặc định HiGHS (1e-6)
+    string presolve;            // "on" | "off" | "choose", rỗng = mặc định
+    int randomSeed = -1;        // < 0 = mặc định HiGHS
+    string parallel;            // "on" | "off" | "choose", rỗng = mặc định
+};
+
+void applyOptions(void* highs, const SolverOptions& opt) {
+    if (opt.threads > 0)       Highs_setIntOptionValue(highs, "threads", opt.threads);
+    if (opt.timeLimit >= 0)    Highs_setDoubleOptionValue(highs, "time_limit", opt.timeLimit);
+    if (opt.mipRelGap >= 0)    Highs_setDoubleOptionValue(highs, "mip_rel_gap", opt.mipRelGap);
+    if (opt.mipAbsGap >= 0)    Highs_setDoubleOptionValue(highs, "mip_abs_gap", opt.mipAbsGap);
+    if (!opt.presolve.empty()) Highs_setStringOptionValue(highs, "presolve", opt.presolve.c_str());
+    if (opt.randomSeed >= 0)   Highs_setIntOptionValue(highs, "random_seed", opt.randomSeed);
+    if (!opt.parallel.empty()) Highs_setStringOptionValue(highs, "parallel", opt.parallel.c_str());
+}
+
+vector<int> parseIntList(const string& text) {
+    vector<int> values;
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == string::npos) comma = text.size();
+        if (comma > pos) values.push_back(atoi(text.substr(pos, comma - pos).c_str()));
+        pos = comma + 1;
+    }
+    return values;
+}
+
+void printUsage(const char* prog) {
+    cerr << "Usage: " << prog << " [options]\n"
+         << "  --lazy-windows              add #9/#10 rows only when violated (cut loop)\n"
+         << "  --sweep-demand SPEC         S=V1,V2,... or S=FROM:TO:STEP (S = sang|chieu|toi|0|1|2)\n"
+         << "  --progress-csv FILE         write incumbent/bound/gap timeline\n"
+         << "  --threads N                 HiGHS threads (0 = auto)\n"
+         << "  --time-limit SEC            stop after SEC seconds\n"
+         << "  --mip-rel-gap G             relative MIP gap\n"
+         << "  --mip-abs-gap G             absolute MIP gap\n"
+         << "  --presolve on|off|choose\n"
+         << "  --seed N                    HiGHS random_seed\n"
+         << "  --parallel on|off|choose\n"
+         << "  --bench-threads 1,2,4,...   thread-scaling benchmark, then exit\n"
+         << "  --bench-repeats R           runs per thread count (default 3)\n"
+         << "  --model-cache DIR           reuse DIR/nsp_<hash>.mps instead of rebuilding\n"
+         << "  --write-model FILE          export the model (.mps or .lp)" << endl;
+}
+
+// ==================== BENCHMARK THREADS ====================
+
+struct BenchRun {
+    double ms;
+    double cost;
+    HighsInt modelStatus;
+};
+
+// ==================== BUILD MODEL ====================
+
+// Ma trận row-wise sẵn sàng đưa vào Highs_passMip
+struct MipModel {
+    HighsInt numCols = 0;
+    HighsInt numRows = 0;
+    HighsInt numNnz = 0;
+    vector<double> costs, colLower, colUpper;
+    vector<HighsInt> integrality;
+    vector<double> rowLower, rowUpper;
+    vector<int> aStart, aIndex;
+    vector<double> aValue;
+    // Cột của ô i * totalShift + j, -1 = ô unavailable không tạo cột; rỗng = cột k là ô k
+    vector<HighsInt> cellCol;
+
+    HighsInt passTo(void* highs) const {
+        return Highs_passMip(highs, numCols, numRows, numNnz,
+                             kHighsMatrixFormatRowwise,
+                             kHighsObjSenseMinimize,
+                             0.0,
+                             costs.data(),
+                             colLower.data(),
+                             colUpper.data(),
+                             rowLower.data(),
+                             rowUpper.data(),
+                             aStart.data(),
+                             aIndex.data(),
+                             aValue.data(),
+                             integrality.data());
+    }
+};
+
+// Bỏ cột của các ô unavailable: xóa hệ số của chúng khỏi mọi hàng và đánh lại chỉ số cột.
+// Hàng vẫn giữ nguyên nên thứ tự hàng (overtime, #1, ...) không đổi
+void dropUnavailableColumns(MipModel& m, const NSPInstance& inst) {
+    if (inst.unavailable.empty()) return;
+    HighsInt numCells = inst.nurses.size() * (HighsInt)inst.totalShifts();
+    vector<HighsInt> newCol(m.numCols);
+    HighsInt kept = 0;
+    for (HighsInt c = 0; c < m.numCols; c++) {
+        bool drop = c < numCells && inst.isUnavailable(c / inst.totalShifts(), c % inst.totalShifts());
+        newCol[c] = drop ? -1 : kept;
+        if (drop) continue;
+        m.costs[kept] = m.costs[c];
+        m.colLower[kept] = m.colLower[c];
+        m.colUpper[kept] = m.colUpper[c];
+        m.integrality[kept] = m.integrality[c];
+        kept++;
+    }
+    m.costs.resize(kept);
+    m.colLower.resize(kept);
+    m.colUpper.resize(kept);
+    m.integrality.resize(kept);
+
+    int pos = 0;
+    for (HighsInt r = 0; r < m.numRows; r++) {
+        int begin = m.aStart[r], end = m.aStart[r + 1];
+        m.aStart[r] = pos;
+        for (int k = begin; k < end; k++) {
+            if (newCol[m.aIndex[k]] < 0) continue;
+            m.aIndex[pos] = newCol[m.aIndex[k]];
+            m.aValue[pos] = m.aValue[k];
+            pos++;
+        }
+    }
+    m.aStart[m.numRows] = pos;
+    m.aIndex.resize(pos);
+    m.aValue.resize(pos);
+    m.numNnz = pos;
+    m.numCols = kept;
+    m.cellCol.assign(newCol.begin(), newCol.begin() + numCells);
+}
+
+// #12: thêm một hàng Hall mỗi (ca, tập kỹ năng) ở cuối ma trận; y tá phủ hàng nếu có ít nhất
+// một kỹ năng trong tập. Số hàng theo số kỹ năng, không theo số khoa, và không thêm cột nào
+void appendSkillRows(MipModel& m, const NSPInstance& inst) {
+    const int T = inst.totalShifts();
+    for (const NSPSkillRow& row : skillCoverageRows(inst)) {
+        for (int i = 0; i < (int)inst.nurses.size(); i++) {
+            if (!(inst.nurses[i].skills & row.skills)) continue;
+            m.aIndex.push_back(i * T + row.shift);
+            m.aValue.push_back(1.0);
+        }
+        m.rowLower.push_back(row.required);
+        m.rowUpper.push_back(1e30);
+        m.aStart.push_back(m.aIndex.size());
+        m.numRows++;
+    }
+    m.numNnz = m.aIndex.size();
+}
+
+MipModel buildModel(const NSPInstance& inst, const vector<int>& headNurses,
+                    const vector<int>& norNurses, const vector<int>& femaleNurses,
+                    bool lazyWindows) {
+    const vector<Nurse>& nurses = inst.nurses;
+    const int numNurses = nurses.size();
+    const int numDays = inst.numDays;
+    const int numShifts = inst.shiftsPerDay;
+    const int numHead = headNurses.size();
 
-    // Tạo model
-    HighsInt numVars = NUM_VARIABLES;
-    HighsInt numIntegers = NUM_VARIABLES;  // tất cả binary
+    HighsInt numVars = numNurses * numDays * numShifts;
+    HighsInt numIntegers = numNurses * numDays * numShifts;  // tất cả binary
 
     // Overtime variables: numNorNurses biến continuous >= 0
     int numNor = norNurses.size();
@@ -93,22 +476,22 @@ int main() {
 
     // Chi phí: x[i,d,s] + overtime cost
     vector<double> costs(numVarsTotal, 0.0);
-    for (int i = 0; i < NUM_NURSES; i++) {
-        double c = nurses[i].isHead ? COST_HEAD : COST_NORMAL;
-        for (int d = 0; d < NUM_DAYS; d++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
-                int idx = i * NUM_DAYS * NUM_SHIFTS + d * NUM_SHIFTS + s;
-                costs[idx] = c;
+    for (int i = 0; i < numNurses; i++) {
+        double c = nurses[i].isHead ? inst.costHead : inst.costNormal;
+        for (int d = 0; d < numDays; d++) {
+            for (int s = 0; s < numShifts; s++) {
+                int idx = i * numDays * numShifts + d * numShifts + s;
+                costs[idx] = c + (inst.isAvoided(i, d * numShifts + s) ? inst.costPreference : 0.0);
             }
         }
     }
 
-    // Overtime: COST_OVERTIME - COST_NORMAL = 200 (vì normal cost đã tính rồi)
-    // Theo logic Rust: cost_nor += COST_NORMAL * overtime[i]
-    //                 cost_overtime += (COST_OVERTIME - COST_NORMAL) * overtime[i]
-    //                 → overtime cost = (COST_OVERTIME - COST_NORMAL) = 200
+    // Overtime: inst.costOvertime - inst.costNormal = 200 (vì normal cost đã tính rồi)
+    // Theo logic Rust: cost_nor += inst.costNormal * overtime[i]
+    //                 cost_overtime += (inst.costOvertime - inst.costNormal) * overtime[i]
+    //                 → overtime cost = (inst.costOvertime - inst.costNormal) = 200
     for (int k = 0; k < numNor; k++) {
-        costs[numVars + k] = COST_OVERTIME - COST_NORMAL;  // 200
+        costs[numVars + k] = inst.costOvertime - inst.costNormal;  // 200
     }
 
     // Bounds: x[i,d,s] in [0,1], overtime[k] >= 0
@@ -118,6 +501,12 @@ int main() {
         colLower[numVars + k] = 0.0;   // overtime >= 0
         colUpper[numVars + k] = 1e30;
     }
+    // #11: ô unavailable cố định bằng 0 (bị bỏ hẳn khỏi model ở dropUnavailableColumns)
+    for (int i = 0; i < numNurses && !inst.unavailable.empty(); i++) {
+        for (int j = 0; j < numDays * numShifts; j++) {
+            if (inst.isUnavailable(i, j)) colUpper[i * numDays * numShifts + j] = 0.0;
+        }
+    }
 
     // Integrality: x[] = INTEGER, overtime[] = CONTINUOUS
     vector<HighsInt> integrality(numVarsTotal, kHighsVarTypeContinuous);
@@ -138,21 +527,22 @@ int main() {
     // #10: 5 ca liên tiếp <= 2     → 749 * 17 = 12733 ràng buộc
     // overtime: numNor ràng buộc
     // Tổng: 50502 ràng buộc
+    // Với --lazy-windows, #9 và #10 không sinh trước mà chỉ thêm khi bị vi phạm
 
     int numConstraints = 0;
     // Đếm để tính
     int cnt1 = 0, cnt2 = 0, cnt4 = 0, cnt5 = 0, cnt6 = 0;
     int cnt7 = 0, cnt8 = 0, cnt9 = 0, cnt10 = 0;
 
-    cnt1 = NUM_DAYS * NUM_SHIFTS;                      // 21
-    cnt2 = NUM_NURSES * 2;                            // 3966
+    cnt1 = numDays * numShifts;                      // 21
+    cnt2 = numNurses * 2;                            // 3966
     cnt4 = numNor;                                     // 749
     cnt5 = numNor;                                     // 749
-    cnt6 = NUM_HEAD_NUR * NUM_DAYS * 2;                // 17276
-    cnt7 = NUM_DAYS;                                   // 7
-    cnt8 = NUM_DAYS * NUM_SHIFTS;                      // 21
-    cnt9 = numNor * (NUM_DAYS * NUM_SHIFTS - 2);       // 749 * 19 = 14231
-    cnt10 = numNor * (NUM_DAYS * NUM_SHIFTS - 4);      // 749 * 17 = 12733
+    cnt6 = numHead * numDays * 2;                // 17276
+    cnt7 = numDays;                                   // 7
+    cnt8 = numDays * numShifts;                      // 21
+    cnt9 = lazyWindows ? 0 : numNor * (numDays * numShifts - 2);   // 749 * 19 = 14231
+    cnt10 = lazyWindows ? 0 : numNor * (numDays * numShifts - 4);  // 749 * 17 = 12733
 
     numConstraints = cnt1 + cnt2 + cnt4 + cnt5 + cnt6 + cnt7 + cnt8 + cnt9 + cnt10 + numNor;
 
@@ -173,7 +563,7 @@ int main() {
 
     // Helper: x_index
     auto xIdx = [&](int i, int d, int s) -> int {
-        return i * NUM_DAYS * NUM_SHIFTS + d * NUM_SHIFTS + s;
+        return i * numDays * numShifts + d * numShifts + s;
     };
 
     int constraintId = 0;
@@ -185,8 +575,8 @@ int main() {
     for (int k = 0; k < numNor; k++) {
         int i = norNurses[k];
         // Các hệ số cho x[i,d,s] = 1, overtime = -1
-        for (int d = 0; d < NUM_DAYS; d++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
+        for (int d = 0; d < numDays; d++) {
+            for (int s = 0; s < numShifts; s++) {
                 aIndex.push_back(constraintId);
                 aValue.push_back(1.0);
             }
@@ -201,21 +591,21 @@ int main() {
 
     // ---- CONSTRAINT #1: đủ số y tá mỗi ca ----
     constraintBase = constraintId;
-    for (int d = 0; d < NUM_DAYS; d++) {
-        for (int s = 0; s < NUM_SHIFTS; s++) {
-            for (int i = 0; i < NUM_NURSES; i++) {
+    for (int d = 0; d < numDays; d++) {
+        for (int s = 0; s < numShifts; s++) {
+            for (int i = 0; i < numNurses; i++) {
                 aIndex.push_back(constraintId);
                 aValue.push_back(1.0);
             }
-            rowLower[constraintId] = DEMAND[s];
+            rowLower[constraintId] = inst.demandFor(d * numShifts + s);
             constraintId++;
         }
     }
 
     // ---- CONSTRAINT #2,#3: min/max ca mỗi y tá ----
-    for (int i = 0; i < NUM_NURSES; i++) {
-        for (int d = 0; d < NUM_DAYS; d++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
+    for (int i = 0; i < numNurses; i++) {
+        for (int d = 0; d < numDays; d++) {
+            for (int s = 0; s < numShifts; s++) {
                 aIndex.push_back(constraintId);
                 aValue.push_back(1.0);
             }
@@ -225,9 +615,9 @@ int main() {
         constraintId++;
     }
     // Lại một lần nữa cho min
-    for (int i = 0; i < NUM_NURSES; i++) {
-        for (int d = 0; d < NUM_DAYS; d++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
+    for (int i = 0; i < numNurses; i++) {
+        for (int d = 0; d < numDays; d++) {
+            for (int s = 0; s < numShifts; s++) {
                 aIndex.push_back(constraintId);
                 aValue.push_back(1.0);
             }
@@ -239,31 +629,31 @@ int main() {
     // ---- CONSTRAINT #4: min afternoon cho y tá thường ----
     for (int k = 0; k < numNor; k++) {
         int i = norNurses[k];
-        for (int d = 0; d < NUM_DAYS; d++) {
+        for (int d = 0; d < numDays; d++) {
             int idx = xIdx(i, d, 1); // chiều
             aIndex.push_back(constraintId);
             aValue.push_back(1.0);
         }
-        rowLower[constraintId] = MIN_AFTERNOON;
+        rowLower[constraintId] = inst.minAfternoon;
         constraintId++;
     }
 
     // ---- CONSTRAINT #5: min night cho y tá thường ----
     for (int k = 0; k < numNor; k++) {
         int i = norNurses[k];
-        for (int d = 0; d < NUM_DAYS; d++) {
+        for (int d = 0; d < numDays; d++) {
             int idx = xIdx(i, d, 2); // tối
             aIndex.push_back(constraintId);
             aValue.push_back(1.0);
         }
-        rowLower[constraintId] = MIN_NIGHT;
+        rowLower[constraintId] = inst.minNight;
         constraintId++;
     }
 
     // ---- CONSTRAINT #6: y tá trưởng không làm chiều/tối ----
     for (int k = 0; k < (int)headNurses.size(); k++) {
         int i = headNurses[k];
-        for (int d = 0; d < NUM_DAYS; d++) {
+        for (int d = 0; d < numDays; d++) {
             // chiều = 0
             int idx1 = xIdx(i, d, 1);
             aIndex.push_back(constraintId);
@@ -280,21 +670,21 @@ int main() {
         }
     }
 
-    // ---- CONSTRAINT #7: >= MIN_HEAD y tá trưởng mỗi ca sáng ----
-    for (int d = 0; d < NUM_DAYS; d++) {
+    // ---- CONSTRAINT #7: >= minHeadPerMorning y tá trưởng mỗi ca sáng ----
+    for (int d = 0; d < numDays; d++) {
         for (int k = 0; k < (int)headNurses.size(); k++) {
             int i = headNurses[k];
             int idx = xIdx(i, d, 0); // sáng
             aIndex.push_back(constraintId);
             aValue.push_back(1.0);
         }
-        rowLower[constraintId] = MIN_HEAD;
+        rowLower[constraintId] = inst.minHeadPerMorning;
         constraintId++;
     }
 
     // ---- CONSTRAINT #8: >= 1 nữ mỗi ca ----
-    for (int d = 0; d < NUM_DAYS; d++) {
-        for (int s = 0; s < NUM_SHIFTS; s++) {
+    for (int d = 0; d < numDays; d++) {
+        for (int s = 0; s < numShifts; s++) {
             for (int k = 0; k < (int)femaleNurses.size(); k++) {
                 int i = femaleNurses[k];
                 int idx = xIdx(i, d, s);
@@ -307,14 +697,14 @@ int main() {
     }
 
     // ---- CONSTRAINT #9: ca j và j+2 không cùng làm ----
-    int totalShift = NUM_DAYS * NUM_SHIFTS;
-    for (int k = 0; k < numNor; k++) {
+    int totalShift = numDays * numShifts;
+    for (int k = 0; k < numNor && !lazyWindows; k++) {
         int i = norNurses[k];
         for (int j = 0; j < totalShift - 2; j++) {
-            int d1 = j / NUM_SHIFTS;
-            int s1 = j % NUM_SHIFTS;
-            int d2 = (j + 2) / NUM_SHIFTS;
-            int s2 = (j + 2) % NUM_SHIFTS;
+            int d1 = j / numShifts;
+            int s1 = j % numShifts;
+            int d2 = (j + 2) / numShifts;
+            int s2 = (j + 2) % numShifts;
 
             aIndex.push_back(constraintId);
             aValue.push_back(1.0);
@@ -329,12 +719,12 @@ int main() {
     }
 
     // ---- CONSTRAINT #10: 5 ca liên tiếp tối đa 2 ----
-    for (int k = 0; k < numNor; k++) {
+    for (int k = 0; k < numNor && !lazyWindows; k++) {
         int i = norNurses[k];
         for (int j = 0; j < totalShift - 4; j++) {
             for (int t = 0; t < 5; t++) {
-                int d = (j + t) / NUM_SHIFTS;
-                int s = (j + t) % NUM_SHIFTS;
+                int d = (j + t) / numShifts;
+                int s = (j + t) % numShifts;
                 int idx = xIdx(i, d, s);
                 aIndex.push_back(constraintId);
                 aValue.push_back(1.0);
@@ -362,77 +752,77 @@ int main() {
     // Đếm lại constraints để biết vị trí
     int c_overtime = 0;
     int c_demand = c_overtime + numNor;
-    int c_max = c_demand + NUM_DAYS * NUM_SHIFTS;
-    int c_min = c_max + NUM_NURSES;
-    int c_afternoon = c_min + NUM_NURSES;
+    int c_max = c_demand + numDays * numShifts;
+    int c_min = c_max + numNurses;
+    int c_afternoon = c_min + numNurses;
     int c_night = c_afternoon + numNor;
     int c_head_exclude = c_night + numNor;
-    int c_head_min = c_head_exclude + NUM_HEAD_NUR * NUM_DAYS * 2;
-    int c_female = c_head_min + NUM_DAYS;
-    int c_consec = c_female + NUM_DAYS * NUM_SHIFTS;
-    int c_window = c_consec + numNor * (totalShift - 2);
+    int c_head_min = c_head_exclude + numHead * numDays * 2;
+    int c_female = c_head_min + numDays;
+    int c_consec = c_female + numDays * numShifts;
+    int c_window = c_consec + cnt9;
 
     // Overtime constraints
     for (int k = 0; k < numNor; k++) {
-        rowCount[c_overtime + k] = NUM_DAYS * NUM_SHIFTS + 1;
+        rowCount[c_overtime + k] = numDays * numShifts + 1;
     }
 
     // Demand constraints
-    for (int d = 0; d < NUM_DAYS; d++) {
-        for (int s = 0; s < NUM_SHIFTS; s++) {
-            rowCount[c_demand + d * NUM_SHIFTS + s] = NUM_NURSES;
+    for (int d = 0; d < numDays; d++) {
+        for (int s = 0; s < numShifts; s++) {
+            rowCount[c_demand + d * numShifts + s] = numNurses;
         }
     }
 
     // Max shift constraints
-    for (int i = 0; i < NUM_NURSES; i++) {
-        rowCount[c_max + i] = NUM_DAYS * NUM_SHIFTS;
+    for (int i = 0; i < numNurses; i++) {
+        rowCount[c_max + i] = numDays * numShifts;
     }
 
     // Min shift constraints
-    for (int i = 0; i < NUM_NURSES; i++) {
-        rowCount[c_min + i] = NUM_DAYS * NUM_SHIFTS;
+    for (int i = 0; i < numNurses; i++) {
+        rowCount[c_min + i] = numDays * numShifts;
     }
 
     // Afternoon constraints
     for (int k = 0; k < numNor; k++) {
-        rowCount[c_afternoon + k] = NUM_DAYS;
+        rowCount[c_afternoon + k] = numDays;
     }
 
     // Night constraints
     for (int k = 0; k < numNor; k++) {
-        rowCount[c_night + k] = NUM_DAYS;
+        rowCount[c_night + k] = numDays;
     }
 
     // Head exclude constraints
     for (int k = 0; k < (int)headNurses.size(); k++) {
-        for (int d = 0; d < NUM_DAYS; d++) {
-            rowCount[c_head_exclude + k * NUM_DAYS + d] = 1;
-            rowCount[c_head_exclude + k * NUM_DAYS + d + (int)headNurses.size() * NUM_DAYS] = 1;
+        for (int d = 0; d < numDays; d++) {
+            rowCount[c_head_exclude + k * numDays + d] = 1;
+            rowCount[c_head_exclude + k * numDays + d + (int)headNurses.size() * numDays] = 1;
         }
     }
 
     // Head min constraints
-    for (int d = 0; d < NUM_DAYS; d++) {
+    for (int d = 0; d < numDays; d++) {
         rowCount[c_head_min + d] = headNurses.size();
     }
 
     // Female constraints
-    for (int d = 0; d < NUM_DAYS; d++) {
-        for (int s = 0; s < NUM_SHIFTS; s++) {
-            rowCount[c_female + d * NUM_SHIFTS + s] = femaleNurses.size();
+    for (int d = 0; d < numDays; d++) {
+        for (int s = 0; s < numShifts; s++) {
+            rowCount[c_female + d * numShifts + s] = femaleNurses.size();
         }
     }
 
     // Consecutive constraints
-    for (int k = 0; k < numNor; k++) {
+    for (int k = 0; k < numNor && !lazyWindows; k++) {
         for (int j = 0; j < totalShift - 2; j++) {
             rowCount[c_consec + k * (totalShift - 2) + j] = 2;
         }
     }
 
     // Window constraints
-    for (int k = 0; k < numNor; k++) {
+    for (int k = 0; k < numNor && !lazyWindows; k++) {
         for (int j = 0; j < totalShift - 4; j++) {
             rowCount[c_window + k * (totalShift - 4) + j] = 5;
         }
@@ -462,8 +852,8 @@ int main() {
     for (int k = 0; k < numNor; k++) {
         int i = norNurses[k];
         int row = c_overtime + k;
-        for (int d = 0; d < NUM_DAYS; d++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
+        for (int d = 0; d < numDays; d++) {
+            for (int s = 0; s < numShifts; s++) {
                 addCoeff(row, xIdx(i, d, s), 1.0);
             }
         }
@@ -471,30 +861,30 @@ int main() {
     }
 
     // Demand constraints
-    for (int d = 0; d < NUM_DAYS; d++) {
-        for (int s = 0; s < NUM_SHIFTS; s++) {
-            int row = c_demand + d * NUM_SHIFTS + s;
-            for (int i = 0; i < NUM_NURSES; i++) {
+    for (int d = 0; d < numDays; d++) {
+        for (int s = 0; s < numShifts; s++) {
+            int row = c_demand + d * numShifts + s;
+            for (int i = 0; i < numNurses; i++) {
                 addCoeff(row, xIdx(i, d, s), 1.0);
             }
         }
     }
 
     // Max shift constraints
-    for (int i = 0; i < NUM_NURSES; i++) {
+    for (int i = 0; i < numNurses; i++) {
         int row = c_max + i;
-        for (int d = 0; d < NUM_DAYS; d++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
+        for (int d = 0; d < numDays; d++) {
+            for (int s = 0; s < numShifts; s++) {
                 addCoeff(row, xIdx(i, d, s), 1.0);
             }
         }
     }
 
     // Min shift constraints
-    for (int i = 0; i < NUM_NURSES; i++) {
+    for (int i = 0; i < numNurses; i++) {
         int row = c_min + i;
-        for (int d = 0; d < NUM_DAYS; d++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
+        for (int d = 0; d < numDays; d++) {
+            for (int s = 0; s < numShifts; s++) {
                 addCoeff(row, xIdx(i, d, s), 1.0);
             }
         }
@@ -504,7 +894,7 @@ int main() {
     for (int k = 0; k < numNor; k++) {
         int i = norNurses[k];
         int row = c_afternoon + k;
-        for (int d = 0; d < NUM_DAYS; d++) {
+        for (int d = 0; d < numDays; d++) {
             addCoeff(row, xIdx(i, d, 1), 1.0);
         }
     }
@@ -513,7 +903,7 @@ int main() {
     for (int k = 0; k < numNor; k++) {
         int i = norNurses[k];
         int row = c_night + k;
-        for (int d = 0; d < NUM_DAYS; d++) {
+        for (int d = 0; d < numDays; d++) {
             addCoeff(row, xIdx(i, d, 2), 1.0);
         }
     }
@@ -521,14 +911,14 @@ int main() {
     // Head exclude constraints
     for (int k = 0; k < (int)headNurses.size(); k++) {
         int i = headNurses[k];
-        for (int d = 0; d < NUM_DAYS; d++) {
-            addCoeff(c_head_exclude + k * NUM_DAYS + d, xIdx(i, d, 1), 1.0);
-            addCoeff(c_head_exclude + (int)headNurses.size() * NUM_DAYS + k * NUM_DAYS + d, xIdx(i, d, 2), 1.0);
+        for (int d = 0; d < numDays; d++) {
+            addCoeff(c_head_exclude + k * numDays + d, xIdx(i, d, 1), 1.0);
+            addCoeff(c_head_exclude + (int)headNurses.size() * numDays + k * numDays + d, xIdx(i, d, 2), 1.0);
         }
     }
 
     // Head min constraints
-    for (int d = 0; d < NUM_DAYS; d++) {
+    for (int d = 0; d < numDays; d++) {
         int row = c_head_min + d;
         for (int k = 0; k < (int)headNurses.size(); k++) {
             int i = headNurses[k];
@@ -537,9 +927,9 @@ int main() {
     }
 
     // Female constraints
-    for (int d = 0; d < NUM_DAYS; d++) {
-        for (int s = 0; s < NUM_SHIFTS; s++) {
-            int row = c_female + d * NUM_SHIFTS + s;
+    for (int d = 0; d < numDays; d++) {
+        for (int s = 0; s < numShifts; s++) {
+            int row = c_female + d * numShifts + s;
             for (int fi : femaleNurses) {
                 addCoeff(row, xIdx(fi, d, s), 1.0);
             }
@@ -547,13 +937,13 @@ int main() {
     }
 
     // Consecutive constraints
-    for (int k = 0; k < numNor; k++) {
+    for (int k = 0; k < numNor && !lazyWindows; k++) {
         int i = norNurses[k];
         for (int j = 0; j < totalShift - 2; j++) {
-            int d1 = j / NUM_SHIFTS;
-            int s1 = j % NUM_SHIFTS;
-            int d2 = (j + 2) / NUM_SHIFTS;
-            int s2 = (j + 2) % NUM_SHIFTS;
+            int d1 = j / numShifts;
+            int s1 = j % numShifts;
+            int d2 = (j + 2) / numShifts;
+            int s2 = (j + 2) % numShifts;
             int row = c_consec + k * (totalShift - 2) + j;
             addCoeff(row, xIdx(i, d1, s1), 1.0);
             addCoeff(row, xIdx(i, d2, s2), 1.0);
@@ -561,22 +951,409 @@ int main() {
     }
 
     // Window constraints
-    for (int k = 0; k < numNor; k++) {
+    for (int k = 0; k < numNor && !lazyWindows; k++) {
         int i = norNurses[k];
         for (int j = 0; j < totalShift - 4; j++) {
             int row = c_window + k * (totalShift - 4) + j;
             for (int t = 0; t < 5; t++) {
-                int d = (j + t) / NUM_SHIFTS;
-                int s = (j + t) % NUM_SHIFTS;
+                int d = (j + t) / numShifts;
+                int s = (j + t) % numShifts;
                 addCoeff(row, xIdx(i, d, s), 1.0);
             }
         }
     }
 
+    MipModel m;
+    m.numCols = numVarsTotal;
+    m.numRows = numConstraints;
+    m.numNnz = numNnz;
+    m.costs = move(costs);
+    m.colLower = move(colLower);
+    m.colUpper = move(colUpper);
+    m.integrality = move(integrality);
+    m.rowLower = move(rowLower);
+    m.rowUpper = move(rowUpper);
+    m.aStart = move(aStartRow);
+    m.aIndex = move(aIndexRow);
+    m.aValue = move(aValueRow);
+    appendSkillRows(m, inst);
+    // Cut loop của --lazy-windows đánh chỉ số cột theo ô nên giữ các cột cố định bằng 0
+    if (!lazyWindows) dropUnavailableColumns(m, inst);
+    return m;
+}
+
+// ==================== MODEL CACHE ====================
+
+// NSPHasher (FNV-1a 64 bit) trên mọi tham số ảnh hưởng tới ma trận
+uint64_t instanceHash(const NSPInstance& inst, bool lazyWindows) {
+    NSPHasher h;
+    const char tag[] = "nsp_highs-model-v5";
+    h.mix(tag, sizeof(tag));
+    int dims[4] = {(int)inst.nurses.size(), inst.numDays, inst.shiftsPerDay, inst.minHeadPerMorning};
+    h.mix(dims, sizeof(dims));
+    double params[5] = {inst.costNormal, inst.costOvertime, inst.costHead,
+                        (double)inst.minAfternoon, (double)inst.minNight};
+    h.mix(params, sizeof(params));
+    h.mix(inst.demand.data(), inst.demand.size() * sizeof(int));
+    h.mix(inst.demandAt.data(), inst.demandAt.size() * sizeof(int));
+    h.mix(inst.unavailable.data(), inst.unavailable.size() * sizeof(uint64_t));
+    h.mix(inst.avoid.data(), inst.avoid.size() * sizeof(uint64_t));
+    h.mix(&inst.costPreference, sizeof(inst.costPreference));
+    int skillDims[2] = {inst.numWards, inst.numSkills};
+    h.mix(skillDims, sizeof(skillDims));
+    h.mix(inst.skillDemand.data(), inst.skillDemand.size() * sizeof(int));
+    for (const Nurse& n : inst.nurses) {
+        unsigned char flags = (n.isHead ? 1 : 0) | (n.isFemale ? 2 : 0);
+        h.mix(&flags, 1);
+        h.mix(&n.minShift, sizeof(n.minShift));
+        h.mix(&n.maxShift, sizeof(n.maxShift));
+        h.mix(&n.skills, sizeof(n.skills));
+    }
+    unsigned char lazy = lazyWindows ? 1 : 0;
+    h.mix(&lazy, 1);
+    return h.h;
+}
+
+// Highs_writeModel chọn định dạng theo đuôi file, nên file tạm là nsp_<hash>.tmp<pid>.mps (mỗi
+// process một file, hai lần chạy cùng lúc không ghi chồng lên nhau) rồi commitFileAtomic: crash
+// giữa chừng không để lại file cache cụt
+bool writeModelCache(void* highs, const string& cacheFile) {
+    string tmp = cacheFile.substr(0, cacheFile.size() - 4) + ".tmp";
+#if !defined(_WIN32)
+    tmp += to_string(getpid());
+#endif
+    tmp += ".mps";
+    if (Highs_writeModel(highs, tmp.c_str()) != kHighsStatusError && commitFileAtomic(tmp, cacheFile)) {
+        return true;
+    }
+    remove(tmp.c_str());
+    return false;
+}
+
+} // namespace nsp_highs
+
+// ==================== BACKEND ====================
+
+class HighsBackend : public NSPBackend {
+    NSPInstance inst;
+    void* highs = nullptr;
+    vector<int> headNurses, norNurses, femaleNurses;
+    HighsInt numCols = 0;
+    vector<HighsInt> cellCol;         // MipModel::cellCol của model đang giữ
+    NSPBackendResult result;
+    NSPBackendStats runStats;
+
+public:
+    ~HighsBackend() override {
+        if (highs) Highs_destroy(highs);
+    }
+
+    const char* name() const override { return "highs"; }
+
+    bool build(const NSPInstance& instance) override {
+        if (instance.shiftsPerDay != 3) return false;   // hàng #4/#5/#6 gắn với ca 1, 2
+        inst = instance;
+        headNurses.clear();
+        norNurses.clear();
+        femaleNurses.clear();
+        for (int i = 0; i < (int)inst.nurses.size(); i++) {
+            if (inst.nurses[i].isHead) headNurses.push_back(i);
+            else norNurses.push_back(i);
+            if (inst.nurses[i].isFemale) femaleNurses.push_back(i);
+        }
+
+        auto t0 = chrono::high_resolution_clock::now();
+        nsp_highs::MipModel model = nsp_highs::buildModel(inst, headNurses, norNurses,
+                                                          femaleNurses, false);
+        if (highs) Highs_destroy(highs);
+        highs = Highs_create();
+        Highs_setBoolOptionValue(highs, "output_flag", 0);
+        if (model.passTo(highs) == kHighsStatusError) return false;
+        numCols = model.numCols;
+        cellCol = move(model.cellCol);
+
+        runStats = NSPBackendStats();
+        runStats.buildMs = chrono::duration<double, milli>(
+            chrono::high_resolution_clock::now() - t0).count();
+        runStats.numVariables = model.numCols;
+        runStats.numConstraints = model.numRows;
+        return true;
+    }
+
+    bool solve(double timeLimitSec) override {
+        if (timeLimitSec > 0) Highs_setDoubleOptionValue(highs, "time_limit", timeLimitSec);
+        int totalShift = inst.totalShifts();
+        vector<double> colValue(numCols), rowValue;
+        nsp_highs::LazyStats lazy;
+
+        auto t0 = chrono::high_resolution_clock::now();
+        nsp_highs::BackendProgress callbackData = {&progress, t0};
+        if (progress) {
+            Highs_setCallback(highs, nsp_highs::backendProgressCallback, &callbackData);
+            Highs_startCallback(highs, kHighsCallbackMipImprovingSolution);
+            Highs_startCallback(highs, kHighsCallbackMipInterrupt);
+        }
+        HighsInt runStatus = nsp_highs::runHighs(highs, false, norNurses, totalShift,
+                                                 colValue, rowValue, lazy);
+        runStats.solveMs = chrono::duration<double, milli>(
+            chrono::high_resolution_clock::now() - t0).count();
+        if (progress) {
+            Highs_stopCallback(highs, kHighsCallbackMipImprovingSolution);
+            Highs_stopCallback(highs, kHighsCallbackMipInterrupt);
+        }
+
+        HighsInt modelStatus = Highs_getModelStatus(highs);
+        HighsInt primalStatus = kHighsSolutionStatusNone;
+        Highs_getIntInfoValue(highs, "primal_solution_status", &primalStatus);
+        bool solvedOk = runStatus != kHighsStatusError;
+        result.optimal = solvedOk && modelStatus == kHighsModelStatusOptimal;
+        result.feasible = result.optimal ||
+                          (solvedOk && primalStatus == kHighsSolutionStatusFeasible);
+        result.cost = result.feasible ? Highs_getObjectiveValue(highs) : 0.0;
+        runStats.status = solvedOk ? nsp_highs::modelStatusName(modelStatus) : "ERROR";
+
+        // Cột x[i,d,s] đứng đầu theo đúng thứ tự ô lịch chung (i * totalShift + j),
+        // trừ khi các ô unavailable đã bị bỏ (cellCol)
+        size_t numCells = inst.nurses.size() * (size_t)totalShift;
+        result.schedule.assign(numCells, 0);
+        for (size_t k = 0; k < numCells && result.feasible; k++) {
+            HighsInt col = cellCol.empty() ? (HighsInt)k : cellCol[k];
+            result.schedule[k] = col >= 0 && colValue[col] > 0.5;
+        }
+        return solvedOk;
+    }
+
+    const NSPBackendResult& solution() const override { return result; }
+    const NSPBackendStats& stats() const override { return runStats; }
+};
+
+unique_ptr<NSPBackend> makeHighsBackend() {
+    return unique_ptr<NSPBackend>(new HighsBackend());
+}
+
+// ==================== MAIN ====================
+
+#ifndef NSP_BACKEND_ONLY
+int main(int argc, char** argv) {
+    using namespace nsp_highs;
+    bool lazyWindows = false;
+    int sweepShift = -1;
+    vector<double> sweepValues;
+    string progressCsv;
+    SolverOptions options;
+    vector<int> benchThreads;
+    int benchRepeats = 3;
+    string modelCacheDir;
+    string writeModelFile;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--lazy-windows") {
+            lazyWindows = true;
+        } else if (arg == "--sweep-demand" && a + 1 < argc) {
+            if (!parseSweep(argv[++a], sweepShift, sweepValues)) {
+                cerr << "Bad --sweep-demand spec: " << argv[a] << endl;
+                return 1;
+            }
+        } else if (arg == "--progress-csv" && a + 1 < argc) {
+            progressCsv = argv[++a];
+        } else if (arg == "--threads" && a + 1 < argc) {
+            options.threads = atoi(argv[++a]);
+        } else if (arg == "--time-limit" && a + 1 < argc) {
+            options.timeLimit = atof(argv[++a]);
+        } else if (arg == "--mip-rel-gap" && a + 1 < argc) {
+            options.mipRelGap = atof(argv[++a]);
+        } else if (arg == "--mip-abs-gap" && a + 1 < argc) {
+            options.mipAbsGap = atof(argv[++a]);
+        } else if (arg == "--presolve" && a + 1 < argc) {
+            options.presolve = argv[++a];
+        } else if (arg == "--seed" && a + 1 < argc) {
+            options.randomSeed = atoi(argv[++a]);
+        } else if (arg == "--parallel" && a + 1 < argc) {
+            options.parallel = argv[++a];
+        } else if (arg == "--bench-threads" && a + 1 < argc) {
+            benchThreads = parseIntList(argv[++a]);
+        } else if (arg == "--bench-repeats" && a + 1 < argc) {
+            benchRepeats = max(1, atoi(argv[++a]));
+        } else if (arg == "--model-cache" && a + 1 < argc) {
+            modelCacheDir = argv[++a];
+        } else if (arg == "--write-model" && a + 1 < argc) {
+            writeModelFile = argv[++a];
+        } else {
+            if (arg != "--help" && arg != "-h") cerr << "Unknown option: " << arg << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    cout << R"(
+╔════════════════════════════════════════════════════════════════╗
+║     NSP - C++ gọi HiGHS solver (C API)                     ║
+║     So sánh với Rust + good_lp + highs-sys                 ║
+╚════════════════════════════════════════════════════════════════╝
+)" << endl;
+
+    NSPInstance inst = makeReferenceInstance();
+    const vector<Nurse>& nurses = inst.nurses;
+    const int numNurses = nurses.size();
+    const int numDays = inst.numDays;
+    const int numShifts = inst.shiftsPerDay;
+
+    cout << "Data: " << numNurses << " nurses, " << numDays << " days, "
+         << numShifts << " shifts" << endl;
+    cout << "Variables: " << numNurses * numDays * numShifts << " binary" << endl;
+    cout << "Mode: " << (lazyWindows ? "lazy #9/#10 (cut loop)" : "eager") << endl;
+
+    // ========== XÂY DỰNG DỮ LIỆU ==========
+
+    vector<int> headNurses, norNurses, femaleNurses;
+
+    for (int i = 0; i < numNurses; i++) {
+        if (nurses[i].isHead) headNurses.push_back(i);
+        else norNurses.push_back(i);
+        if (nurses[i].isFemale) femaleNurses.push_back(i);
+    }
+
+    // ========== XÂY DỰNG MODEL CHO HIGHS ==========
+
+    auto buildStart = chrono::high_resolution_clock::now();
+
+    HighsInt numVars = numNurses * numDays * numShifts;
+    int numNor = norNurses.size();
+    int numVarsTotal = numVars + numNor;
+    int totalShift = numDays * numShifts;
+    int c_demand = numNor;  // hàng overtime đứng đầu, sau đó là hàng nhu cầu (xem buildModel)
+
+    auto xIdx = [&](int i, int d, int s) -> int {
+        return i * numDays * numShifts + d * numShifts + s;
+    };
+
+    // Cache: cùng tham số instance → cùng hash → đọc file thay vì dựng lại ma trận
+    string cacheFile;
+    bool cacheHit = false;
+    if (!modelCacheDir.empty()) {
+        char name[64];
+        snprintf(name, sizeof(name), "nsp_%016llx.mps",
+                 (unsigned long long)instanceHash(inst, lazyWindows));
+        cacheFile = modelCacheDir + "/" + name;
+        cacheHit = ifstream(cacheFile).good();
+        cout << "Model cache: " << cacheFile << (cacheHit ? " (hit)" : " (miss)") << endl;
+    }
+
+    MipModel model;
+    if (!cacheHit) {
+        model = buildModel(inst, headNurses, norNurses, femaleNurses, lazyWindows);
+    }
+
+    // Nạp model vào một Highs instance: từ file cache hoặc từ ma trận vừa dựng
+    auto loadModel = [&](void* h) -> bool {
+        HighsInt status = cacheHit ? Highs_readModel(h, cacheFile.c_str()) : model.passTo(h);
+        return status != kHighsStatusError && Highs_getNumCol(h) == numVarsTotal;
+    };
+
+    // Dùng Highs instance (thay vì Highs_mipCall) để có thể thêm hàng và giải lại
+    void* highs = Highs_create();
+    Highs_setBoolOptionValue(highs, "output_flag", 0);
+    applyOptions(highs, options);
+    bool loaded = loadModel(highs);
+    if (!loaded && cacheHit) {
+        // File cache hỏng (cụt, sai số cột): coi như miss, dựng lại và ghi đè cache
+        cerr << "Cannot load model cache " << cacheFile << ", rebuilding" << endl;
+        cacheHit = false;
+        model = buildModel(inst, headNurses, norNurses, femaleNurses, lazyWindows);
+        loaded = loadModel(highs);
+    }
+    if (!loaded) {
+        cerr << "Cannot load model" << endl;
+        Highs_destroy(highs);
+        return 1;
+    }
+
     auto buildEnd = chrono::high_resolution_clock::now();
     double buildMs = chrono::duration<double, milli>(buildEnd - buildStart).count();
     cout << "BUILD_MS=" << fixed << setprecision(2) << buildMs << endl;
 
+    // Ghi model ra file: vào cache (nếu miss) và/hoặc file do người dùng chỉ định
+    if (!cacheFile.empty() && !cacheHit) {
+        if (!writeModelCache(highs, cacheFile)) {
+            cerr << "Cannot write model cache " << cacheFile << endl;
+        }
+    }
+    if (!writeModelFile.empty()) {
+        if (Highs_writeModel(highs, writeModelFile.c_str()) == kHighsStatusError) {
+            cerr << "Cannot write model " << writeModelFile << endl;
+        } else {
+            cout << "Model written: " << writeModelFile << endl;
+        }
+    }
+
+    // ========== BENCHMARK THEO SỐ LUỒNG ==========
+
+    if (!benchThreads.empty()) {
+        cout << "\n--- THREAD SCALING (" << benchRepeats << " runs each, seed = base + run) ---" << endl;
+        vector<double> benchCol(numVarsTotal);
+        vector<double> benchRow;
+        double baseMean = 0.0;
+
+        cout << setw(8) << "THREADS" << setw(12) << "MEAN_MS" << setw(12) << "STDDEV_MS"
+             << setw(8) << "CV%" << setw(12) << "MIN_MS" << setw(12) << "MAX_MS"
+             << setw(10) << "SPEEDUP" << setw(14) << "COST" << "  STATUS" << endl;
+
+        for (int threads : benchThreads) {
+            vector<BenchRun> runs;
+            for (int r = 0; r < benchRepeats; r++) {
+                // HiGHS dùng scheduler toàn cục: phải reset để số luồng mới có hiệu lực
+                Highs_resetGlobalScheduler(1);
+
+                SolverOptions runOpt = options;
+                runOpt.threads = threads;
+                runOpt.randomSeed = max(0, options.randomSeed) + r;
+
+                void* bh = Highs_create();
+                Highs_setBoolOptionValue(bh, "output_flag", 0);
+                applyOptions(bh, runOpt);
+                if (!loadModel(bh)) {
+                    cerr << "Cannot load model" << endl;
+                    Highs_destroy(bh);
+                    Highs_destroy(highs);
+                    return 1;
+                }
+
+                auto t0 = chrono::high_resolution_clock::now();
+                LazyStats benchLazy;
+                runHighs(bh, lazyWindows, norNurses, totalShift, benchCol, benchRow, benchLazy);
+                double ms = chrono::duration<double, milli>(
+                    chrono::high_resolution_clock::now() - t0).count();
+                runs.push_back({ms, Highs_getObjectiveValue(bh), Highs_getModelStatus(bh)});
+                Highs_destroy(bh);
+            }
+
+            double mean = 0.0, minMs = runs[0].ms, maxMs = runs[0].ms;
+            for (const BenchRun& b : runs) {
+                mean += b.ms;
+                minMs = min(minMs, b.ms);
+                maxMs = max(maxMs, b.ms);
+            }
+            mean /= runs.size();
+            double var = 0.0;
+            for (const BenchRun& b : runs) var += (b.ms - mean) * (b.ms - mean);
+            double stddev = runs.size() > 1 ? sqrt(var / (runs.size() - 1)) : 0.0;
+            if (baseMean == 0.0) baseMean = mean;
+
+            bool allOptimal = true;
+            for (const BenchRun& b : runs) allOptimal = allOptimal && b.modelStatus == kHighsModelStatusOptimal;
+
+            cout << setw(8) << threads << fixed << setprecision(2)
+                 << setw(12) << mean << setw(12) << stddev
+                 << setw(8) << setprecision(1) << (mean > 0 ? 100.0 * stddev / mean : 0.0)
+                 << setw(12) << setprecision(2) << minMs << setw(12) << maxMs
+                 << setw(10) << (baseMean / mean)
+                 << setw(14) << setprecision(0) << runs.back().cost
+                 << "  " << (allOptimal ? "OPTIMAL" : modelStatusName(runs.back().modelStatus)) << endl;
+        }
+        cout << "(SPEEDUP so với dòng đầu tiên)" << endl;
+        return 0;
+    }
+
     // ========== GỌI HIGHS ==========
 
     auto solveStart = chrono::high_resolution_clock::now();
@@ -585,32 +1362,46 @@ int main() {
     HighsInt modelStatus;
     double objectiveValue = 0.0;
     HighsInt numCols = numVarsTotal;
-    HighsInt numRows = numConstraints;
+    HighsInt numRows = Highs_getNumRow(highs);
 
     vector<double> colValue(numCols);
     vector<double> rowValue(numRows);
 
-    // Highs_mipCall trả về status, không phải objective
-    // objective = sum(costs[i] * colValue[i])
-    runStatus = Highs_mipCall(
-        numCols, numRows, numNnz,
-        kHighsMatrixFormatRowwise,
-        kHighsObjSenseMinimize,
-        0.0,
-        costs.data(),
-        colLower.data(),
-        colUpper.data(),
-        rowLower.data(),
-        rowUpper.data(),
-        aStartRow.data(),
-        aIndexRow.data(),
-        aValueRow.data(),
-        integrality.data(),
-        colValue.data(),
-        rowValue.data(),
-        &modelStatus
-    );
+    ProgressLog progress;
+    progress.start = solveStart;
+    Highs_setCallback(highs, progressCallback, &progress);
+    Highs_startCallback(highs, kHighsCallbackMipImprovingSolution);
+    Highs_startCallback(highs, kHighsCallbackMipInterrupt);
+
+    LazyStats lazy;
+    runStatus = runHighs(highs, lazyWindows, norNurses, totalShift, colValue, rowValue,
+                         lazy, &progress);
+    modelStatus = Highs_getModelStatus(highs);
+
+    Highs_stopCallback(highs, kHighsCallbackMipImprovingSolution);
+    Highs_stopCallback(highs, kHighsCallbackMipInterrupt);
+
+    // Phân loại kết quả: tối ưu / khả thi nhưng dừng sớm / vô nghiệm / lỗi
+    HighsInt primalStatus = kHighsSolutionStatusNone;
+    double mipGap = 0.0, dualBound = 0.0;
+    int64_t mipNodes = 0;
+    Highs_getIntInfoValue(highs, "primal_solution_status", &primalStatus);
+    Highs_getDoubleInfoValue(highs, "mip_gap", &mipGap);
+    Highs_getDoubleInfoValue(highs, "mip_dual_bound", &dualBound);
+    Highs_getInt64InfoValue(highs, "mip_node_count", &mipNodes);
+
+    bool solvedOk = runStatus != kHighsStatusError;
+    bool optimal = solvedOk && modelStatus == kHighsModelStatusOptimal;
+    bool feasible = !optimal && solvedOk && primalStatus == kHighsSolutionStatusFeasible;
+    if (feasible && lazyWindows) {
+        // Vòng lazy dừng giữa chừng: lời giải có thể còn vi phạm #9/#10 chưa được thêm
+        int numPair = 0, numWindow = 0;
+        feasible = findViolatedWindows(colValue, norNurses, totalShift, numPair, numWindow).size() == 0;
+    }
+    bool infeasible = solvedOk && modelStatus == kHighsModelStatusInfeasible;
 
+    progress.events.push_back({progress.elapsedMs(), "final", progress.round,
+                               Highs_getObjectiveValue(highs), dualBound, mipGap, mipNodes});
     // Tính objective value từ kết quả
     objectiveValue = 0.0;
     double normalCost = 0.0;
@@ -619,30 +1410,28 @@ int main() {
     double totalNorShifts = 0.0;
     double totalHeadShifts = 0.0;
     double totalOT = 0.0;
-    for (int i = 0; i < numCols; i++) {
-        objectiveValue += costs[i] * colValue[i];
-    }
     // Tính chi tiết
-    for (int i = 0; i < NUM_NURSES; i++) {
+    for (int i = 0; i < numNurses; i++) {
         double nurseShifts = 0;
-        for (int d = 0; d < NUM_DAYS; d++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
+        for (int d = 0; d < numDays; d++) {
+            for (int s = 0; s < numShifts; s++) {
                 nurseShifts += colValue[xIdx(i, d, s)];
             }
         }
         if (nurses[i].isHead) {
-            headCost += nurseShifts * COST_HEAD;
+            headCost += nurseShifts * inst.costHead;
             totalHeadShifts += nurseShifts;
         } else {
-            normalCost += nurseShifts * COST_NORMAL;
+            normalCost += nurseShifts * inst.costNormal;
             totalNorShifts += nurseShifts;
         }
     }
     for (int k = 0; k < numNor; k++) {
         double ot = colValue[numVars + k];
-        overtimeCost += ot * (COST_OVERTIME - COST_NORMAL);
+        overtimeCost += ot * (inst.costOvertime - inst.costNormal);
         totalOT += ot;
     }
+    objectiveValue = headCost + normalCost + overtimeCost;
     cout << "DEBUG: headCost=" << fixed << setprecision(0) << headCost
          << " normalCost=" << normalCost
          << " overtimeCost=" << overtimeCost
@@ -657,17 +1446,82 @@ int main() {
     // ========== KẾT QUẢ ==========
 
     cout << "\n--- RESULTS ---" << endl;
-    if (runStatus == kHighsStatusOk && modelStatus == kHighsModelStatusOptimal) {
-        cout << "STATUS=SUCCESS" << endl;
+    if (optimal || feasible) {
+        if (optimal) {
+            cout << "STATUS=SUCCESS" << endl;
+        } else {
+            cout << "STATUS=FEASIBLE" << endl;
+            cout << "ModelStatus=" << modelStatusName(modelStatus) << endl;
+        }
         cout << "BUILD_MS=" << fixed << setprecision(2) << buildMs << endl;
         cout << "SOLVE_MS=" << fixed << setprecision(2) << solveMs << endl;
         cout << "TOTAL_MS=" << fixed << setprecision(2) << totalMs << endl;
         cout << "TOTAL_COST=" << fixed << setprecision(0) << objectiveValue << endl;
+        cout << "BEST_BOUND=" << fixed << setprecision(0) << dualBound << endl;
+        cout << "MIP_GAP=" << fixed << setprecision(4) << 100.0 * mipGap << "%" << endl;
+        if (lazyWindows) {
+            cout << "LAZY_ROUNDS=" << lazy.rounds << endl;
+            cout << "LAZY_ROWS=" << (lazy.pairRows + lazy.windowRows)
+                 << " (#9=" << lazy.pairRows << ", #10=" << lazy.windowRows
+                 << ", eager=" << numNor * (totalShift - 2) + numNor * (totalShift - 4) << ")" << endl;
+        }
+    } else if (infeasible) {
+        cout << "STATUS=INFEASIBLE" << endl;
+        cout << "SOLVE_MS=" << fixed << setprecision(2) << solveMs << endl;
     } else {
         cout << "STATUS=FAILED" << endl;
         cout << "RunStatus=" << runStatus << endl;
-        cout << "ModelStatus=" << modelStatus << endl;
+        cout << "ModelStatus=" << modelStatus << " (" << modelStatusName(modelStatus) << ")" << endl;
+    }
+    cout << "NODES=" << mipNodes << endl;
+    cout << "INCUMBENTS=" << progress.numIncumbents << endl;
+    if (progress.firstIncumbentMs >= 0) {
+        cout << "FIRST_INCUMBENT_MS=" << fixed << setprecision(2) << progress.firstIncumbentMs << endl;
+    }
+
+    if (!progressCsv.empty()) {
+        if (progress.writeCsv(progressCsv)) {
+            cout << "Progress timeline: " << progressCsv << " (" << progress.events.size()
+                 << " events)" << endl;
+        } else {
+            cerr << "Cannot write " << progressCsv << endl;
+        }
+    }
+
+    // ========== SWEEP: chỉ đổi cận hàng nhu cầu, warm start từ lời giải trước ==========
+
+    if (sweepShift >= 0) {
+        cout << "\n--- SWEEP DEMAND (shift " << sweepShift << ", cold solve "
+             << fixed << setprecision(2) << solveMs << " ms) ---" << endl;
+        cout << setw(10) << "DEMAND" << setw(12) << "STATUS"
+             << setw(16) << "TOTAL_COST" << setw(12) << "SOLVE_MS" << endl;
+
+        for (double demand : sweepValues) {
+            for (int d = 0; d < numDays; d++) {
+                Highs_changeRowBounds(highs, c_demand + d * numShifts + sweepShift, demand, 1e30);
+            }
+            Highs_setSolution(highs, colValue.data(), nullptr, nullptr, nullptr);
+
+            auto t0 = chrono::high_resolution_clock::now();
+            LazyStats sweepLazy;
+            HighsInt st = runHighs(highs, lazyWindows, norNurses, totalShift,
+                                   colValue, rowValue, sweepLazy);
+            double ms = chrono::duration<double, milli>(
+                chrono::high_resolution_clock::now() - t0).count();
+            HighsInt sweepStatus = Highs_getModelStatus(highs);
+
+            cout << setw(10) << setprecision(0) << demand
+                 << setw(12) << (st == kHighsStatusError ? "ERROR" : modelStatusName(sweepStatus));
+            if (sweepStatus == kHighsModelStatusOptimal) {
+                cout << setw(16) << Highs_getObjectiveValue(highs);
+            } else {
+                cout << setw(16) << "-";
+            }
+            cout << setw(12) << setprecision(2) << ms << endl;
+        }
     }
 
+    Highs_destroy(highs);
     return 0;
 }
+#endif
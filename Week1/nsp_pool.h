@@ -0,0 +1,256 @@
+/**
+ * Nurse Scheduling Problem (NSP) - Pool top-K lịch khác nhau
+ *
+ * Giữ tối đa K lịch tốt nhất theo (vi phạm, chi phí) sao cho mọi cặp lịch trong pool cách nhau
+ * ít nhất minDistance ô (khoảng cách Hamming trên lịch bit-packed, popcount của XOR).
+ * Lịch mới gần (< minDistance) một lịch trong pool thì chỉ vào được khi tốt hơn mọi lịch gần
+ * nó, và thay chúng: một chuỗi lời giải cải thiện dần từng bước nhỏ chỉ giữ lại bản cuối,
+ * các lịch khác nhau đến từ các lần chạy lại / các worker khác nhau.
+ *
+ * Index (pigeonhole): N·T ô thật của lịch (không tính bit thừa cuối hàng, luôn bằng 0 nên khối
+ * chỉ gồm bit thừa trùng hash ở mọi lịch) chia thành m = min(minDistance, N·T) khối. Hai lịch
+ * cách nhau < minDistance bit thì có ít nhất một khối giống hệt, nên chỉ cần so khoảng cách đầy đủ với
+ * các lịch trùng hash ở ít nhất một khối, không phải với cả K lịch. admits() loại trước,
+ * trong O(1), các lịch không thể vào pool (pool đầy và không tốt hơn lịch tệ nhất), nên
+ * bên gọi chỉ đóng gói lịch khi cần.
+ *
+ * Bố cục lịch giống NSPB (--export-bin, libnsp): hàng y tá i gồm wordsPerRow uint64 từ word
+ * i * wordsPerRow, bit (j % 64) của word j / 64 = ca j; bit thừa cuối hàng bằng 0.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct NSPPoolEntry {
+    int violations = 0;
+    double cost = 0;
+    uint64_t order = 0;                 // thứ tự được nhận, phân định khi (vi phạm, chi phí) bằng nhau
+    std::vector<uint64_t> words;
+    std::vector<uint64_t> keys;         // hash từng khối, dùng để gỡ khỏi index
+};
+
+class NSPSolutionPool {
+public:
+    NSPSolutionPool() = default;
+    NSPSolutionPool(int capacity, int minDistance, int numNurses, int totalShifts)
+        : capacity_(std::max(0, capacity)), minDistance_(std::max(1, minDistance)),
+          numNurses_(numNurses), totalShifts_(totalShifts), wordsPerRow_((totalShifts + 63) / 64) {
+        long totalCells = (long)numNurses * totalShifts;
+        numBlocks_ = (int)std::max(1L, std::min<long>(minDistance_, totalCells));
+    }
+
+    int capacity() const { return capacity_; }
+    int minDistance() const { return minDistance_; }
+    int numNurses() const { return numNurses_; }
+    int totalShifts() const { return totalShifts_; }
+    int wordsPerRow() const { return wordsPerRow_; }
+    size_t numWords() const { return (size_t)numNurses_ * wordsPerRow_; }
+    size_t size() const { return entries_.size(); }
+    long offered() const { return offered_; }
+    long accepted() const { return accepted_; }
+    long distanceChecks() const { return distanceChecks_; }
+
+    // Lịch (vi phạm, chi phí) còn có thể vào pool không; false thì không cần đóng gói lịch
+    bool admits(int violations, double cost) const {
+        if (capacity_ == 0) return false;
+        if ((int)entries_.size() < capacity_) return true;
+        const NSPPoolEntry& w = entries_[worst()];
+        return violations < w.violations || (violations == w.violations && cost < w.cost);
+    }
+
+    // words: numWords() uint64 theo bố cục NSPB. true nếu lịch được nhận vào pool
+    bool offer(const uint64_t* words, int violations, double cost) {
+        offered_++;
+        if (!admits(violations, cost)) return false;
+        std::vector<uint64_t> keys = blockKeys(words);
+
+        // Các lịch trong pool cách lịch mới < minDistance: ứng viên từ index, kiểm lại bằng popcount
+        std::vector<int> conflicts;
+        stamp_++;
+        for (uint64_t key : keys) {
+            auto range = index_.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                int e = it->second;
+                if (seen_[e] == stamp_) continue;
+                seen_[e] = stamp_;
+                distanceChecks_++;
+                if (distance(entries_[e].words.data(), words) >= minDistance_) continue;
+                const NSPPoolEntry& c = entries_[e];
+                if (!(violations < c.violations || (violations == c.violations && cost < c.cost))) {
+                    return false;   // có lịch gần đó không tệ hơn
+                }
+                conflicts.push_back(e);
+            }
+        }
+
+        // Gỡ từ chỉ số lớn xuống để chỉ số còn lại không đổi
+        std::sort(conflicts.rbegin(), conflicts.rend());
+        for (int e : conflicts) remove(e);
+        NSPPoolEntry entry;
+        entry.violations = violations;
+        entry.cost = cost;
+        entry.order = accepted_++;
+        entry.words.assign(words, words + numWords());
+        entry.keys = std::move(keys);
+        int slot = entries_.size();
+        for (uint64_t key : entry.keys) index_.emplace(key, slot);
+        entries_.push_back(std::move(entry));
+        seen_.push_back(0);
+        if ((int)entries_.size() > capacity_) remove(worst());
+        return true;
+    }
+
+    // Đóng gói lịch dạng ô 0/1 (cells[i * totalShifts + j]) rồi offer; bỏ qua nếu !admits
+    bool offerCells(const std::vector<char>& cells, int violations, double cost) {
+        if (!admits(violations, cost)) {
+            offered_++;
+            return false;
+        }
+        packed_.assign(numWords(), 0);
+        for (int i = 0; i < numNurses_; i++) {
+            const char* src = cells.data() + (size_t)i * totalShifts_;
+            uint64_t* row = packed_.data() + (size_t)i * wordsPerRow_;
+            for (int j = 0; j < totalShifts_; j++) row[j / 64] |= uint64_t(src[j] != 0) << (j % 64);
+        }
+        return offer(packed_.data(), violations, cost);
+    }
+
+    int distance(const uint64_t* a, const uint64_t* b) const {
+        int d = 0;
+        for (size_t w = 0; w < numWords(); w++) d += __builtin_popcountll(a[w] ^ b[w]);
+        return d;
+    }
+
+    // Các lịch theo thứ tự tốt nhất trước
+    std::vector<const NSPPoolEntry*> ranked() const {
+        std::vector<const NSPPoolEntry*> out;
+        for (const NSPPoolEntry& e : entries_) out.push_back(&e);
+        std::sort(out.begin(), out.end(), [](const NSPPoolEntry* a, const NSPPoolEntry* b) {
+            return better(*a, *b);
+        });
+        return out;
+    }
+
+    // Khoảng cách nhỏ nhất giữa hai lịch trong pool (-1 nếu pool < 2 lịch)
+    int minPairDistance() const {
+        int best = -1;
+        for (size_t a = 0; a < entries_.size(); a++) {
+            for (size_t b = a + 1; b < entries_.size(); b++) {
+                int d = distance(entries_[a].words.data(), entries_[b].words.data());
+                if (best < 0 || d < best) best = d;
+            }
+        }
+        return best;
+    }
+
+    // Ghi từng lịch ra PREFIX.K.bin (K = 1 là tốt nhất) theo định dạng NSPB của --export-bin,
+    // đọc lại được bằng nsp_validate --schedule. Trả về số file đã ghi, -1 nếu lỗi
+    int exportBinary(const std::string& prefix, int shiftsPerDay) const {
+        std::vector<const NSPPoolEntry*> list = ranked();
+        uint32_t header[6] = {0, 1, (uint32_t)numNurses_, (uint32_t)totalShifts_,
+                              (uint32_t)shiftsPerDay, (uint32_t)wordsPerRow_};
+        memcpy(header, "NSPB", 4);
+        for (size_t k = 0; k < list.size(); k++) {
+            std::string path = prefix + "." + std::to_string(k + 1) + ".bin";
+            FILE* f = fopen(path.c_str(), "wb");
+            if (!f) return -1;
+            bool ok = fwrite(header, sizeof(header), 1, f) == 1 &&
+                      fwrite(&list[k]->cost, sizeof(double), 1, f) == 1 &&
+                      fwrite(list[k]->words.data(), sizeof(uint64_t), numWords(), f) == numWords();
+            if (fclose(f) != 0 || !ok) return -1;
+        }
+        return list.size();
+    }
+
+private:
+    int capacity_ = 0;
+    int minDistance_ = 1;
+    int numNurses_ = 0;
+    int totalShifts_ = 0;
+    int wordsPerRow_ = 0;
+    int numBlocks_ = 1;
+    std::vector<NSPPoolEntry> entries_;
+    std::unordered_multimap<uint64_t, int> index_;   // (khối, hash bit của khối) -> chỉ số lịch
+    std::vector<uint64_t> seen_;                      // seen_[e] == stamp_: đã xét trong lần offer này
+    uint64_t stamp_ = 0;
+    std::vector<uint64_t> packed_;
+    long offered_ = 0, accepted_ = 0, distanceChecks_ = 0;
+
+    static bool better(const NSPPoolEntry& a, const NSPPoolEntry& b) {
+        if (a.violations != b.violations) return a.violations < b.violations;
+        if (a.cost != b.cost) return a.cost < b.cost;
+        return a.order < b.order;
+    }
+
+    int worst() const {
+        int w = 0;
+        for (int e = 1; e < (int)entries_.size(); e++) {
+            if (better(entries_[w], entries_[e])) w = e;
+        }
+        return w;
+    }
+
+    static uint64_t mix(uint64_t h, uint64_t v) {
+        h ^= v + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        return h * 0xBF58476D1CE4E5B9ULL;
+    }
+
+    // Hash của khối b = các ô [b * N·T / m, (b + 1) * N·T / m), ô c là bit c % T của hàng c / T;
+    // trộn cả chỉ số khối
+    std::vector<uint64_t> blockKeys(const uint64_t* words) const {
+        long totalCells = (long)numNurses_ * totalShifts_;
+        std::vector<uint64_t> keys(numBlocks_);
+        for (int b = 0; b < numBlocks_; b++) {
+            long lo = totalCells * b / numBlocks_, hi = totalCells * (b + 1) / numBlocks_;
+            uint64_t h = mix(0x243F6A8885A308D3ULL, b);
+            for (long c = lo; c < hi;) {
+                // Đoạn [j, end) của hàng y tá c / T nằm trong khối
+                int j = c % totalShifts_;
+                int end = (int)std::min<long>(totalShifts_, j + (hi - c));
+                const uint64_t* row = words + (size_t)(c / totalShifts_) * wordsPerRow_;
+                for (int w = j / 64; w * 64 < end; w++) {
+                    uint64_t mask = ~uint64_t(0);
+                    if (w * 64 < j) mask &= ~uint64_t(0) << (j - w * 64);
+                    if (end < w * 64 + 64) mask &= (uint64_t(1) << (end - w * 64)) - 1;
+                    h = mix(h, row[w] & mask);
+                }
+                c += end - j;
+            }
+            keys[b] = h;
+        }
+        return keys;
+    }
+
+    // Gỡ lịch e: lịch cuối chuyển vào chỗ e, cập nhật index cho nó
+    void remove(int e) {
+        eraseKeys(e);
+        int last = entries_.size() - 1;
+        if (e != last) {
+            eraseKeys(last);
+            entries_[e] = std::move(entries_[last]);
+            seen_[e] = seen_[last];
+            for (uint64_t key : entries_[e].keys) index_.emplace(key, e);
+        }
+        entries_.pop_back();
+        seen_.pop_back();
+    }
+
+    void eraseKeys(int e) {
+        for (uint64_t key : entries_[e].keys) {
+            auto range = index_.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == e) {
+                    index_.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,163 @@
+/**
+ * Nurse Scheduling Problem (NSP) - Replay model CP-SAT đã ghi bởi nsp --dump-model
+ * Đọc PREFIX.model.pb, PREFIX.params.pb, PREFIX.response.pb (protobuf nhị phân),
+ * giải lại với tham số khác và so với kết quả đã ghi. Không cần build lại model.
+ * Compile: g++ -O3 -std=c++17 nsp_replay.cpp -lortools -lprotobuf -o nsp_replay
+ *
+ * Chạy:    ./nsp_replay runs/ward7                     (giải lại với tham số gốc)
+ *          ./nsp_replay runs/ward7 --workers 16 --time-limit 30 --seed 3
+ *          ./nsp_replay runs/ward7 --params "linearization_level:2,symmetry_level:4"
+ *                                       (ghi đè SatParameters dạng text proto)
+ *          ./nsp_replay runs/ward7 --repeats 5   (mỗi lần seed khác, in thống kê)
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+#include "google/protobuf/text_format.h"
+#include "ortools/sat/cp_model.h"
+#include "ortools/sat/cp_model_solver.h"
+
+using namespace std;
+using namespace operations_research;
+using namespace operations_research::sat;
+
+template <typename Proto>
+bool readProtoFile(const string& path, Proto& message) {
+    ifstream in(path, ios::binary);
+    return in && message.ParseFromIstream(&in);
+}
+
+const char* statusName(CpSolverStatus status) {
+    switch (status) {
+        case CpSolverStatus::OPTIMAL:    return "OPTIMAL";
+        case CpSolverStatus::FEASIBLE:   return "FEASIBLE";
+        case CpSolverStatus::INFEASIBLE: return "INFEASIBLE";
+        case CpSolverStatus::MODEL_INVALID: return "MODEL_INVALID";
+        default:                         return "UNKNOWN";
+    }
+}
+
+void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " PREFIX [options]\n"
+         << "  --workers N         num_workers\n"
+         << "  --time-limit S      max_time_in_seconds\n"
+         << "  --seed N            random_seed (repeat r dùng seed N + r)\n"
+         << "  --params TEXT       SatParameters text proto, ghi đè sau cùng\n"
+         << "  --repeats R         số lần giải (mặc định 1)\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2 || string(argv[1]) == "--help") {
+        printUsage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+    string prefix = argv[1];
+    int workers = 0, seed = -1, repeats = 1;
+    double timeLimit = -1;
+    string paramsText;
+    for (int a = 2; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--workers" && a + 1 < argc) {
+            workers = atoi(argv[++a]);
+        } else if (arg == "--time-limit" && a + 1 < argc) {
+            timeLimit = atof(argv[++a]);
+        } else if (arg == "--seed" && a + 1 < argc) {
+            seed = atoi(argv[++a]);
+        } else if (arg == "--params" && a + 1 < argc) {
+            paramsText = argv[++a];
+        } else if (arg == "--repeats" && a + 1 < argc) {
+            repeats = max(1, atoi(argv[++a]));
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // ==================== ĐỌC FILE ====================
+    CpModelProto model;
+    SatParameters parameters;
+    CpSolverResponse recorded;
+    if (!readProtoFile(prefix + ".model.pb", model)) {
+        cerr << "Cannot read " << prefix << ".model.pb" << endl;
+        return 1;
+    }
+    if (!readProtoFile(prefix + ".params.pb", parameters)) {
+        cerr << "Không có " << prefix << ".params.pb, dùng tham số mặc định" << endl;
+    }
+    bool hasRecorded = readProtoFile(prefix + ".response.pb", recorded);
+
+    if (workers > 0) parameters.set_num_workers(workers);
+    if (timeLimit > 0) parameters.set_max_time_in_seconds(timeLimit);
+    if (!paramsText.empty()) {
+        // "a:1,b:2" -> "a:1 b:2" (text proto chấp nhận cả hai, dấu phẩy cho dễ gõ trên shell)
+        replace(paramsText.begin(), paramsText.end(), ',', ' ');
+        SatParameters overrides;
+        if (!google::protobuf::TextFormat::ParseFromString(paramsText, &overrides)) {
+            cerr << "Invalid --params: " << paramsText << endl;
+            return 1;
+        }
+        parameters.MergeFrom(overrides);
+    }
+
+    cout << "Model: " << model.variables_size() << " biến, "
+         << model.constraints_size() << " ràng buộc" << endl;
+    if (hasRecorded) {
+        cout << "RECORDED_STATUS=" << statusName(recorded.status()) << endl;
+        cout << "RECORDED_COST=" << fixed << setprecision(2)
+             << recorded.objective_value() / 100.0 << endl;
+        cout << "RECORDED_BOUND=" << recorded.best_objective_bound() / 100.0 << endl;
+        cout << "RECORDED_MS=" << recorded.wall_time() * 1000.0 << endl;
+    }
+
+    // ==================== GIẢI LẠI ====================
+    vector<double> times;
+    int mismatches = 0;
+    for (int r = 0; r < repeats; r++) {
+        SatParameters runParameters = parameters;
+        if (seed >= 0) runParameters.set_random_seed(seed + r);
+        else if (repeats > 1) runParameters.set_random_seed(parameters.random_seed() + r);
+
+        auto start = chrono::high_resolution_clock::now();
+        CpSolverResponse response = SolveWithParameters(model, runParameters);
+        double ms = chrono::duration<double, milli>(
+            chrono::high_resolution_clock::now() - start).count();
+        times.push_back(ms);
+
+        // Cùng trạng thái tối ưu mà chi phí khác là dấu hiệu model / solver đã thay đổi
+        bool mismatch = hasRecorded && response.status() == CpSolverStatus::OPTIMAL &&
+                        recorded.status() == CpSolverStatus::OPTIMAL &&
+                        response.objective_value() != recorded.objective_value();
+        if (mismatch) mismatches++;
+        cout << "  run " << r + 1 << ": " << setw(10) << statusName(response.status())
+             << "  cost " << fixed << setprecision(2) << response.objective_value() / 100.0
+             << "  bound " << response.best_objective_bound() / 100.0
+             << "  " << ms << " ms  conflicts " << response.num_conflicts()
+             << (mismatch ? "  (KHÁC kết quả đã ghi)" : "") << endl;
+    }
+
+    double mean = 0, var = 0;
+    for (double t : times) mean += t;
+    mean /= times.size();
+    for (double t : times) var += (t - mean) * (t - mean);
+    double stddev = times.size() > 1 ? sqrt(var / (times.size() - 1)) : 0.0;
+
+    cout << "REPLAY_RUNS=" << repeats << endl;
+    cout << "REPLAY_MEAN_MS=" << fixed << setprecision(2) << mean << endl;
+    cout << "REPLAY_STDDEV_MS=" << stddev << endl;
+    cout << "REPLAY_MIN_MS=" << *min_element(times.begin(), times.end()) << endl;
+    cout << "REPLAY_MAX_MS=" << *max_element(times.begin(), times.end()) << endl;
+    if (hasRecorded && recorded.wall_time() > 0) {
+        cout << "SPEEDUP=" << recorded.wall_time() * 1000.0 / mean << endl;
+    }
+    cout << "MISMATCHES=" << mismatches << endl;
+    return mismatches > 0 ? 2 : 0;
+}
@@ -0,0 +1,459 @@
+/**
+ * Nurse Scheduling Problem (NSP) - Benchmark chéo ngôn ngữ (C++ / Rust / Python)
+ * Chạy từng bản cài đặt như một process riêng, ghim CPU, lặp nhiều lần và đọc các dòng
+ * key=value (SUCCESS/FAILED, STATUS=, BUILD_MS=, SOLVE_MS=, TOTAL_MS=, TOTAL_COST=) từ stdout.
+ * Wall time, CPU time (user + sys) và max RSS lấy từ wait4()/rusage của process con,
+ * không phụ thuộc vào thời gian chương trình tự báo.
+ *
+ * Compile: g++ -O2 -std=c++17 nsp_runner.cpp -o nsp_runner
+ *
+ * Chạy:    ./nsp_runner                                   (các bản mặc định, 5 lần mỗi bản)
+ *          ./nsp_runner --trials 10 --warmup 1 --cpus 2-5
+ *          ./nsp_runner --impl highs=./nsp_highs --impl rust=../Week8/nsp/target/release/nsp
+ *          ./nsp_runner --csv runs.csv --timeout 600
+ *
+ * Các lần chạy được xen kẽ giữa các bản (A B C A B C ...) để nhiễu theo thời gian
+ * (nhiệt độ CPU, cache hệ thống) chia đều cho mọi bản.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+// ==================== CẤU HÌNH ====================
+
+struct Implementation {
+    string name;
+    vector<string> argv;          // argv[0] tìm theo PATH nếu không có '/'
+};
+
+struct RunnerOptions {
+    vector<Implementation> impls;
+    int trials = 5;
+    int warmup = 0;               // số lần chạy bỏ đi trước khi đo
+    double timeoutSec = 0;        // 0 = không giới hạn
+    vector<int> cpus;             // rỗng = không ghim
+    string csvPath;
+    bool showOutput = false;      // chuyển stdout/stderr của con ra terminal
+};
+
+vector<Implementation> defaultImplementations() {
+    return {
+        {"cpp-highs", {"./nsp_highs"}},
+        {"cpp-standalone", {"./nsp_standalone"}},
+        {"rust", {"../Week8/nsp/target/release/nsp"}},
+        {"python", {"python3", "../Week8/nsp.py"}},
+    };
+}
+
+vector<string> splitWords(const string& text) {
+    vector<string> words;
+    stringstream ss(text);
+    string word;
+    while (ss >> word) words.push_back(word);
+    return words;
+}
+
+// "0,2,4-7" -> {0, 2, 4, 5, 6, 7}
+bool parseCpuList(const string& text, vector<int>& cpus) {
+    stringstream ss(text);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        size_t dash = item.find('-');
+        char* end = nullptr;
+        long lo = strtol(item.c_str(), &end, 10);
+        long hi = lo;
+        if (dash != string::npos) hi = strtol(item.c_str() + dash + 1, &end, 10);
+        if (*end != '\0' || lo < 0 || hi < lo || hi >= CPU_SETSIZE) return false;
+        for (long c = lo; c <= hi; c++) cpus.push_back((int)c);
+    }
+    return !cpus.empty();
+}
+
+// ==================== CHẠY MỘT LẦN ====================
+
+struct TrialResult {
+    string impl;
+    int trial;
+    bool exited;                  // kết thúc bình thường (không bị kill / timeout)
+    int exitCode;
+    bool timedOut;
+    double wallMs;
+    double cpuMs;
+    double maxRssMb;
+    map<string, string> values;   // các dòng key=value; SUCCESS/FAILED -> STATUS
+};
+
+// Dòng "KEY=VALUE" với KEY viết hoa; "SUCCESS" / "FAILED" đứng riêng của bản Rust/Python
+void parseOutput(const string& output, map<string, string>& values) {
+    stringstream ss(output);
+    string line;
+    while (getline(ss, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+        if (line == "SUCCESS" || line == "FAILED") {
+            values["STATUS"] = line;
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == string::npos || eq == 0) continue;
+        string key = line.substr(0, eq);
+        bool isKey = all_of(key.begin(), key.end(), [](char c) {
+            return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        });
+        if (!isKey) continue;
+        // "STATUS=HEURISTIC (violations=12)" -> "HEURISTIC"
+        string value = line.substr(eq + 1);
+        size_t space = value.find(' ');
+        if (space != string::npos) value = value.substr(0, space);
+        values[key] = value;
+    }
+}
+
+TrialResult runTrial(const Implementation& impl, const RunnerOptions& options, int trial) {
+    TrialResult result;
+    result.impl = impl.name;
+    result.trial = trial;
+    result.exited = false;
+    result.exitCode = -1;
+    result.timedOut = false;
+    result.wallMs = result.cpuMs = result.maxRssMb = 0;
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        return result;
+    }
+    auto start = chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+    if (pid == 0) {
+        // Process con: ghim CPU rồi exec; affinity được kế thừa qua exec và mọi thread con
+        if (!options.cpus.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int c : options.cpus) CPU_SET(c, &set);
+            if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+                perror("sched_setaffinity");
+                _exit(126);
+            }
+        }
+        dup2(fds[1], STDOUT_FILENO);
+        if (!options.showOutput) {
+            int devNull = open("/dev/null", O_WRONLY);
+            if (devNull >= 0) {
+                dup2(devNull, STDERR_FILENO);
+                close(devNull);
+            }
+        }
+        close(fds[0]);
+        close(fds[1]);
+        vector<char*> args;
+        for (const string& a : impl.argv) args.push_back(const_cast<char*>(a.c_str()));
+        args.push_back(nullptr);
+        execvp(args[0], args.data());
+        _exit(127);
+    }
+    close(fds[1]);
+
+    // Đọc stdout cho đến EOF; quá timeout thì SIGKILL rồi đọc nốt phần còn lại
+    string output;
+    char buffer[4096];
+    bool killed = false;
+    while (true) {
+        int waitMs = -1;
+        if (options.timeoutSec > 0 && !killed) {
+            double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            waitMs = max(0, (int)((options.timeoutSec - elapsed) * 1000.0));
+        }
+        pollfd pfd = {fds[0], POLLIN, 0};
+        int ready = poll(&pfd, 1, waitMs);
+        if (ready < 0 && errno == EINTR) continue;
+        if (ready == 0) {
+            kill(pid, SIGKILL);
+            killed = true;
+            result.timedOut = true;
+            continue;
+        }
+        ssize_t n = read(fds[0], buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        output.append(buffer, n);
+        if (options.showOutput) cout.write(buffer, n);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage;
+    memset(&usage, 0, sizeof(usage));
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {}
+    result.wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    result.cpuMs = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+                   (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+    result.maxRssMb = usage.ru_maxrss / 1024.0;  // Linux: KB
+    result.exited = WIFEXITED(status) && !result.timedOut;
+    if (WIFEXITED(status)) result.exitCode = WEXITSTATUS(status);
+
+    parseOutput(output, result.values);
+    if (result.timedOut) result.values["STATUS"] = "TIMEOUT";
+    else if (result.exitCode == 127) result.values["STATUS"] = "EXEC_FAILED";
+    else if (!result.exited) result.values["STATUS"] = "CRASHED";
+    return result;
+}
+
+bool succeeded(const TrialResult& r) {
+    if (!r.exited || r.exitCode != 0) return false;
+    auto it = r.values.find("STATUS");
+    if (it == r.values.end()) return false;
+    return it->second != "FAILED" && it->second != "INFEASIBLE";
+}
+
+// ==================== THỐNG KÊ ====================
+
+struct Summary {
+    int n = 0;
+    double mean = 0, stddev = 0, median = 0, min = 0, max = 0;
+    double ciHalf = 0;            // nửa khoảng tin cậy 95% của mean
+};
+
+// t(0.975, df), df = 1..30; df lớn hơn dùng 1.96
+double tQuantile(int df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (df < 1) return 0;
+    return df <= 30 ? table[df - 1] : 1.96;
+}
+
+Summary summarize(vector<double> values) {
+    Summary s;
+    s.n = values.size();
+    if (s.n == 0) return s;
+    sort(values.begin(), values.end());
+    s.min = values.front();
+    s.max = values.back();
+    s.median = s.n % 2 ? values[s.n / 2] : (values[s.n / 2 - 1] + values[s.n / 2]) / 2.0;
+    for (double v : values) s.mean += v;
+    s.mean /= s.n;
+    if (s.n > 1) {
+        double var = 0;
+        for (double v : values) var += (v - s.mean) * (v - s.mean);
+        s.stddev = sqrt(var / (s.n - 1));
+        s.ciHalf = tQuantile(s.n - 1) * s.stddev / sqrt((double)s.n);
+    }
+    return s;
+}
+
+// Lấy một metric của các lần chạy thành công; key rỗng = metric đo bởi runner
+vector<double> collect(const vector<TrialResult>& trials, const string& impl, const string& key) {
+    vector<double> values;
+    for (const TrialResult& r : trials) {
+        if (r.impl != impl || !succeeded(r)) continue;
+        if (key == "WALL") values.push_back(r.wallMs);
+        else if (key == "CPU") values.push_back(r.cpuMs);
+        else if (key == "RSS") values.push_back(r.maxRssMb);
+        else {
+            auto it = r.values.find(key);
+            if (it != r.values.end()) values.push_back(atof(it->second.c_str()));
+        }
+    }
+    return values;
+}
+
+void printMetricTable(const vector<TrialResult>& trials, const RunnerOptions& options,
+                      const string& key, const string& title) {
+    cout << "\n--- " << title << " ---" << endl;
+    cout << left << setw(16) << "IMPL" << right << setw(4) << "N"
+         << setw(12) << "MEAN" << setw(12) << "±95%CI" << setw(12) << "STDDEV"
+         << setw(12) << "MEDIAN" << setw(12) << "MIN" << setw(12) << "MAX"
+         << setw(8) << "CV%" << endl;
+    for (const Implementation& impl : options.impls) {
+        Summary s = summarize(collect(trials, impl.name, key));
+        cout << left << setw(16) << impl.name << right << setw(4) << s.n;
+        if (s.n == 0) {
+            cout << setw(12) << "-" << endl;
+            continue;
+        }
+        cout << fixed << setprecision(2) << setw(12) << s.mean << setw(12) << s.ciHalf
+             << setw(12) << s.stddev << setw(12) << s.median << setw(12) << s.min
+             << setw(12) << s.max << setprecision(1) << setw(8)
+             << (s.mean > 0 ? 100.0 * s.stddev / s.mean : 0.0) << endl;
+    }
+}
+
+// So sánh wall time với bản đầu tiên: tỉ lệ trung vị và khoảng tin cậy có tách nhau không
+void printComparison(const vector<TrialResult>& trials, const RunnerOptions& options) {
+    const string& baseName = options.impls.front().name;
+    Summary base = summarize(collect(trials, baseName, "WALL"));
+    cout << "\n--- SO SÁNH (WALL_MS, mốc = " << baseName << ") ---" << endl;
+    cout << left << setw(16) << "IMPL" << right << setw(12) << "MEDIAN_MS"
+         << setw(10) << "RATIO" << setw(14) << "SIGNIFICANT" << setw(16) << "TOTAL_COST"
+         << setw(10) << "SUCCESS" << endl;
+    for (const Implementation& impl : options.impls) {
+        Summary s = summarize(collect(trials, impl.name, "WALL"));
+        int runs = 0, ok = 0;
+        vector<string> costs;
+        for (const TrialResult& r : trials) {
+            if (r.impl != impl.name) continue;
+            runs++;
+            if (!succeeded(r)) continue;
+            ok++;
+            auto it = r.values.find("TOTAL_COST");
+            if (it != r.values.end() && find(costs.begin(), costs.end(), it->second) == costs.end()) {
+                costs.push_back(it->second);
+            }
+        }
+        cout << left << setw(16) << impl.name << right;
+        if (s.n == 0 || base.n == 0) {
+            cout << setw(12) << "-" << setw(10) << "-" << setw(14) << "-";
+        } else {
+            // Hai khoảng tin cậy 95% không giao nhau: khác biệt không phải do nhiễu
+            bool separated = s.mean - s.ciHalf > base.mean + base.ciHalf ||
+                             s.mean + s.ciHalf < base.mean - base.ciHalf;
+            bool enough = s.n > 1 && base.n > 1;
+            cout << fixed << setprecision(2) << setw(12) << s.median
+                 << setw(9) << s.median / base.median << "x"
+                 << setw(14) << (impl.name == baseName ? "-" : !enough ? "n<2" : separated ? "yes" : "no");
+        }
+        string cost = costs.empty() ? "-" : costs.size() == 1 ? costs[0] : "KHÁC NHAU";
+        cout << setw(16) << cost << setw(7) << ok << "/" << runs << endl;
+    }
+}
+
+void writeCsv(const string& path, const vector<TrialResult>& trials) {
+    ofstream out(path);
+    if (!out) {
+        cerr << "Cannot write " << path << endl;
+        return;
+    }
+    auto value = [](const TrialResult& r, const string& key) {
+        auto it = r.values.find(key);
+        return it == r.values.end() ? string() : it->second;
+    };
+    out << "impl,trial,status,exit_code,wall_ms,cpu_ms,max_rss_mb,build_ms,solve_ms,total_ms,total_cost\n";
+    out << fixed << setprecision(3);
+    for (const TrialResult& r : trials) {
+        out << r.impl << ',' << r.trial << ',' << value(r, "STATUS") << ',' << r.exitCode << ','
+            << r.wallMs << ',' << r.cpuMs << ',' << r.maxRssMb << ','
+            << value(r, "BUILD_MS") << ',' << value(r, "SOLVE_MS") << ','
+            << value(r, "TOTAL_MS") << ',' << value(r, "TOTAL_COST") << '\n';
+    }
+}
+
+void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " [options]\n"
+         << "  --impl NAME=CMD     thêm một bản cài đặt (CMD tách theo khoảng trắng);\n"
+         << "                      có --impl thì bỏ danh sách mặc định\n"
+         << "  --trials N          số lần đo mỗi bản (mặc định 5)\n"
+         << "  --warmup N          số lần chạy bỏ đi trước khi đo (mặc định 0)\n"
+         << "  --cpus LIST         ghim CPU, ví dụ 2,3 hoặc 4-7\n"
+         << "  --timeout S         kill lần chạy quá S giây\n"
+         << "  --csv FILE          ghi từng lần chạy ra CSV\n"
+         << "  --show-output       in stdout/stderr của các bản\n";
+}
+
+// ==================== MAIN ====================
+
+int main(int argc, char** argv) {
+    RunnerOptions options;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--impl" && a + 1 < argc) {
+            string spec = argv[++a];
+            size_t eq = spec.find('=');
+            Implementation impl;
+            if (eq != string::npos) {
+                impl.name = spec.substr(0, eq);
+                impl.argv = splitWords(spec.substr(eq + 1));
+            }
+            if (impl.name.empty() || impl.argv.empty()) {
+                cerr << "Invalid --impl: " << spec << " (expected NAME=CMD)" << endl;
+                return 1;
+            }
+            options.impls.push_back(impl);
+        } else if (arg == "--trials" && a + 1 < argc) {
+            options.trials = max(1, atoi(argv[++a]));
+        } else if (arg == "--warmup" && a + 1 < argc) {
+            options.warmup = max(0, atoi(argv[++a]));
+        } else if (arg == "--cpus" && a + 1 < argc) {
+            if (!parseCpuList(argv[++a], options.cpus)) {
+                cerr << "Invalid --cpus: " << argv[a] << endl;
+                return 1;
+            }
+        } else if (arg == "--timeout" && a + 1 < argc) {
+            options.timeoutSec = atof(argv[++a]);
+        } else if (arg == "--csv" && a + 1 < argc) {
+            options.csvPath = argv[++a];
+        } else if (arg == "--show-output") {
+            options.showOutput = true;
+        } else if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.impls.empty()) options.impls = defaultImplementations();
+
+    cout << "Implementations: " << options.impls.size() << ", trials: " << options.trials
+         << ", warmup: " << options.warmup << ", CPUs: ";
+    if (options.cpus.empty()) cout << "không ghim";
+    for (size_t i = 0; i < options.cpus.size(); i++) cout << (i ? "," : "") << options.cpus[i];
+    cout << "\n" << endl;
+
+    vector<TrialResult> trials;
+    for (int round = 0; round < options.warmup + options.trials; round++) {
+        bool isWarmup = round < options.warmup;
+        for (const Implementation& impl : options.impls) {
+            TrialResult r = runTrial(impl, options, isWarmup ? 0 : round - options.warmup + 1);
+            auto status = r.values.find("STATUS");
+            cout << (isWarmup ? "  warmup " : "  trial  ") << setw(3) << (isWarmup ? round + 1 : r.trial)
+                 << "  " << left << setw(16) << impl.name << right
+                 << setw(12) << (status == r.values.end() ? "?" : status->second)
+                 << fixed << setprecision(2) << setw(12) << r.wallMs << " ms"
+                 << setw(12) << r.cpuMs << " cpu-ms" << setprecision(1)
+                 << setw(9) << r.maxRssMb << " MB" << endl;
+            if (!isWarmup) trials.push_back(r);
+        }
+    }
+
+    printMetricTable(trials, options, "WALL", "WALL_MS (đo bởi runner)");
+    printMetricTable(trials, options, "CPU", "CPU_MS (user + sys)");
+    printMetricTable(trials, options, "RSS", "MAX_RSS_MB");
+    printMetricTable(trials, options, "BUILD_MS", "BUILD_MS (chương trình tự báo)");
+    printMetricTable(trials, options, "SOLVE_MS", "SOLVE_MS (chương trình tự báo)");
+    printComparison(trials, options);
+
+    if (!options.csvPath.empty()) {
+        writeCsv(options.csvPath, trials);
+        cout << "\nCSV: " << options.csvPath << endl;
+    }
+    return 0;
+}
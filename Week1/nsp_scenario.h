@@ -0,0 +1,228 @@
+/**
+ * Nurse Scheduling Problem (NSP) - Đánh giá lịch trên nhiều kịch bản nhu cầu
+ *
+ * Nhu cầu thực tế dao động quanh inst.demandFor(j); một lịch tối ưu cho nhu cầu danh nghĩa
+ * có thể thiếu người ở kịch bản khác. File này:
+ *   - sinh các kịch bản nhu cầu (nhiễu nhân theo ngày, dùng chung cho các ca trong ngày,
+ *     và theo từng ca), chia khối cho nhiều thread, mỗi khối một RNG seed từ (seed, khối)
+ *     nên cùng seed cho cùng kịch bản với mọi số thread,
+ *   - chấm một lịch trên mọi kịch bản: độ phủ theo ca chỉ tính một lần từ lịch, mỗi kịch bản
+ *     là một vòng max(0, nhu cầu - độ phủ) trên mảng int32 liên tục (compiler vector hóa),
+ *   - bảng "số kịch bản có nhu cầu > c" theo ca, để local search tính chênh lệch thiếu hụt
+ *     kỳ vọng của một bước đổi ±1 người trong O(1).
+ * Chỉ xét nhu cầu #1; nhu cầu kỹ năng #12 giữ nguyên như danh nghĩa.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "nsp_backend.h"
+
+struct NSPScenarioOptions {
+    int numScenarios = 10000;
+    double shiftNoise = 0.1;          // độ lệch chuẩn tương đối của nhu cầu từng ca
+    double dayNoise = 0.05;           // độ lệch chuẩn tương đối dùng chung cho các ca trong ngày
+    double costShortfall = 2000;      // chi phí mỗi người thiếu ở một ca của một kịch bản
+    uint64_t seed = 1;
+    int threads = 0;                  // <= 0: theo hardware_concurrency
+};
+
+struct NSPScenarioSet {
+    int numScenarios = 0;
+    int numShifts = 0;
+    double costShortfall = 0;
+    std::vector<int32_t> demand;      // [s * numShifts + j]
+    // exceed[tailStart[j] + c] = số kịch bản có nhu cầu ca j > c, với 0 <= c < max nhu cầu ca j
+    std::vector<int> tailStart;
+    std::vector<int32_t> exceed;
+
+    const int32_t* scenario(int s) const { return demand.data() + (size_t)s * numShifts; }
+
+    int exceeding(int j, int c) const {
+        int len = tailStart[j + 1] - tailStart[j];
+        return c < len ? exceed[tailStart[j] + c] : 0;
+    }
+
+    // Chênh lệch tổng thiếu hụt kỳ vọng (người-ca) khi độ phủ ca j đổi từ c sang c + change
+    double shortfallDelta(int j, int c, int change) const {
+        if (change > 0) return -(double)exceeding(j, c) / numScenarios;
+        if (change < 0) return (double)exceeding(j, c - 1) / numScenarios;
+        return 0;
+    }
+
+    // Tổng thiếu hụt kỳ vọng qua mọi ca: sum_j mean_s max(0, d[s][j] - cover[j])
+    double expectedShortfall(const std::vector<int>& cover) const {
+        long total = 0;
+        for (int j = 0; j < numShifts; j++) {
+            for (int c = std::max(0, cover[j]); c < tailStart[j + 1] - tailStart[j]; c++) {
+                total += exceed[tailStart[j] + c];
+            }
+        }
+        return numScenarios > 0 ? (double)total / numScenarios : 0.0;
+    }
+
+    void buildTail() {
+        std::vector<int> maxDemand(numShifts, 0);
+        for (int s = 0; s < numScenarios; s++) {
+            const int32_t* d = scenario(s);
+            for (int j = 0; j < numShifts; j++) maxDemand[j] = std::max(maxDemand[j], (int)d[j]);
+        }
+        tailStart.assign(numShifts + 1, 0);
+        for (int j = 0; j < numShifts; j++) tailStart[j + 1] = tailStart[j] + maxDemand[j];
+        exceed.assign(tailStart[numShifts], 0);
+        // Đếm số kịch bản có nhu cầu đúng bằng v + 1 ở ô v, rồi cộng dồn từ cuối
+        for (int s = 0; s < numScenarios; s++) {
+            const int32_t* d = scenario(s);
+            for (int j = 0; j < numShifts; j++) {
+                if (d[j] > 0) exceed[tailStart[j] + d[j] - 1]++;
+            }
+        }
+        for (int j = 0; j < numShifts; j++) {
+            for (int c = tailStart[j + 1] - 2; c >= tailStart[j]; c--) exceed[c] += exceed[c + 1];
+        }
+    }
+};
+
+struct NSPScenarioReport {
+    std::vector<int32_t> shortfall;   // theo kịch bản: tổng người thiếu qua mọi ca
+    std::vector<double> shortProb;    // theo ca: tỉ lệ kịch bản thiếu người
+    double baseCost = 0;              // chi phí lịch (không phụ thuộc kịch bản)
+    double meanShortfall = 0;
+    double serviceLevel = 0;          // tỉ lệ kịch bản không thiếu ca nào
+    double expectedCost = 0;          // baseCost + costShortfall x meanShortfall
+    double p95Cost = 0;
+    double cvar95Cost = 0;            // trung bình 5% kịch bản tệ nhất
+    double worstCost = 0;
+    int threadsUsed = 1;
+
+    double costOf(int s, double costShortfall) const { return baseCost + costShortfall * shortfall[s]; }
+};
+
+namespace nsp_scenario_detail {
+
+// SplitMix64: seed độc lập cho từng khối kịch bản
+inline uint64_t blockSeed(uint64_t seed, uint64_t block) {
+    uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (block + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+const int SCENARIO_BLOCK = 1024;
+
+inline int threadCount(int requested, long work) {
+    int n = requested > 0 ? requested : (int)std::max(1u, std::thread::hardware_concurrency());
+    return (int)std::max(1L, std::min<long>(n, work));
+}
+
+// Chạy fn(t, begin, end) trên các khối [begin, end) của [0, count), mỗi thread một đoạn khối
+template <class Fn>
+void forBlocks(int numThreads, int count, Fn fn) {
+    int numBlocks = (count + SCENARIO_BLOCK - 1) / SCENARIO_BLOCK;
+    int perThread = (numBlocks + numThreads - 1) / numThreads;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++) {
+        int begin = std::min(count, t * perThread * SCENARIO_BLOCK);
+        int end = std::min(count, begin + perThread * SCENARIO_BLOCK);
+        if (t + 1 == numThreads) fn(t, begin, end);
+        else workers.emplace_back(fn, t, begin, end);
+    }
+    for (std::thread& w : workers) w.join();
+}
+
+} // namespace nsp_scenario_detail
+
+inline NSPScenarioSet sampleDemandScenarios(const NSPInstance& inst, const NSPScenarioOptions& opt) {
+    using namespace nsp_scenario_detail;
+    NSPScenarioSet set;
+    set.numScenarios = std::max(0, opt.numScenarios);
+    set.numShifts = inst.totalShifts();
+    set.costShortfall = opt.costShortfall;
+    set.demand.assign((size_t)set.numScenarios * set.numShifts, 0);
+    const int T = set.numShifts, S = inst.shiftsPerDay;
+    int numBlocks = (set.numScenarios + SCENARIO_BLOCK - 1) / SCENARIO_BLOCK;
+
+    forBlocks(threadCount(opt.threads, numBlocks), set.numScenarios, [&](int, int begin, int end) {
+        for (int block = begin / SCENARIO_BLOCK; block * SCENARIO_BLOCK < end; block++) {
+            // Phân phối tạo lại mỗi khối: normal_distribution giữ giá trị dư giữa các lần gọi
+            std::mt19937_64 rng(blockSeed(opt.seed, block));
+            std::normal_distribution<double> dayDist(1.0, opt.dayNoise), shiftDist(1.0, opt.shiftNoise);
+            int last = std::min(end, (block + 1) * SCENARIO_BLOCK);
+            for (int s = block * SCENARIO_BLOCK; s < last; s++) {
+                int32_t* d = set.demand.data() + (size_t)s * T;
+                double day = 1.0;
+                for (int j = 0; j < T; j++) {
+                    if (j % S == 0) day = opt.dayNoise > 0 ? dayDist(rng) : 1.0;
+                    double shift = opt.shiftNoise > 0 ? shiftDist(rng) : 1.0;
+                    d[j] = (int32_t)std::max(0L, std::lround(inst.demandFor(j) * day * shift));
+                }
+            }
+        }
+    });
+    set.buildTail();
+    return set;
+}
+
+// cover[j] = số y tá làm ca j của lịch cần chấm; baseCost = chi phí lịch (evaluateSchedule /
+// validateSchedule), cộng costShortfall cho mỗi người thiếu của từng kịch bản
+inline NSPScenarioReport evaluateScenarios(const NSPScenarioSet& set, const std::vector<int>& cover,
+                                           double baseCost, int numThreads = 0) {
+    using namespace nsp_scenario_detail;
+    NSPScenarioReport report;
+    const int T = set.numShifts, N = set.numScenarios;
+    report.baseCost = baseCost;
+    report.shortfall.assign(N, 0);
+    report.shortProb.assign(T, 0.0);
+    if (N == 0) return report;
+
+    int numBlocks = (N + SCENARIO_BLOCK - 1) / SCENARIO_BLOCK;
+    report.threadsUsed = threadCount(numThreads, numBlocks);
+    std::vector<int32_t> cov(cover.begin(), cover.end());
+    std::vector<std::vector<int32_t>> shortCount(report.threadsUsed, std::vector<int32_t>(T, 0));
+    forBlocks(report.threadsUsed, N, [&](int t, int begin, int end) {
+        const int32_t* c = cov.data();
+        int32_t* counts = shortCount[t].data();
+        for (int s = begin; s < end; s++) {
+            const int32_t* d = set.scenario(s);
+            int32_t total = 0;
+            for (int j = 0; j < T; j++) {
+                int32_t gap = d[j] - c[j];
+                total += gap > 0 ? gap : 0;
+                counts[j] += gap > 0;
+            }
+            report.shortfall[s] = total;
+        }
+    });
+
+    for (int j = 0; j < T; j++) {
+        long count = 0;
+        for (const std::vector<int32_t>& counts : shortCount) count += counts[j];
+        report.shortProb[j] = (double)count / N;
+    }
+    long sum = 0, covered = 0;
+    for (int32_t v : report.shortfall) {
+        sum += v;
+        covered += v == 0;
+    }
+    report.meanShortfall = (double)sum / N;
+    report.serviceLevel = (double)covered / N;
+    report.expectedCost = baseCost + set.costShortfall * report.meanShortfall;
+
+    // Phân vị theo thiếu hụt (chi phí tăng đơn điệu theo thiếu hụt)
+    std::vector<int32_t> sorted = report.shortfall;
+    int tail = std::max(1, (int)std::ceil(N * 0.05));
+    std::nth_element(sorted.begin(), sorted.begin() + (N - tail), sorted.end());
+    std::sort(sorted.begin() + (N - tail), sorted.end());
+    long tailSum = 0;
+    for (int s = N - tail; s < N; s++) tailSum += sorted[s];
+    report.p95Cost = baseCost + set.costShortfall * sorted[N - tail];
+    report.cvar95Cost = baseCost + set.costShortfall * (double)tailSum / tail;
+    report.worstCost = baseCost + set.costShortfall * sorted[N - 1];
+    return report;
+}
@@ -2,6 +2,22 @@
  * Nurse Scheduling Problem (NSP) - Standalone C++
  * Cùng dữ liệu với Rust/Python, không gọi solver bên ngoài
  * Thuật toán: Gomory-Hu Tree + Branch & Bound (pure C++)
+ * Instance: makeReferenceInstance() trong nsp_backend.h (backend "heuristic" của nsp_bench)
+ *
+ * Chạy:    ./nsp_standalone
+ *          ./nsp_standalone --scenarios 2000 --demand-noise 0.15 --shortfall-cost 2000
+ *                                       (local search so theo chi phí trung bình trên các kịch bản
+ *                                        nhu cầu của nsp_scenario.h, rồi chấm độ bền của lịch)
+ *          ./nsp_standalone --restarts 8 --pool 5 --pool-distance 500 --pool-out pool/run
+ *                                       (giữ 5 lịch tốt nhất cách nhau >= 500 ô qua 8 lần chạy,
+ *                                        ghi pool/run.1.bin ... theo NSPB, xem nsp_pool.h)
+ *          ./nsp_standalone --restarts 8 --checkpoint run.ckpt --checkpoint-interval 10
+ *          ./nsp_standalone --resume run.ckpt   (chạy tiếp từ checkpoint: lần chạy, vòng local search,
+ *                                        trạng thái RNG, lịch hiện tại và lịch tốt nhất; cùng seed
+ *                                        thì cho đúng kết quả của lần chạy không bị ngắt)
+ *          ./nsp_standalone --pool-selftest 2000 --pool 20 --pool-distance 100
+ *                                       (kiểm index của pool trên lịch ngẫu nhiên, exit 1 nếu số lần
+ *                                        so khoảng cách không nhỏ hơn hẳn offers × K)
  */
 
 #include <iostream>
@@ -16,35 +32,22 @@
 #include <limits>
 #include <numeric>
 #include <cstring>
+#include <memory>
+#include <functional>
+#include <sstream>
 
-using namespace std;
-
-// ==================== CẤU HÌNH BÀI TOÁN ====================
-
-const int NUM_NURSES      = 1983;
-const int NUM_DAYS        = 7;
-const int NUM_SHIFTS      = 3;       // sang, chieu, toi
-const int NUM_HEAD_NUR    = 1234;
-
-const double COST_NORMAL  = 1000.0;
-const double COST_OVER     = 1200.0;
-const double COST_HEAD    = 1500.0;
+#include "nsp_backend.h"
+#include "nsp_scenario.h"
+#include "nsp_pool.h"
+#include "nsp_checkpoint.h"
 
-const double MIN_AFTERNOON = 2.0;
-const double MIN_NIGHT     = 1.0;
-const double MIN_HEAD      = 150.0;
+using namespace std;
 
-const double DEMAND[3]    = {542.0, 438.0, 225.0};  // sang, chieu, toi
+namespace nsp_heuristic {
 
 // ==================== CẤU TRÚC DỮ LIỆU ====================
 
-struct Nurse {
-    int id;
-    bool isHead;
-    bool isFemale;
-    double minShift;
-    double maxShift;
-};
+typedef NSPNurse Nurse;
 
 struct NSPSolution {
     bool feasible;
@@ -58,8 +61,12 @@ struct NSPSolution {
 
 class NSPSolver {
 private:
-    vector<Nurse> nurses;
-    int totalShifts;          // NUM_DAYS * NUM_SHIFTS = 21
+    NSPInstance inst;
+    const vector<Nurse>& nurses;
+    int numNurses;
+    int numDays;
+    int numShifts;
+    int totalShifts;          // numDays * numShifts = 21
     vector<int> headNurses;
     vector<int> norNurses;
     vector<int> femaleNurses;
@@ -67,16 +74,106 @@ private:
     // schedule[i * totalShifts + j] = 0 hoặc 1
     vector<char> schedule;
 
+    // blocked[i * maskWords + j / 64] bit j % 64: ô y tá i không được gán
+    // (unavailable của instance, ca chiều/đêm của y tá trưởng)
+    int maskWords;
+    vector<uint64_t> blocked;
+
+    // #12: hàng Hall theo ca (skillRowStart[j] .. skillRowStart[j + 1]) và số y tá đang phủ
+    // từng hàng; local search cập nhật skillCover theo từng ô đổi, không đếm lại
+    vector<NSPSkillRow> skillRows;
+    vector<int> skillRowStart;
+    vector<int> skillCover;
+
+    // Số y tá làm từng ca, chỉ duy trì khi có kịch bản nhu cầu
+    vector<int> shiftCover;
+
     mt19937 rng;
 
+    // Trạng thái các lần chạy (solve), cần cho checkpoint: lần chạy hiện tại, lịch tốt nhất của các
+    // lần đã xong, thời gian cộng dồn (kể cả trước khi resume)
+    int currentRun = 0;
+    bool hasBestRun = false;
+    NSPSolution bestRun;
+    vector<char> bestRunSchedule;
+    double buildMsDone = 0, solveMsDone = 0;
+    // Sau resumeFrom: solve() chạy tiếp lần currentRun từ vòng resumeIter (-1 = lần đó xong rồi)
+    bool resumePending = false;
+    int resumeIter = -1;
+
+    bool isBlocked(int i, int idx) const {
+        return (blocked[(size_t)i * maskWords + idx / 64] >> (idx % 64)) & 1;
+    }
+
+    // Chênh lệch số ô avoid đang gán khi ô idx của y tá i đổi từ before sang after
+    int avoidDelta(int i, int idx, char before, char after) const {
+        return inst.isAvoided(i, idx) ? after - before : 0;
+    }
+
+    // Chênh lệch chi phí ca làm khi tổng ca của y tá i đổi change (±1): ca thêm / bớt là ca
+    // cao nhất nên tính giá vượt minShift nếu nó nằm trên minShift
+    double staffDelta(int i, int change) const {
+        if (change == 0) return 0;
+        if (nurses[i].isHead) return change * inst.costHead;
+        int total = 0;
+        for (int j = 0; j < totalShifts; j++) total += schedule[i * totalShifts + j];
+        bool over = max(total, total + change) > (int)nurses[i].minShift;
+        return change * (over ? inst.costOvertime : inst.costNormal);
+    }
+
+    // Chênh lệch chi phí thiếu người kỳ vọng khi ca idx thêm / bớt change người
+    double scenarioDelta(int idx, int change) const {
+        return scenarios->costShortfall * scenarios->shortfallDelta(idx, shiftCover[idx], change);
+    }
+
+    // Số y tá phủ từng hàng Hall, đếm lại từ lịch
+    vector<int> skillCoverOf(const vector<char>& sched) const {
+        vector<int> cover(skillRows.size(), 0);
+        for (size_t r = 0; r < skillRows.size(); r++) {
+            for (int i = 0; i < numNurses; i++) {
+                cover[r] += sched[i * totalShifts + skillRows[r].shift] && (nurses[i].skills & skillRows[r].skills);
+            }
+        }
+        return cover;
+    }
+
+    int skillPenalty(const vector<int>& cover) const {
+        int violations = 0;
+        for (size_t r = 0; r < skillRows.size(); r++) {
+            if (cover[r] < skillRows[r].required) violations += (skillRows[r].required - cover[r]) * 10;
+        }
+        return violations;
+    }
+
+    // Chênh lệch phạt #12 khi y tá i thêm (change = 1) hoặc bỏ (change = -1) ca idx
+    int skillDelta(int i, int idx, int change) const {
+        uint8_t mask = nurses[i].skills;
+        if (!mask || change == 0) return 0;
+        int delta = 0;
+        for (int r = skillRowStart[idx]; r < skillRowStart[idx + 1]; r++) {
+            if (!(skillRows[r].skills & mask)) continue;
+            int before = max(0, skillRows[r].required - skillCover[r]);
+            int after = max(0, skillRows[r].required - skillCover[r] - change);
+            delta += (after - before) * 10;
+        }
+        return delta;
+    }
+
+    void applySkillMove(int i, int idx, int change) {
+        uint8_t mask = nurses[i].skills;
+        if (!mask || change == 0) return;
+        for (int r = skillRowStart[idx]; r < skillRowStart[idx + 1]; r++) {
+            if (skillRows[r].skills & mask) skillCover[r] += change;
+        }
+    }
+
     // Xác định nurse i có thể làm shift (day, s) không
     bool canAssign(int i, int day, int s) const {
         const Nurse& n = nurses[i];
+        int idx = day * numShifts + s;
 
-        // Y tá trưởng chỉ làm ca sáng
-        if (n.isHead && s != 0) return false;
-
-        int idx = day * NUM_SHIFTS + s;
+        // Y tá trưởng chỉ làm ca sáng, không gán ô unavailable
+        if (isBlocked(i, idx)) return false;
 
         // Ràng buộc #9: ca j và j+2 không làm cùng lúc
         if (idx >= 2 && schedule[i * totalShifts + idx - 2]) return false;
@@ -93,61 +190,67 @@ private:
         int violations = 0;
 
         // #1: Đủ số y tá mỗi ca
-        for (int day = 0; day < NUM_DAYS; day++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
-                int idx = day * NUM_SHIFTS + s;
+        for (int day = 0; day < numDays; day++) {
+            for (int s = 0; s < numShifts; s++) {
+                int idx = day * numShifts + s;
                 int count = 0;
-                for (int i = 0; i < NUM_NURSES; i++) {
+                for (int i = 0; i < numNurses; i++) {
                     count += schedule[i * totalShifts + idx];
                 }
-                if (count < (int)DEMAND[s]) {
-                    violations += ((int)DEMAND[s] - count) * 10;
+                if (count < inst.demandFor(idx)) {
+                    violations += (inst.demandFor(idx) - count) * 10;
                 }
             }
         }
 
         // #2, #3: min/max ca mỗi y tá
-        for (int i = 0; i < NUM_NURSES; i++) {
+        for (int i = 0; i < numNurses; i++) {
             int total = 0;
             for (int j = 0; j < totalShifts; j++) total += schedule[i * totalShifts + j];
             if (total < (int)nurses[i].minShift) violations += ((int)nurses[i].minShift - total) * 5;
             if (total > (int)nurses[i].maxShift) violations += (total - (int)nurses[i].maxShift) * 5;
         }
 
-        // #4: y tá thường ít nhất MIN_AFTERNOON ca chiều
+        // #11: không làm ô unavailable
+        violations += unavailableAssigned(schedule) * 10;
+
+        // #12: đủ y tá có kỹ năng cho mọi hàng Hall
+        violations += skillPenalty(skillCoverOf(schedule));
+
+        // #4: y tá thường ít nhất minAfternoon ca chiều
         for (int i : norNurses) {
             int afternoon = 0;
-            for (int day = 0; day < NUM_DAYS; day++) afternoon += schedule[i * totalShifts + day * NUM_SHIFTS + 1];
-            if (afternoon < (int)MIN_AFTERNOON) violations += ((int)MIN_AFTERNOON - afternoon) * 3;
+            for (int day = 0; day < numDays; day++) afternoon += schedule[i * totalShifts + day * numShifts + 1];
+            if (afternoon < inst.minAfternoon) violations += (inst.minAfternoon - afternoon) * 3;
         }
 
-        // #5: y tá thường ít nhất MIN_NIGHT ca tối
+        // #5: y tá thường ít nhất minNight ca tối
         for (int i : norNurses) {
             int night = 0;
-            for (int day = 0; day < NUM_DAYS; day++) night += schedule[i * totalShifts + day * NUM_SHIFTS + 2];
-            if (night < (int)MIN_NIGHT) violations += ((int)MIN_NIGHT - night) * 3;
+            for (int day = 0; day < numDays; day++) night += schedule[i * totalShifts + day * numShifts + 2];
+            if (night < inst.minNight) violations += (inst.minNight - night) * 3;
         }
 
         // #6: y tá trưởng không làm chiều/tối
         for (int i : headNurses) {
-            for (int day = 0; day < NUM_DAYS; day++) {
-                violations += schedule[i * totalShifts + day * NUM_SHIFTS + 1] * 10;
-                violations += schedule[i * totalShifts + day * NUM_SHIFTS + 2] * 10;
+            for (int day = 0; day < numDays; day++) {
+                violations += schedule[i * totalShifts + day * numShifts + 1] * 10;
+                violations += schedule[i * totalShifts + day * numShifts + 2] * 10;
             }
         }
 
-        // #7: mỗi ca sáng có ít nhất MIN_HEAD y tá trưởng
-        for (int day = 0; day < NUM_DAYS; day++) {
+        // #7: mỗi ca sáng có ít nhất minHeadPerMorning y tá trưởng
+        for (int day = 0; day < numDays; day++) {
             int headCount = 0;
-            int idx = day * NUM_SHIFTS;  // ca sáng
+            int idx = day * numShifts;  // ca sáng
             for (int i : headNurses) headCount += schedule[i * totalShifts + idx];
-            if (headCount < (int)MIN_HEAD) violations += ((int)MIN_HEAD - headCount) * 3;
+            if (headCount < inst.minHeadPerMorning) violations += (inst.minHeadPerMorning - headCount) * 3;
         }
 
         // #8: mỗi ca có ít nhất 1 y tá nữ
-        for (int day = 0; day < NUM_DAYS; day++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
-                int idx = day * NUM_SHIFTS + s;
+        for (int day = 0; day < numDays; day++) {
+            for (int s = 0; s < numShifts; s++) {
+                int idx = day * numShifts + s;
                 int femaleCount = 0;
                 for (int i : femaleNurses) femaleCount += schedule[i * totalShifts + idx];
                 if (femaleCount < 1) violations += 5;
@@ -175,39 +278,78 @@ private:
         return violations;
     }
 
+    int unavailableAssigned(const vector<char>& sched) const {
+        if (inst.unavailable.empty()) return 0;
+        int count = 0;
+        for (int i = 0; i < numNurses; i++) {
+            for (int j = 0; j < totalShifts; j++) count += sched[i * totalShifts + j] && inst.isUnavailable(i, j);
+        }
+        return count;
+    }
+
+    long countAvoided(const vector<char>& sched) const {
+        if (inst.avoid.empty()) return 0;
+        long count = 0;
+        for (int i = 0; i < numNurses; i++) {
+            for (int j = 0; j < totalShifts; j++) count += sched[i * totalShifts + j] && inst.isAvoided(i, j);
+        }
+        return count;
+    }
+
     // Tính chi phí
     double calculateCost() const {
         double cost = 0.0;
-        for (int i = 0; i < NUM_NURSES; i++) {
+        for (int i = 0; i < numNurses; i++) {
             int total = 0;
             for (int j = 0; j < totalShifts; j++) total += schedule[i * totalShifts + j];
 
             if (nurses[i].isHead) {
-                cost += total * COST_HEAD;
+                cost += total * inst.costHead;
             } else {
-                cost += total * COST_NORMAL;
+                cost += total * inst.costNormal;
                 if (total > (int)nurses[i].minShift) {
-                    cost += (total - (int)nurses[i].minShift) * (COST_OVER - COST_NORMAL);
+                    cost += (total - (int)nurses[i].minShift) * (inst.costOvertime - inst.costNormal);
                 }
             }
         }
-        return cost;
+        return cost + countAvoided(schedule) * inst.costPreference;
+    }
+
+    // Greedy: y tá i còn nhận thêm được ca idx (không blocked, chưa làm, chưa đủ max, #9, #10)
+    bool canTake(int i, int idx, const vector<int>& nurseCount) const {
+        // Ô unavailable: một AND trên mask, trước mọi kiểm tra khác
+        if (blocked[(size_t)i * maskWords + idx / 64] & (uint64_t(1) << (idx % 64))) return false;
+        if (schedule[i * totalShifts + idx]) return false;
+        if (nurseCount[i] >= (int)nurses[i].maxShift) return false;
+
+        // Ràng buộc #9
+        if (idx >= 2 && schedule[i * totalShifts + idx - 2]) return false;
+        if (idx + 2 < totalShifts && schedule[i * totalShifts + idx + 2]) return false;
+
+        // Ràng buộc #10 (5 cửa sổ)
+        for (int k = max(0, idx - 4); k <= idx; k++) {
+            int sum = 0;
+            for (int t = 0; t < 5 && k + t < totalShifts; t++) sum += schedule[i * totalShifts + k + t];
+            if (sum >= 2) return false;
+        }
+        return true;
     }
 
     // Khởi tạo greedy
     void greedyInitialize() {
-        schedule.assign(NUM_NURSES * totalShifts, 0);
-        vector<int> nurseCount(NUM_NURSES, 0);
+        schedule.assign(numNurses * totalShifts, 0);
+        vector<int> nurseCount(numNurses, 0);
 
-        // Bước 1: Gán y tá trưởng vào ca sáng (đảm bảo MIN_HEAD mỗi ngày)
-        for (int day = 0; day < NUM_DAYS; day++) {
-            int headIdx = day * NUM_SHIFTS;  // ca sáng của ngày
+        // Bước 1: Gán y tá trưởng vào ca sáng (đảm bảo minHeadPerMorning mỗi ngày)
+        for (int day = 0; day < numDays; day++) {
+            int headIdx = day * numShifts;  // ca sáng của ngày
             int assigned = 0;
             vector<int> shuffled(headNurses);
             shuffle(shuffled.begin(), shuffled.end(), rng);
 
             for (int i : shuffled) {
-                if (assigned >= (int)MIN_HEAD) break;
+                if (assigned >= inst.minHeadPerMorning) break;
+                if (isBlocked(i, headIdx)) continue;
                 int cur = 0;
                 for (int j = 0; j < totalShifts; j++) cur += schedule[i * totalShifts + j];
                 if (cur < (int)nurses[i].maxShift && nurseCount[i] < (int)nurses[i].maxShift) {
@@ -218,40 +360,47 @@ private:
             }
         }
 
+        // Bước 1b (#12): phủ hàng Hall còn thiếu trước, y tá có kỹ năng cũng tính vào nhu cầu #1.
+        // Ưu tiên y tá có ít kỹ năng thừa để dành y tá đa kỹ năng cho hàng khác
+        skillCover = skillCoverOf(schedule);
+        for (size_t r = 0; r < skillRows.size(); r++) {
+            const NSPSkillRow& row = skillRows[r];
+            if (skillCover[r] >= row.required) continue;
+            vector<pair<int, int>> cand;
+            for (int i = 0; i < numNurses; i++) {
+                if (!(nurses[i].skills & row.skills) || !canTake(i, row.shift, nurseCount)) continue;
+                int extra = __builtin_popcount(nurses[i].skills & ~row.skills);
+                cand.emplace_back(extra * totalShifts + nurseCount[i] +
+                                  (inst.isAvoided(i, row.shift) ? totalShifts * NSP_MAX_SKILLS : 0), i);
+            }
+            sort(cand.begin(), cand.end());
+            for (auto& [key, i] : cand) {
+                if (skillCover[r] >= row.required) break;
+                schedule[i * totalShifts + row.shift] = 1;
+                nurseCount[i]++;
+                applySkillMove(i, row.shift, 1);
+            }
+        }
+
         // Bước 2: Gán y tá thường để đủ nhu cầu mỗi ca
-        for (int day = 0; day < NUM_DAYS; day++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
-                int idx = day * NUM_SHIFTS + s;
+        for (int day = 0; day < numDays; day++) {
+            for (int s = 0; s < numShifts; s++) {
+                int idx = day * numShifts + s;
                 int current = 0;
-                for (int i = 0; i < NUM_NURSES; i++) current += schedule[i * totalShifts + idx];
+                for (int i = 0; i < numNurses; i++) current += schedule[i * totalShifts + idx];
 
-                if (current >= (int)DEMAND[s]) continue;
+                if (current >= inst.demandFor(idx)) continue;
 
-                // Ưu tiên y tá có ít ca hơn
-                vector<pair<int, int>> cand;  // (count, nurse_id)
+                // Ưu tiên y tá không muốn tránh ca này, rồi tới y tá có ít ca hơn
+                vector<pair<int, int>> cand;  // (count [+ totalShifts nếu avoid], nurse_id)
                 for (int i : norNurses) {
-                    if (schedule[i * totalShifts + idx]) continue;
-                    if (nurseCount[i] >= (int)nurses[i].maxShift) continue;
-
-                    // Ràng buộc #9
-                    if (idx >= 2 && schedule[i * totalShifts + idx - 2]) continue;
-                    if (idx + 2 < totalShifts && schedule[i * totalShifts + idx + 2]) continue;
-
-                    // Ràng buộc #10 (5 cửa sổ)
-                    bool ok10 = true;
-                    for (int k = max(0, idx - 4); k <= idx && ok10; k++) {
-                        int sum = 0;
-                        for (int t = 0; t < 5 && k + t < totalShifts; t++) sum += schedule[i * totalShifts + k + t];
-                        if (sum >= 2 && k <= idx && idx < k + 5) ok10 = false;
-                    }
-                    if (!ok10) continue;
-
-                    cand.emplace_back(nurseCount[i], i);
+                    if (!canTake(i, idx, nurseCount)) continue;
+                    cand.emplace_back(nurseCount[i] + (inst.isAvoided(i, idx) ? totalShifts : 0), i);
                 }
 
                 sort(cand.begin(), cand.end());
                 for (auto& [cnt, i] : cand) {
-                    if (current >= (int)DEMAND[s]) break;
+                    if (current >= inst.demandFor(idx)) break;
                     schedule[i * totalShifts + idx] = 1;
                     nurseCount[i]++;
                     current++;
@@ -259,21 +408,21 @@ private:
             }
         }
 
-        // Bước 3: Đảm bảo MIN_AFTERNOON cho y tá thường
+        // Bước 3: Đảm bảo minAfternoon cho y tá thường
         for (int i : norNurses) {
             int afternoon = 0;
-            for (int day = 0; day < NUM_DAYS; day++) afternoon += schedule[i * totalShifts + day * NUM_SHIFTS + 1];
-            while (afternoon < (int)MIN_AFTERNOON && nurseCount[i] < (int)nurses[i].maxShift) {
+            for (int day = 0; day < numDays; day++) afternoon += schedule[i * totalShifts + day * numShifts + 1];
+            while (afternoon < inst.minAfternoon && nurseCount[i] < (int)nurses[i].maxShift) {
                 bool done = false;
-                for (int day = 0; day < NUM_DAYS && !done; day++) {
-                    int idx = day * NUM_SHIFTS + 1;
-                    if (schedule[i * totalShifts + idx]) continue;
+                for (int day = 0; day < numDays && !done; day++) {
+                    int idx = day * numShifts + 1;
+                    if (schedule[i * totalShifts + idx] || isBlocked(i, idx)) continue;
                     if (idx >= 2 && schedule[i * totalShifts + idx - 2]) continue;
                     if (idx + 2 < totalShifts && schedule[i * totalShifts + idx + 2]) continue;
 
                     // Swap với ca sáng nếu ca sáng thừa
-                    for (int d = 0; d < NUM_DAYS && !done; d++) {
-                        int sIdx = d * NUM_SHIFTS;  // ca sáng
+                    for (int d = 0; d < numDays && !done; d++) {
+                        int sIdx = d * numShifts;  // ca sáng
                         if (!schedule[i * totalShifts + sIdx]) continue;
 
                         schedule[i * totalShifts + sIdx] = 0;
@@ -291,15 +440,15 @@ private:
             }
         }
 
-        // Bước 4: Đảm bảo MIN_NIGHT cho y tá thường
+        // Bước 4: Đảm bảo minNight cho y tá thường
         for (int i : norNurses) {
             int night = 0;
-            for (int day = 0; day < NUM_DAYS; day++) night += schedule[i * totalShifts + day * NUM_SHIFTS + 2];
-            while (night < (int)MIN_NIGHT && nurseCount[i] < (int)nurses[i].maxShift) {
+            for (int day = 0; day < numDays; day++) night += schedule[i * totalShifts + day * numShifts + 2];
+            while (night < inst.minNight && nurseCount[i] < (int)nurses[i].maxShift) {
                 bool done = false;
-                for (int day = 0; day < NUM_DAYS && !done; day++) {
-                    int idx = day * NUM_SHIFTS + 2;
-                    if (schedule[i * totalShifts + idx]) continue;
+                for (int day = 0; day < numDays && !done; day++) {
+                    int idx = day * numShifts + 2;
+                    if (schedule[i * totalShifts + idx] || isBlocked(i, idx)) continue;
                     if (idx >= 2 && schedule[i * totalShifts + idx - 2]) continue;
                     if (idx + 2 < totalShifts && schedule[i * totalShifts + idx + 2]) continue;
 
@@ -311,19 +460,20 @@ private:
             }
         }
 
-        // Bước 5: Thêm y tá trưởng để đạt MIN_HEAD nếu chưa đủ
-        for (int day = 0; day < NUM_DAYS; day++) {
-            int idx = day * NUM_SHIFTS;
+        // Bước 5: Thêm y tá trưởng để đạt minHeadPerMorning nếu chưa đủ
+        for (int day = 0; day < numDays; day++) {
+            int idx = day * numShifts;
             int headCount = 0;
             for (int i : headNurses) headCount += schedule[i * totalShifts + idx];
-            if (headCount < (int)MIN_HEAD) {
+            if (headCount < inst.minHeadPerMorning) {
                 vector<int> shuffled(headNurses);
                 shuffle(shuffled.begin(), shuffled.end(), rng);
                 for (int i : shuffled) {
-                    if (headCount >= (int)MIN_HEAD) break;
+                    if (headCount >= inst.minHeadPerMorning) break;
                     int cur = 0;
                     for (int j = 0; j < totalShifts; j++) cur += schedule[i * totalShifts + j];
-                    if (cur < (int)nurses[i].maxShift && !schedule[i * totalShifts + idx]) {
+                    if (cur < (int)nurses[i].maxShift && !schedule[i * totalShifts + idx] &&
+                        !isBlocked(i, idx)) {
                         schedule[i * totalShifts + idx] = 1;
                         headCount++;
                     }
@@ -332,95 +482,174 @@ private:
         }
     }
 
-    // Local Search
-    void localSearch(int maxIterations) {
+    // Local Search: nhận bước giảm vi phạm, hoặc giữ nguyên vi phạm mà bớt ô avoid.
+    // Có kịch bản nhu cầu: giữ nguyên vi phạm thì nhận bước giảm chi phí trung bình mẫu
+    // (ca làm + phạt avoid + costShortfall x thiếu hụt kỳ vọng).
+    // Không bao giờ gán vào ô blocked; số ô avoid, độ phủ #12 và độ phủ theo ca cập nhật theo
+    // chênh lệch của 1-2 ô đổi
+    // Bắt đầu từ vòng startIter (resume): mọi trạng thái khác tính lại từ schedule
+    void localSearch(int maxIterations, int startIter = 0) {
         vector<char> bestSchedule = schedule;
         int bestViolations = countViolations();
+        long avoided = countAvoided(schedule);
+        skillCover = skillCoverOf(schedule);
+        int skillViolations = skillPenalty(skillCover);
+        bool robust = scenarios && scenarios->numScenarios > 0;
+        if (robust) {
+            shiftCover.assign(totalShifts, 0);
+            for (int i = 0; i < numNurses; i++) {
+                for (int j = 0; j < totalShifts; j++) shiftCover[j] += schedule[i * totalShifts + j];
+            }
+        }
         double bestCost = calculateCost();
+        auto searchStart = chrono::high_resolution_clock::now();
+        int reported = bestViolations;
+        // Pool: lịch được chấp nhận gửi vào pool mỗi 256 vòng (các bước nhỏ liên tiếp cách nhau
+        // vài ô, pool chỉ giữ bản cuối nên không cần gửi từng bước), và khi kết thúc
+        bool offerPending = pool != nullptr;
+        auto lastCheckpoint = searchStart;
+
+        for (int iter = startIter; iter < maxIterations; iter++) {
+            // Checkpoint ở đầu vòng (trước khi rút số ngẫu nhiên), kiểm đồng hồ mỗi 1000 vòng
+            if (checkpoint && iter % 1000 == 0 && iter > startIter) {
+                auto now = chrono::high_resolution_clock::now();
+                if (chrono::duration<double>(now - lastCheckpoint).count() >= checkpointIntervalSec) {
+                    lastCheckpoint = now;
+                    double ms = chrono::duration<double, milli>(now - searchStart).count();
+                    checkpoint->submit(checkpointBytes(iter, solveMsDone + ms));
+                }
+            }
+            if (offerPending && iter % 256 == 0) {
+                pool->offerCells(schedule, bestViolations, bestCost);
+                offerPending = false;
+            }
+            // Báo tiến độ khi số vi phạm giảm (tối đa một lần mỗi 1000 vòng)
+            if (progress && iter % 1000 == 0 && bestViolations < reported) {
+                reported = bestViolations;
+                double t = chrono::duration<double, milli>(
+                    chrono::high_resolution_clock::now() - searchStart).count();
+                if (!progress(t, bestCost)) break;
+            }
 
-        for (int iter = 0; iter < maxIterations; iter++) {
-            int nurse = uniform_int_distribution<int>(0, NUM_NURSES - 1)(rng);
+            int nurse = uniform_int_distribution<int>(0, numNurses - 1)(rng);
             int shift1 = uniform_int_distribution<int>(0, totalShifts - 1)(rng);
             int shift2 = uniform_int_distribution<int>(0, totalShifts - 1)(rng);
 
             if (shift1 == shift2) continue;
+            char v1 = schedule[nurse * totalShifts + shift1], v2 = schedule[nurse * totalShifts + shift2];
 
             // Thử swap
-            vector<char> newSched = schedule;
-            swap(newSched[nurse * totalShifts + shift1], newSched[nurse * totalShifts + shift2]);
-
-            int newV = countViolationsWithSchedule(newSched);
-            if (newV < bestViolations) {
-                schedule = newSched;
-                bestSchedule = newSched;
-                bestViolations = newV;
-                bestCost = calculateCostFromSchedule(newSched);
+            if (v1 != v2 && !isBlocked(nurse, v1 ? shift2 : shift1)) {
+                vector<char> newSched = schedule;
+                swap(newSched[nurse * totalShifts + shift1], newSched[nurse * totalShifts + shift2]);
+                int delta = avoidDelta(nurse, shift1, v1, v2) + avoidDelta(nurse, shift2, v2, v1);
+                int skill = skillDelta(nurse, shift1, v2 - v1) + skillDelta(nurse, shift2, v1 - v2);
+                int newV = countViolationsWithSchedule(newSched) + skillViolations + skill;
+                bool cheaper = delta < 0;
+                if (robust) {
+                    cheaper = delta * inst.costPreference + scenarioDelta(shift1, v2 - v1) +
+                              scenarioDelta(shift2, v1 - v2) < -1e-9;
+                }
+                if (newV < bestViolations || (newV == bestViolations && cheaper)) {
+                    schedule = newSched;
+                    bestSchedule = newSched;
+                    bestViolations = newV;
+                    avoided += delta;
+                    applySkillMove(nurse, shift1, v2 - v1);
+                    applySkillMove(nurse, shift2, v1 - v2);
+                    skillViolations += skill;
+                    if (robust) {
+                        shiftCover[shift1] += v2 - v1;
+                        shiftCover[shift2] += v1 - v2;
+                    }
+                    bestCost = calculateCostFromSchedule(newSched) + avoided * inst.costPreference;
+                    offerPending = pool != nullptr;
+                    v1 = schedule[nurse * totalShifts + shift1];
+                }
             }
 
             // Thử flip
-            newSched = schedule;
-            newSched[nurse * totalShifts + shift1] ^= 1;
-            newV = countViolationsWithSchedule(newSched);
-            if (newV < bestViolations) {
-                schedule = newSched;
-                bestSchedule = newSched;
-                bestViolations = newV;
-                bestCost = calculateCostFromSchedule(newSched);
+            if (v1 || !isBlocked(nurse, shift1)) {
+                vector<char> newSched = schedule;
+                newSched[nurse * totalShifts + shift1] ^= 1;
+                int delta = avoidDelta(nurse, shift1, v1, v1 ^ 1);
+                int skill = skillDelta(nurse, shift1, v1 ? -1 : 1);
+                int newV = countViolationsWithSchedule(newSched) + skillViolations + skill;
+                bool cheaper = delta < 0;
+                if (robust) {
+                    int change = v1 ? -1 : 1;
+                    cheaper = delta * inst.costPreference + staffDelta(nurse, change) +
+                              scenarioDelta(shift1, change) < -1e-9;
+                }
+                if (newV < bestViolations || (newV == bestViolations && cheaper)) {
+                    if (robust) shiftCover[shift1] += v1 ? -1 : 1;
+                    schedule = newSched;
+                    bestSchedule = newSched;
+                    bestViolations = newV;
+                    avoided += delta;
+                    applySkillMove(nurse, shift1, v1 ? -1 : 1);
+                    skillViolations += skill;
+                    bestCost = calculateCostFromSchedule(newSched) + avoided * inst.costPreference;
+                    offerPending = pool != nullptr;
+                }
             }
         }
 
         schedule = bestSchedule;
+        if (offerPending) pool->offerCells(schedule, bestViolations, bestCost);
     }
 
-    // Count violations với schedule cho trước
+    // Count violations với schedule cho trước (trừ #12, local search cộng phần đó theo skillCover)
     int countViolationsWithSchedule(const vector<char>& sched) const {
         int violations = 0;
 
-        for (int day = 0; day < NUM_DAYS; day++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
-                int idx = day * NUM_SHIFTS + s;
+        for (int day = 0; day < numDays; day++) {
+            for (int s = 0; s < numShifts; s++) {
+                int idx = day * numShifts + s;
                 int count = 0;
-                for (int i = 0; i < NUM_NURSES; i++) count += sched[i * totalShifts + idx];
-                if (count < (int)DEMAND[s]) violations += ((int)DEMAND[s] - count) * 10;
+                for (int i = 0; i < numNurses; i++) count += sched[i * totalShifts + idx];
+                if (count < inst.demandFor(idx)) violations += (inst.demandFor(idx) - count) * 10;
             }
         }
 
-        for (int i = 0; i < NUM_NURSES; i++) {
+        for (int i = 0; i < numNurses; i++) {
             int total = 0;
             for (int j = 0; j < totalShifts; j++) total += sched[i * totalShifts + j];
             if (total < (int)nurses[i].minShift) violations += ((int)nurses[i].minShift - total) * 5;
             if (total > (int)nurses[i].maxShift) violations += (total - (int)nurses[i].maxShift) * 5;
         }
 
+        violations += unavailableAssigned(sched) * 10;
+
         for (int i : norNurses) {
             int afternoon = 0;
-            for (int day = 0; day < NUM_DAYS; day++) afternoon += sched[i * totalShifts + day * NUM_SHIFTS + 1];
-            if (afternoon < (int)MIN_AFTERNOON) violations += ((int)MIN_AFTERNOON - afternoon) * 3;
+            for (int day = 0; day < numDays; day++) afternoon += sched[i * totalShifts + day * numShifts + 1];
+            if (afternoon < inst.minAfternoon) violations += (inst.minAfternoon - afternoon) * 3;
         }
 
         for (int i : norNurses) {
             int night = 0;
-            for (int day = 0; day < NUM_DAYS; day++) night += sched[i * totalShifts + day * NUM_SHIFTS + 2];
-            if (night < (int)MIN_NIGHT) violations += ((int)MIN_NIGHT - night) * 3;
+            for (int day = 0; day < numDays; day++) night += sched[i * totalShifts + day * numShifts + 2];
+            if (night < inst.minNight) violations += (inst.minNight - night) * 3;
         }
 
         for (int i : headNurses) {
-            for (int day = 0; day < NUM_DAYS; day++) {
-                violations += sched[i * totalShifts + day * NUM_SHIFTS + 1] * 10;
-                violations += sched[i * totalShifts + day * NUM_SHIFTS + 2] * 10;
+            for (int day = 0; day < numDays; day++) {
+                violations += sched[i * totalShifts + day * numShifts + 1] * 10;
+                violations += sched[i * totalShifts + day * numShifts + 2] * 10;
             }
         }
 
-        for (int day = 0; day < NUM_DAYS; day++) {
+        for (int day = 0; day < numDays; day++) {
             int headCount = 0;
-            int idx = day * NUM_SHIFTS;
+            int idx = day * numShifts;
             for (int i : headNurses) headCount += sched[i * totalShifts + idx];
-            if (headCount < (int)MIN_HEAD) violations += ((int)MIN_HEAD - headCount) * 3;
+            if (headCount < inst.minHeadPerMorning) violations += (inst.minHeadPerMorning - headCount) * 3;
         }
 
-        for (int day = 0; day < NUM_DAYS; day++) {
-            for (int s = 0; s < NUM_SHIFTS; s++) {
-                int idx = day * NUM_SHIFTS + s;
+        for (int day = 0; day < numDays; day++) {
+            for (int s = 0; s < numShifts; s++) {
+                int idx = day * numShifts + s;
                 int femaleCount = 0;
                 for (int i : femaleNurses) femaleCount += sched[i * totalShifts + idx];
                 if (femaleCount < 1) violations += 5;
@@ -446,75 +675,320 @@ private:
 
     double calculateCostFromSchedule(const vector<char>& sched) const {
         double cost = 0.0;
-        for (int i = 0; i < NUM_NURSES; i++) {
+        for (int i = 0; i < numNurses; i++) {
             int total = 0;
             for (int j = 0; j < totalShifts; j++) total += sched[i * totalShifts + j];
             if (nurses[i].isHead) {
-                cost += total * COST_HEAD;
+                cost += total * inst.costHead;
             } else {
-                cost += total * COST_NORMAL;
+                cost += total * inst.costNormal;
                 if (total > (int)nurses[i].minShift) {
-                    cost += (total - (int)nurses[i].minShift) * (COST_OVER - COST_NORMAL);
+                    cost += (total - (int)nurses[i].minShift) * (inst.costOvertime - inst.costNormal);
                 }
             }
         }
         return cost;
     }
 
+    // Phần riêng của heuristic sau phần đầu NSPK:
+    //   int32 run, restarts, nextIter (-1 = lần chạy run chưa bắt đầu), maxIterations,
+    //   double buildMs, solveMs, uint8 hasBest, [int32 violations, double cost, lịch tốt nhất],
+    //   string trạng thái mt19937 (dạng text của operator<<), lịch hiện tại
+    string checkpointBytes(int nextIter, double solveMs) const {
+        NSPByteWriter w;
+        addCheckpointHeader(w, NSP_CHECKPOINT_HEURISTIC, instanceFingerprint(inst), numNurses, totalShifts);
+        w.add((int32_t)currentRun);
+        w.add((int32_t)restarts);
+        w.add((int32_t)nextIter);
+        w.add((int32_t)maxIterations);
+        w.add(buildMsDone);
+        w.add(solveMs);
+        w.add((uint8_t)hasBestRun);
+        if (hasBestRun) {
+            w.add((int32_t)bestRun.violations);
+            w.add(bestRun.totalCost);
+            w.addCells(bestRunSchedule, numNurses, totalShifts);
+        }
+        ostringstream state;
+        state << rng;
+        w.addString(state.str());
+        w.addCells(schedule, numNurses, totalShifts);
+        return w.out;
+    }
+
 public:
-    NSPSolver() {
-        totalShifts = NUM_DAYS * NUM_SHIFTS;
+    bool verbose = true;                      // In log ra cout (tắt khi dùng làm backend)
+    function<bool(double, double)> progress;  // (ms local search, chi phí); false = dừng
+    const NSPScenarioSet* scenarios = nullptr; // kịch bản nhu cầu cho local search, không sở hữu
+    NSPSolutionPool* pool = nullptr;           // nhận lịch local search chấp nhận, không sở hữu
+    int restarts = 1;                          // số lần chạy greedy + local search, giữ lần tốt nhất
+    int maxIterations = 50000;                 // số vòng local search mỗi lần chạy
+    NSPCheckpointWriter* checkpoint = nullptr; // nhận checkpoint định kỳ, không sở hữu
+    double checkpointIntervalSec = 30;
+
+    explicit NSPSolver(const NSPInstance& instance)
+        : inst(instance), nurses(inst.nurses) {
+        numNurses = nurses.size();
+        numDays = inst.numDays;
+        numShifts = inst.shiftsPerDay;
+        totalShifts = numDays * numShifts;
         rng.seed(chrono::steady_clock::now().time_since_epoch().count());
 
-        // Xây dựng dữ liệu y tá
-        for (int i = 0; i < NUM_HEAD_NUR; i++) {
-            nurses.push_back({i, true, true, 5.0, 9.0});
-        }
-        for (int i = 0; i < NUM_NURSES - NUM_HEAD_NUR; i++) {
-            nurses.push_back({i + NUM_HEAD_NUR, false, i >= 664, 6.0, 9.0});
+        maskWords = inst.maskWords();
+        blocked = inst.unavailable;
+        blocked.resize((size_t)numNurses * maskWords, 0);
+        for (int i = 0; i < numNurses; i++) {
+            if (!nurses[i].isHead) continue;
+            for (int j = 0; j < totalShifts; j++) {
+                if (j % numShifts != 0) blocked[(size_t)i * maskWords + j / 64] |= uint64_t(1) << (j % 64);
+            }
         }
 
+        skillRows = skillCoverageRows(inst);
+        skillRowStart.assign(totalShifts + 1, 0);
+        for (const NSPSkillRow& row : skillRows) skillRowStart[row.shift + 1]++;
+        for (int j = 0; j < totalShifts; j++) skillRowStart[j + 1] += skillRowStart[j];
+
         // Phân loại y tá
-        for (int i = 0; i < NUM_NURSES; i++) {
+        for (int i = 0; i < numNurses; i++) {
             if (nurses[i].isHead) headNurses.push_back(i);
             else norNurses.push_back(i);
             if (nurses[i].isFemale) femaleNurses.push_back(i);
         }
     }
 
-    NSPSolution solve() {
-        NSPSolution sol;
-        sol.feasible = false;
-        sol.totalCost = 0;
-        sol.violations = 0;
+    void seed(uint64_t value) { rng.seed(value); }
+
+    // Nạp checkpoint của checkpointBytes; solve() sau đó chạy tiếp từ đúng vòng đã lưu
+    bool resumeFrom(const string& bytes, string& error) {
+        NSPByteReader r(bytes);
+        if (!readCheckpointHeader(r, NSP_CHECKPOINT_HEURISTIC, instanceFingerprint(inst), numNurses,
+                                  totalShifts, error)) {
+            return false;
+        }
+        int32_t run, runs, nextIter, iterations, bestViolations = 0;
+        double buildMs, solveMs, bestCost = 0;
+        uint8_t hasBest;
+        vector<char> best, current;
+        string state;
+        bool ok = r.get(run) && r.get(runs) && r.get(nextIter) && r.get(iterations) && r.get(buildMs) &&
+                  r.get(solveMs) && r.get(hasBest);
+        if (ok && hasBest) {
+            ok = r.get(bestViolations) && r.get(bestCost) && r.getCells(best, numNurses, totalShifts);
+        }
+        ok = ok && r.getString(state) && r.getCells(current, numNurses, totalShifts) && r.done();
+        if (!ok || run < 0 || run > runs || (run < runs && nextIter > iterations) ||
+            (run == runs && !hasBest)) {
+            error = "truncated or corrupt checkpoint";
+            return false;
+        }
+        istringstream in(state);
+        in >> rng;
+        if (in.fail()) {
+            error = "corrupt RNG state in checkpoint";
+            return false;
+        }
+        currentRun = run;
+        restarts = runs;
+        resumeIter = nextIter;
+        maxIterations = iterations;
+        buildMsDone = buildMs;
+        solveMsDone = solveMs;
+        resumePending = true;
+        hasBestRun = hasBest;
+        bestRun = NSPSolution();
+        bestRun.violations = bestViolations;
+        bestRun.totalCost = bestCost;
+        bestRunSchedule = std::move(best);
+        schedule = std::move(current);
+        return true;
+    }
 
-        auto buildStart = chrono::high_resolution_clock::now();
+    int runIndex() const { return currentRun; }
+    int resumeIteration() const { return resumeIter; }
+
+    // restarts lần (greedy ngẫu nhiên + local search), giữ lần ít vi phạm rồi rẻ nhất;
+    // thời gian là tổng qua mọi lần chạy
+    NSPSolution solve() {
+        if (!resumePending) {
+            currentRun = 0;
+            hasBestRun = false;
+            buildMsDone = solveMsDone = 0;
+        }
+        int firstRun = currentRun;
+        for (int run = firstRun; run < restarts; run++) {
+            currentRun = run;
+            int startIter = 0;
+            if (resumePending && resumeIter >= 0) {
+                startIter = resumeIter;   // schedule và rng đã nạp từ checkpoint
+            } else {
+                auto buildStart = chrono::high_resolution_clock::now();
+                greedyInitialize();
+                buildMsDone += chrono::duration<double, milli>(
+                    chrono::high_resolution_clock::now() - buildStart).count();
+            }
+            resumePending = false;
+            resumeIter = -1;
+
+            if (verbose) cout << "  Violations after greedy: " << countViolations() << endl;
+
+            auto solveStart = chrono::high_resolution_clock::now();
+            localSearch(maxIterations, startIter);
+            solveMsDone += chrono::duration<double, milli>(
+                chrono::high_resolution_clock::now() - solveStart).count();
+
+            int violations = countViolations();
+            double cost = calculateCost();
+            if (!hasBestRun || violations < bestRun.violations ||
+                (violations == bestRun.violations && cost < bestRun.totalCost)) {
+                hasBestRun = true;
+                bestRun.violations = violations;
+                bestRun.totalCost = cost;
+                bestRunSchedule = schedule;
+            }
+        }
+        currentRun = restarts;
+        resumePending = false;
 
-        greedyInitialize();
+        schedule = bestRunSchedule;
+        NSPSolution sol;
+        sol.buildTimeMs = buildMsDone;
+        sol.solveTimeMs = solveMsDone;
+        sol.violations  = countViolations();
+        sol.feasible    = (sol.violations == 0);
+        sol.totalCost   = calculateCost();
+        // Checkpoint cuối: resume từ file này trả lại ngay kết quả
+        if (checkpoint) checkpoint->submit(checkpointBytes(-1, solveMsDone));
+        return sol;
+    }
 
-        auto buildEnd = chrono::high_resolution_clock::now();
-        auto solveStart = buildEnd;
+    const vector<char>& getSchedule() const { return schedule; }
+};
 
-        int initViol = countViolations();
-        cout << "  Violations after greedy: " << initViol << endl;
+} // namespace nsp_heuristic
 
-        localSearch(50000);
+// ==================== BACKEND ====================
 
-        auto solveEnd = chrono::high_resolution_clock::now();
+class HeuristicBackend : public NSPBackend {
+    unique_ptr<nsp_heuristic::NSPSolver> solver;
+    NSPBackendResult result;
+    NSPBackendStats runStats;
 
-        sol.buildTimeMs    = chrono::duration<double, milli>(buildEnd - buildStart).count();
-        sol.solveTimeMs    = chrono::duration<double, milli>(solveEnd - solveStart).count();
-        sol.violations     = countViolations();
-        sol.feasible       = (sol.violations == 0);
-        sol.totalCost      = calculateCost();
+public:
+    const char* name() const override { return "heuristic"; }
+
+    bool build(const NSPInstance& instance) override {
+        if (instance.shiftsPerDay != 3) return false;   // luật ca chiều/đêm gắn với ca 1, 2
+        solver.reset(new nsp_heuristic::NSPSolver(instance));
+        solver->verbose = false;
+        runStats = NSPBackendStats();
+        runStats.numVariables = (long)instance.nurses.size() * instance.totalShifts();
+        return true;
+    }
 
-        return sol;
+    // Heuristic chạy số vòng local search cố định, không dùng giới hạn thời gian
+    bool solve(double /*timeLimitSec*/) override {
+        solver->progress = progress;
+        nsp_heuristic::NSPSolution sol = solver->solve();
+        result.feasible = sol.feasible;
+        result.optimal = false;
+        result.cost = sol.totalCost;
+        result.schedule = solver->getSchedule();
+        runStats.buildMs = sol.buildTimeMs;
+        runStats.solveMs = sol.solveTimeMs;
+        runStats.status = sol.feasible ? "FEASIBLE" : "HEURISTIC";
+        return true;
     }
+
+    const NSPBackendResult& solution() const override { return result; }
+    const NSPBackendStats& stats() const override { return runStats; }
 };
 
+unique_ptr<NSPBackend> makeHeuristicBackend() {
+    return unique_ptr<NSPBackend>(new HeuristicBackend());
+}
+
 // ==================== MAIN ====================
 
-int main() {
+#ifndef NSP_BACKEND_ONLY
+// offers lịch ngẫu nhiên, chi phí giảm dần nên lịch nào cũng qua admits(). Hai lịch ngẫu nhiên
+// cách nhau ~N·T/2 ô, nên index chỉ được đưa vài ứng viên mỗi offer; quét cả pool (khối trùng
+// hash ở mọi lịch) cho ~offers × K lần so khoảng cách. Chạy trên instance nhỏ 46 × 21 (mỗi hàng
+// 43 bit thừa, khối ngắn) và trên kích thước của instance
+int poolSelfTest(const NSPInstance& inst, int offers, int poolSize, int poolDistance) {
+    int K = poolSize > 0 ? poolSize : 20;
+    long limit = (long)offers * K / 4;
+    bool pass = true;
+    int shapes[2][2] = {{46, 21}, {(int)inst.nurses.size(), inst.totalShifts()}};
+    for (auto& shape : shapes) {
+        NSPSolutionPool pool(K, poolDistance, shape[0], shape[1]);
+        mt19937_64 rng(42);
+        vector<char> cells((size_t)shape[0] * shape[1]);
+        for (int k = 0; k < offers; k++) {
+            for (char& c : cells) c = rng() & 1;
+            pool.offerCells(cells, 0, offers - k);
+        }
+        cout << "  " << shape[0] << " x " << shape[1] << ": offered " << pool.offered()
+             << ", distance checks " << pool.distanceChecks() << endl;
+        if (pool.distanceChecks() >= limit) pass = false;
+    }
+    cout << "POOL_CHECK_LIMIT=" << limit << endl;
+    cout << "POOL_SELFTEST=" << (pass ? "PASS" : "FAIL") << endl;
+    return pass ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    using namespace nsp_heuristic;
+    NSPInstance inst = makeReferenceInstance();
+
+    NSPScenarioOptions scenarioOpt;
+    scenarioOpt.numScenarios = 0;
+    int restarts = 1, poolSize = 0, poolDistance = 100, poolSelfTestOffers = 0;
+    string poolOut, checkpointFile, resumeFile;
+    double checkpointInterval = 30;
+    bool seeded = false;
+    uint64_t seed = 0;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--scenarios" && a + 1 < argc) {
+            scenarioOpt.numScenarios = atoi(argv[++a]);
+        } else if (arg == "--demand-noise" && a + 1 < argc) {
+            scenarioOpt.shiftNoise = atof(argv[++a]);
+        } else if (arg == "--day-noise" && a + 1 < argc) {
+            scenarioOpt.dayNoise = atof(argv[++a]);
+        } else if (arg == "--shortfall-cost" && a + 1 < argc) {
+            scenarioOpt.costShortfall = atof(argv[++a]);
+        } else if (arg == "--scenario-seed" && a + 1 < argc) {
+            scenarioOpt.seed = strtoull(argv[++a], nullptr, 10);
+        } else if (arg == "--restarts" && a + 1 < argc) {
+            restarts = max(1, atoi(argv[++a]));
+        } else if (arg == "--pool" && a + 1 < argc) {
+            poolSize = atoi(argv[++a]);
+        } else if (arg == "--pool-distance" && a + 1 < argc) {
+            poolDistance = atoi(argv[++a]);
+        } else if (arg == "--pool-out" && a + 1 < argc) {
+            poolOut = argv[++a];
+        } else if (arg == "--pool-selftest" && a + 1 < argc) {
+            poolSelfTestOffers = max(1, atoi(argv[++a]));
+        } else if (arg == "--seed" && a + 1 < argc) {
+            seed = strtoull(argv[++a], nullptr, 10);
+            seeded = true;
+        } else if (arg == "--checkpoint" && a + 1 < argc) {
+            checkpointFile = argv[++a];
+        } else if (arg == "--checkpoint-interval" && a + 1 < argc) {
+            checkpointInterval = atof(argv[++a]);
+        } else if (arg == "--resume" && a + 1 < argc) {
+            resumeFile = argv[++a];
+        } else {
+            cerr << "Usage: " << argv[0] << " [--scenarios N] [--demand-noise X] [--day-noise X]"
+                 << " [--shortfall-cost C] [--scenario-seed N] [--restarts R] [--pool K]"
+                 << " [--pool-distance D] [--pool-out PREFIX] [--seed N] [--checkpoint FILE]"
+                 << " [--checkpoint-interval S] [--resume FILE] [--pool-selftest N]" << endl;
+            return 1;
+        }
+    }
+    if (poolSelfTestOffers > 0) return poolSelfTest(inst, poolSelfTestOffers, poolSize, poolDistance);
+
     cout << R"(
 ╔════════════════════════════════════════════════════════════╗
 ║     NSP - Standalone C++ (No External Solver)             ║
@@ -522,13 +996,53 @@ int main() {
 ╚════════════════════════════════════════════════════════════╝
 )" << endl;
 
-    cout << "Data: " << NUM_NURSES << " nurses, " << NUM_DAYS << " days, "
-         << NUM_SHIFTS << " shifts" << endl;
-    cout << "Variables: " << NUM_NURSES * NUM_DAYS * NUM_SHIFTS << endl;
+    cout << "Data: " << inst.nurses.size() << " nurses, " << inst.numDays << " days, "
+         << inst.shiftsPerDay << " shifts" << endl;
+    cout << "Variables: " << inst.nurses.size() * inst.totalShifts() << endl;
     cout << "Running...\n" << endl;
 
-    NSPSolver solver;
+    NSPSolver solver(inst);
+    NSPScenarioSet scenarios;
+    if (scenarioOpt.numScenarios > 0) {
+        scenarios = sampleDemandScenarios(inst, scenarioOpt);
+        solver.scenarios = &scenarios;
+        cout << "Scenarios: " << scenarios.numScenarios << " (noise " << scenarioOpt.shiftNoise
+             << ", day noise " << scenarioOpt.dayNoise << ")\n" << endl;
+    }
+    NSPSolutionPool pool(poolSize, poolDistance, inst.nurses.size(), inst.totalShifts());
+    if (poolSize > 0) solver.pool = &pool;
+    solver.restarts = restarts;
+    if (seeded) solver.seed(seed);
+
+    // Resume: số lần chạy, số vòng, RNG lấy từ checkpoint; ghi tiếp vào cùng file nếu không
+    // có --checkpoint khác (pool và kịch bản không nằm trong checkpoint, tạo lại từ tham số)
+    if (!resumeFile.empty()) {
+        string bytes, error;
+        if (!readCheckpointFile(resumeFile, bytes)) {
+            cerr << "Cannot read " << resumeFile << endl;
+            return 1;
+        }
+        if (!solver.resumeFrom(bytes, error)) {
+            cerr << resumeFile << ": " << error << endl;
+            return 1;
+        }
+        if (checkpointFile.empty()) checkpointFile = resumeFile;
+        if (solver.runIndex() >= solver.restarts) {
+            cout << "Resumed: all " << solver.restarts << " runs completed\n" << endl;
+        } else {
+            cout << "Resumed: run " << solver.runIndex() + 1 << "/" << solver.restarts << ", iteration "
+                 << solver.resumeIteration() << "\n" << endl;
+        }
+    }
+    unique_ptr<NSPCheckpointWriter> checkpoint;
+    if (!checkpointFile.empty()) {
+        checkpoint.reset(new NSPCheckpointWriter(checkpointFile));
+        solver.checkpoint = checkpoint.get();
+        solver.checkpointIntervalSec = checkpointInterval;
+    }
+
     NSPSolution sol = solver.solve();
+    const vector<char>& bestSchedule = solver.getSchedule();
 
     cout << "\n--- RESULTS ---" << endl;
     if (sol.feasible) {
@@ -540,6 +1054,51 @@ int main() {
     cout << "SOLVE_MS=" << fixed << setprecision(2) << sol.solveTimeMs << endl;
     cout << "TOTAL_MS=" << fixed << setprecision(2) << (sol.buildTimeMs + sol.solveTimeMs) << endl;
     cout << "TOTAL_COST=" << fixed << setprecision(0) << sol.totalCost << endl;
+    if (checkpoint) {
+        checkpoint->flush();
+        cout << "CHECKPOINT_WRITES=" << checkpoint->written() << endl;
+        if (checkpoint->failed() > 0) {
+            cerr << "Cannot write checkpoint " << checkpoint->path() << endl;
+            return 1;
+        }
+    }
+    if (scenarios.numScenarios > 0) {
+        const vector<char>& sched = bestSchedule;
+        int T = inst.totalShifts();
+        vector<int> cover(T, 0);
+        for (size_t k = 0; k < sched.size(); k++) cover[k % T] += sched[k];
+        auto start = chrono::high_resolution_clock::now();
+        NSPScenarioReport r = evaluateScenarios(scenarios, cover, sol.totalCost);
+        double ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        cout << "SERVICE_LEVEL=" << setprecision(4) << r.serviceLevel << endl;
+        cout << "MEAN_SHORTFALL=" << r.meanShortfall << endl;
+        cout << "EXPECTED_COST=" << setprecision(0) << r.expectedCost << endl;
+        cout << "P95_COST=" << r.p95Cost << endl;
+        cout << "SCENARIO_MS=" << setprecision(2) << ms << endl;
+    }
+    if (poolSize > 0) {
+        vector<const NSPPoolEntry*> ranked = pool.ranked();
+        cout << "\n--- POOL ---" << endl;
+        for (size_t k = 0; k < ranked.size(); k++) {
+            cout << "  #" << k + 1 << " cost " << setprecision(0) << ranked[k]->cost << ", violations "
+                 << ranked[k]->violations << ", distance to #1 "
+                 << pool.distance(ranked[0]->words.data(), ranked[k]->words.data()) << endl;
+        }
+        cout << "POOL_SIZE=" << pool.size() << endl;
+        cout << "POOL_MIN_DISTANCE=" << pool.minPairDistance() << endl;
+        cout << "POOL_OFFERED=" << pool.offered() << endl;
+        cout << "POOL_ACCEPTED=" << pool.accepted() << endl;
+        cout << "POOL_DISTANCE_CHECKS=" << pool.distanceChecks() << endl;
+        if (!poolOut.empty()) {
+            int written = pool.exportBinary(poolOut, inst.shiftsPerDay);
+            if (written < 0) {
+                cerr << "Cannot write " << poolOut << ".*.bin" << endl;
+                return 1;
+            }
+            cout << "POOL_FILES=" << written << endl;
+        }
+    }
 
     return 0;
 }
+#endif
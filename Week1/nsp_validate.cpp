@@ -0,0 +1,336 @@
+/**
+ * Nurse Scheduling Problem (NSP) - CLI kiểm tra lịch trước khi công bố
+ * Đọc instance + lịch của bất kỳ backend nào, chấm lại #1-#12 và chi phí bằng nsp_validate.h,
+ * không cần giải lại model.
+ * Compile: g++ -O3 -march=native -std=c++17 -pthread nsp_validate.cpp -o nsp_validate
+ *
+ * Chạy:    ./nsp_validate --instance ward7.txt --schedule ward7.bin
+ *          ./nsp_validate --reference 1983 --schedule run.csv --cost 2968800
+ *          ./nsp_validate --reference 1000000 --random 1     (đo tốc độ với lịch ngẫu nhiên)
+ *          ./nsp_validate --instance w.nspi --schedule w.bin --scenarios 10000 --demand-noise 0.15
+ *                                       (độ bền của lịch trên 10k kịch bản nhu cầu, nsp_scenario.h)
+ *
+ * Instance: --reference N[,H] (makeReferenceInstance), --instance FILE.nspi (nsp_gen) hoặc
+ *           --instance FILE cùng định dạng text với nsp --instance (readInstanceText của
+ *           nsp_backend.h: cùng khóa, cùng giá trị mặc định; rule / base không thuộc NSPInstance
+ *           nên bị từ chối).
+ * Lịch:     file NSPB của --export-bin / libnsp, hoặc CSV của --export-csv (nhận theo nội dung).
+ * Exit:     0 = hợp lệ, 2 = có vi phạm hoặc chi phí lệch, 1 = lỗi đầu vào.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "nsp_validate.h"
+#include "nsp_scenario.h"
+
+using namespace std;
+
+// ==================== ĐỌC LỊCH ====================
+
+bool readFileBytes(const string& path, string& data) {
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    in.seekg(0, ios::end);
+    data.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(&data[0], data.size());
+    return bool(in);
+}
+
+// NSPB: char[4], uint32 version, numNurses, numShifts, shiftsPerDay, wordsPerRow, double cost, rows
+bool parseBinary(const string& data, const NSPInstance& inst, PackedSchedule& sched,
+                 double& fileCost, string& error) {
+    const size_t headerBytes = 6 * sizeof(uint32_t) + sizeof(double);
+    if (data.size() < headerBytes) {
+        error = "truncated NSPB header";
+        return false;
+    }
+    uint32_t header[6];
+    memcpy(header, data.data(), sizeof(header));
+    memcpy(&fileCost, data.data() + sizeof(header), sizeof(double));
+    if (header[1] != 1) {
+        error = "unsupported NSPB version " + to_string(header[1]);
+        return false;
+    }
+    if ((int)header[2] != (int)inst.nurses.size() || (int)header[3] != inst.totalShifts() ||
+        (int)header[4] != inst.shiftsPerDay) {
+        error = "schedule is " + to_string(header[2]) + " nurses x " + to_string(header[3]) +
+                " shifts, instance is " + to_string(inst.nurses.size()) + " x " +
+                to_string(inst.totalShifts());
+        return false;
+    }
+    sched.reset(header[2], header[3]);
+    if ((int)header[5] != sched.wordsPerRow ||
+        data.size() != headerBytes + sched.words.size() * sizeof(uint64_t)) {
+        error = "NSPB body size does not match header";
+        return false;
+    }
+    if (!sched.words.empty()) {
+        memcpy(sched.words.data(), data.data() + headerBytes, sched.words.size() * sizeof(uint64_t));
+    }
+    // Bit thừa sau ca cuối phải bằng 0, nếu không file hỏng hoặc sai bố cục
+    int tail = sched.totalShifts % 64;
+    if (tail) {
+        uint64_t extra = ~((uint64_t(1) << tail) - 1);
+        for (int i = 0; i < sched.numNurses; i++) {
+            if (sched.row(i)[sched.wordsPerRow - 1] & extra) {
+                error = "nurse " + to_string(i) + " has bits past the last shift";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// CSV: nurse,s0,...,s{T-1}[,total]; hàng theo đúng thứ tự y tá của instance
+bool parseCsv(const string& data, const NSPInstance& inst, PackedSchedule& sched, string& error) {
+    int T = inst.totalShifts();
+    sched.reset(inst.nurses.size(), T);
+    size_t pos = data.find('\n');
+    if (pos == string::npos) {
+        error = "CSV has no header line";
+        return false;
+    }
+    pos++;
+    int i = 0;
+    while (pos < data.size()) {
+        size_t end = data.find('\n', pos);
+        if (end == string::npos) end = data.size();
+        if (end > pos && data[pos] != '\r') {
+            if (i >= sched.numNurses) {
+                error = "CSV has more rows than the instance has nurses";
+                return false;
+            }
+            size_t p = data.find(',', pos);     // bỏ cột tên
+            for (int j = 0; j < T; j++) {
+                if (p == string::npos || p + 1 >= end || (data[p + 1] != '0' && data[p + 1] != '1')) {
+                    error = "CSV row " + to_string(i + 2) + ": expected " + to_string(T) + " 0/1 cells";
+                    return false;
+                }
+                if (data[p + 1] == '1') sched.set(i, j);
+                p += 2;
+            }
+            i++;
+        }
+        pos = end + 1;
+    }
+    if (i != sched.numNurses) {
+        error = "CSV has " + to_string(i) + " rows, instance has " + to_string(sched.numNurses) + " nurses";
+        return false;
+    }
+    return true;
+}
+
+// ==================== MAIN ====================
+
+void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " (--reference N[,H] | --instance FILE) (--schedule FILE | --random SEED)\n"
+         << "  --cost X            chi phí backend báo, so với chi phí dựng lại\n"
+         << "  --threads N         số thread (mặc định theo số core)\n"
+         << "  --max-report K      số vi phạm in chi tiết (mặc định 20)\n"
+         << "  --scenarios N       chấm thêm trên N kịch bản nhu cầu ngẫu nhiên (mặc định 0)\n"
+         << "  --demand-noise X    độ lệch chuẩn tương đối nhu cầu từng ca (0.1)\n"
+         << "  --day-noise X       độ lệch chuẩn tương đối chung cho cả ngày (0.05)\n"
+         << "  --shortfall-cost C  chi phí mỗi người thiếu một ca (2000)\n"
+         << "  --scenario-seed N   seed sinh kịch bản (1)\n"
+         << "  --scenario-csv FILE ghi thiếu hụt / chi phí từng kịch bản\n";
+}
+
+// Chấm lịch trên các kịch bản nhu cầu, in KEY=value; false nếu không ghi được CSV
+bool runScenarios(const NSPInstance& inst, const PackedSchedule& sched, double baseCost,
+                  NSPScenarioOptions opt, const string& csvPath) {
+    auto start = chrono::high_resolution_clock::now();
+    NSPScenarioSet set = sampleDemandScenarios(inst, opt);
+    auto sampled = chrono::high_resolution_clock::now();
+    NSPScenarioReport r = evaluateScenarios(set, shiftCoverage(sched), baseCost, opt.threads);
+    auto evaluated = chrono::high_resolution_clock::now();
+
+    int riskiest = max_element(r.shortProb.begin(), r.shortProb.end()) - r.shortProb.begin();
+    cout << "SCENARIOS=" << set.numScenarios << endl;
+    cout << "SERVICE_LEVEL=" << fixed << setprecision(4) << r.serviceLevel << endl;
+    cout << "MEAN_SHORTFALL=" << r.meanShortfall << endl;
+    if (!r.shortProb.empty()) {
+        cout << "RISKIEST_SHIFT=" << riskiest << " (day " << riskiest / inst.shiftsPerDay << ", type "
+             << riskiest % inst.shiftsPerDay << ")" << endl;
+        cout << "RISKIEST_SHORT_PROB=" << r.shortProb[riskiest] << endl;
+    }
+    cout << "EXPECTED_COST=" << setprecision(0) << r.expectedCost << endl;
+    cout << "P95_COST=" << r.p95Cost << endl;
+    cout << "CVAR95_COST=" << r.cvar95Cost << endl;
+    cout << "WORST_COST=" << r.worstCost << endl;
+    cout << "SAMPLE_MS=" << setprecision(2)
+         << chrono::duration<double, milli>(sampled - start).count() << endl;
+    cout << "SCENARIO_MS=" << chrono::duration<double, milli>(evaluated - sampled).count() << endl;
+    cout << "SCENARIO_THREADS=" << r.threadsUsed << endl;
+
+    if (csvPath.empty()) return true;
+    ofstream out(csvPath);
+    out << "scenario,shortfall,cost\n" << fixed << setprecision(0);
+    for (int s = 0; s < set.numScenarios; s++) {
+        out << s << "," << r.shortfall[s] << "," << r.costOf(s, set.costShortfall) << "\n";
+    }
+    if (!out) cerr << "Cannot write " << csvPath << endl;
+    return bool(out);
+}
+
+int main(int argc, char** argv) {
+    string instancePath, schedulePath, reference;
+    int threads = 0;
+    size_t maxReport = 20;
+    double reportedCost = NAN;
+    long randomSeed = -1;
+    NSPScenarioOptions scenarioOpt;
+    scenarioOpt.numScenarios = 0;
+    string scenarioCsv;
+    for (int a = 1; a < argc; a++) {
+        string arg = argv[a];
+        if (arg == "--instance" && a + 1 < argc) {
+            instancePath = argv[++a];
+        } else if (arg == "--reference" && a + 1 < argc) {
+            reference = argv[++a];
+        } else if (arg == "--schedule" && a + 1 < argc) {
+            schedulePath = argv[++a];
+        } else if (arg == "--random" && a + 1 < argc) {
+            randomSeed = atol(argv[++a]);
+        } else if (arg == "--cost" && a + 1 < argc) {
+            reportedCost = atof(argv[++a]);
+        } else if (arg == "--threads" && a + 1 < argc) {
+            threads = atoi(argv[++a]);
+        } else if (arg == "--max-report" && a + 1 < argc) {
+            maxReport = atol(argv[++a]);
+        } else if (arg == "--scenarios" && a + 1 < argc) {
+            scenarioOpt.numScenarios = atoi(argv[++a]);
+        } else if (arg == "--demand-noise" && a + 1 < argc) {
+            scenarioOpt.shiftNoise = atof(argv[++a]);
+        } else if (arg == "--day-noise" && a + 1 < argc) {
+            scenarioOpt.dayNoise = atof(argv[++a]);
+        } else if (arg == "--shortfall-cost" && a + 1 < argc) {
+            scenarioOpt.costShortfall = atof(argv[++a]);
+        } else if (arg == "--scenario-seed" && a + 1 < argc) {
+            scenarioOpt.seed = strtoull(argv[++a], nullptr, 10);
+        } else if (arg == "--scenario-csv" && a + 1 < argc) {
+            scenarioCsv = argv[++a];
+        } else if (arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (instancePath.empty() == reference.empty() || schedulePath.empty() == (randomSeed < 0)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto loadStart = chrono::high_resolution_clock::now();
+    NSPInstance inst;
+    string error;
+    if (!reference.empty()) {
+        int numNurses = atoi(reference.c_str());
+        size_t comma = reference.find(',');
+        int numHead = comma != string::npos ? atoi(reference.c_str() + comma + 1)
+                                            : (int)(1234 * (numNurses / 1983.0));
+        if (numNurses <= 0 || numHead < 0 || numHead > numNurses) {
+            cerr << "Invalid --reference " << reference << endl;
+            return 1;
+        }
+        inst = makeReferenceInstance(numNurses, numHead);
+    } else {
+        char magic[4] = {};
+        ifstream(instancePath, ios::binary).read(magic, 4);
+        bool ok = memcmp(magic, "NSPI", 4) == 0
+                      ? readInstanceBinary(instancePath, inst, error)
+                      : readInstanceText(instancePath, inst, error);
+        if (!ok) {
+            cerr << error << endl;
+            return 1;
+        }
+    }
+
+    PackedSchedule sched;
+    double fileCost = NAN;
+    if (randomSeed >= 0) {
+        // Lịch ngẫu nhiên ~ số ca tối thiểu mỗi y tá, chỉ để đo tốc độ kiểm tra
+        mt19937_64 rng(randomSeed);
+        int T = inst.totalShifts();
+        sched.reset(inst.nurses.size(), T);
+        for (int i = 0; i < sched.numNurses; i++) {
+            int target = (int)inst.nurses[i].minShift;
+            for (int k = 0; k < target; k++) sched.set(i, rng() % T);
+        }
+    } else {
+        string data;
+        if (!readFileBytes(schedulePath, data)) {
+            cerr << "Cannot read " << schedulePath << endl;
+            return 1;
+        }
+        bool ok = data.compare(0, 4, "NSPB") == 0
+                      ? parseBinary(data, inst, sched, fileCost, error)
+                      : parseCsv(data, inst, sched, error);
+        if (!ok) {
+            cerr << schedulePath << ": " << error << endl;
+            return 1;
+        }
+        if (std::isnan(reportedCost)) reportedCost = fileCost;
+    }
+    double loadMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - loadStart).count();
+
+    auto start = chrono::high_resolution_clock::now();
+    NSPValidationReport report = validateSchedule(inst, sched, threads, maxReport);
+    double validateMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+    cout << "Instance: " << inst.nurses.size() << " nurses, " << inst.numDays << " days x "
+         << inst.shiftsPerDay << " shifts" << endl;
+    for (size_t k = 0; k < report.details.size(); k++) {
+        const NSPViolation& v = report.details[k];
+        cout << "  " << left << setw(4) << ruleName(v.rule) << right;
+        if (v.nurse >= 0) cout << " nurse " << v.nurse;
+        if (v.shift >= 0) {
+            if (v.rule == RULE_HEAD_PER_MORNING) cout << " day " << v.shift;
+            else cout << " shift " << v.shift << " (day " << v.shift / inst.shiftsPerDay
+                      << ", type " << v.shift % inst.shiftsPerDay << ")";
+        }
+        if (v.rule == RULE_SKILL) cout << " skills 0x" << hex << v.skills << dec;
+        cout << ": actual " << v.actual << ", limit " << v.limit << endl;
+    }
+    if ((long)report.details.size() < report.totalViolations) {
+        cout << "  ... " << report.totalViolations - (long)report.details.size() << " more" << endl;
+    }
+
+    for (int r = 0; r < NUM_RULES; r++) {
+        if (report.byRule[r]) cout << "RULE_" << ruleName(r) << "=" << report.byRule[r] << endl;
+    }
+    cout << "VIOLATIONS=" << report.totalViolations << endl;
+    cout << "NORMAL_SHIFTS=" << report.normalShifts << endl;
+    cout << "OVERTIME_SHIFTS=" << report.overtimeShifts << endl;
+    cout << "HEAD_SHIFTS=" << report.headShifts << endl;
+    if (!inst.avoid.empty()) cout << "AVOIDED_SHIFTS=" << report.avoidedShifts << endl;
+    cout << "TOTAL_COST=" << fixed << setprecision(0) << report.cost << endl;
+    bool costMatches = true;
+    if (!std::isnan(reportedCost)) {
+        costMatches = fabs(reportedCost - report.cost) <= 1e-6 * max(1.0, fabs(report.cost));
+        cout << "REPORTED_COST=" << reportedCost << endl;
+        cout << "COST_MATCH=" << (costMatches ? 1 : 0) << endl;
+    }
+    cout << "LOAD_MS=" << setprecision(2) << loadMs << endl;
+    cout << "VALIDATE_MS=" << validateMs << endl;
+    cout << "THREADS=" << report.threadsUsed << endl;
+    scenarioOpt.threads = threads;
+    if (scenarioOpt.numScenarios > 0 && !runScenarios(inst, sched, report.cost, scenarioOpt, scenarioCsv)) {
+        return 1;
+    }
+    bool valid = report.totalViolations == 0 && costMatches;
+    cout << "VALID=" << (valid ? 1 : 0) << endl;
+    return valid ? 0 : 2;
+}
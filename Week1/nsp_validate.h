@@ -0,0 +1,320 @@
+/**
+ * Nurse Scheduling Problem (NSP) - Kiểm tra lịch độc lập với backend
+ *
+ * Chấm một lịch bất kỳ (CP-SAT, HiGHS, heuristic, libnsp, file --export-bin / --export-csv)
+ * theo luật #1-#12 của NSPInstance và dựng lại chi phí (ca thường / vượt minShift / trưởng /
+ * phạt ô avoid).
+ * Cùng ngữ nghĩa và cùng số vi phạm với evaluateSchedule() trong nsp_backend.h, nhưng:
+ *   - mỗi hàng y tá là các word uint64 (bit j = ca j), luật theo y tá tính bằng popcount / mask,
+ *     mask unavailable / avoid của instance cùng bố cục nên #11 và phạt avoid là một AND mỗi word,
+ *   - các y tá chia theo khối liên tục cho nhiều thread, tổng theo ca gộp lại ở cuối
+ *     (#12: histogram tập kỹ năng theo ca, 256 ô mỗi ca, rồi chấm các hàng Hall một lần),
+ *   - trả về từng ràng buộc bị vi phạm (luật, y tá / ca, giá trị thực tế, ngưỡng).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "nsp_backend.h"
+
+// Mã luật; #7' (số ca sáng tối thiểu mỗi y tá trưởng) tách riêng khỏi #7
+enum NSPRule {
+    RULE_DEMAND = 0,        // #1  đủ y tá mỗi ca
+    RULE_MIN_SHIFTS,        // #2
+    RULE_MAX_SHIFTS,        // #3
+    RULE_MIN_AFTERNOON,     // #4
+    RULE_MIN_NIGHT,         // #5
+    RULE_HEAD_MORNING_ONLY, // #6  y tá trưởng chỉ làm ca sáng
+    RULE_HEAD_PER_MORNING,  // #7  số y tá trưởng mỗi ca sáng
+    RULE_HEAD_MIN_MORNING,  // #7' số ca sáng mỗi y tá trưởng
+    RULE_FEMALE,            // #8  mỗi ca có ít nhất 1 nữ
+    RULE_GAP,               // #9  không làm ca j và j+2
+    RULE_WINDOW,            // #10 tối đa 2 ca trong 5 ca liên tiếp
+    RULE_UNAVAILABLE,       // #11 không làm ô unavailable
+    RULE_SKILL,             // #12 đủ y tá theo tập kỹ năng (hàng Hall) mỗi ca
+    NUM_RULES
+};
+
+inline const char* ruleName(int rule) {
+    static const char* names[NUM_RULES] = {"#1", "#2", "#3", "#4", "#5", "#6",
+                                           "#7", "#7'", "#8", "#9", "#10", "#11", "#12"};
+    return rule >= 0 && rule < NUM_RULES ? names[rule] : "?";
+}
+
+struct NSPViolation {
+    int rule;
+    int nurse;              // -1 với luật theo ca / ngày
+    int shift;              // ca (j) hoặc ngày (#7); -1 với luật theo cả tuần của y tá
+    int actual;
+    int limit;
+    int skills = 0;         // #12: tập kỹ năng của hàng Hall bị thiếu
+};
+
+struct NSPValidationReport {
+    long totalViolations = 0;
+    std::array<long, NUM_RULES> byRule{};
+    std::vector<NSPViolation> details;    // tối đa maxDetails, theo thứ tự y tá rồi theo ca
+    double cost = 0;
+    long normalShifts = 0;                // ca y tá thường tính giá costNormal
+    long overtimeShifts = 0;              // ca vượt minShift tính giá costOvertime
+    long headShifts = 0;
+    long avoidedShifts = 0;               // ca rơi vào ô avoid, phạt costPreference
+    int threadsUsed = 1;
+};
+
+// Lịch bit-packed: hàng i bắt đầu ở words[i * wordsPerRow]
+struct PackedSchedule {
+    int numNurses = 0;
+    int totalShifts = 0;
+    int wordsPerRow = 0;
+    std::vector<uint64_t> words;
+
+    void reset(int nurses, int shifts) {
+        numNurses = nurses;
+        totalShifts = shifts;
+        wordsPerRow = (shifts + 63) / 64;
+        words.assign((size_t)nurses * wordsPerRow, 0);
+    }
+    const uint64_t* row(int i) const { return words.data() + (size_t)i * wordsPerRow; }
+    uint64_t* row(int i) { return words.data() + (size_t)i * wordsPerRow; }
+    void set(int i, int j) { row(i)[j / 64] |= uint64_t(1) << (j % 64); }
+};
+
+inline PackedSchedule packSchedule(const NSPInstance& inst, const std::vector<char>& cells) {
+    PackedSchedule packed;
+    int T = inst.totalShifts();
+    packed.reset(inst.nurses.size(), T);
+    for (int i = 0; i < packed.numNurses; i++) {
+        const char* src = cells.data() + (size_t)i * T;
+        for (int j = 0; j < T; j++) {
+            if (src[j]) packed.set(i, j);
+        }
+    }
+    return packed;
+}
+
+// Số y tá làm từng ca (tổng theo cột), duyệt các bit 1 của mỗi word
+inline std::vector<int> shiftCoverage(const PackedSchedule& sched) {
+    std::vector<int> cover(sched.totalShifts, 0);
+    for (int i = 0; i < sched.numNurses; i++) {
+        const uint64_t* row = sched.row(i);
+        for (int w = 0; w < sched.wordsPerRow; w++) {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1) cover[w * 64 + __builtin_ctzll(bits)]++;
+        }
+    }
+    return cover;
+}
+
+namespace nsp_validate_detail {
+
+// Word w của hàng dịch phải k bit (0 <= k < 64), nối bit từ word kế tiếp
+inline uint64_t shifted(const uint64_t* row, int words, int w, int k) {
+    if (k == 0) return row[w];
+    uint64_t hi = w + 1 < words ? row[w + 1] << (64 - k) : 0;
+    return (row[w] >> k) | hi;
+}
+
+// Mask các bit j < limit trong word w
+inline uint64_t prefixMask(int w, int limit) {
+    int lo = w * 64;
+    if (limit <= lo) return 0;
+    if (limit >= lo + 64) return ~uint64_t(0);
+    return (uint64_t(1) << (limit - lo)) - 1;
+}
+
+struct Partial {
+    std::vector<int> cover, female, headMorning, skillHist;
+    std::array<long, NUM_RULES> byRule{};
+    std::vector<NSPViolation> details;
+    long normalShifts = 0, overtimeShifts = 0, headShifts = 0, avoidedShifts = 0;
+};
+
+inline void addViolation(Partial& p, size_t maxDetails, int rule, int nurse, int shift,
+                         int actual, int limit, int skills = 0) {
+    p.byRule[rule]++;
+    if (p.details.size() < maxDetails) p.details.push_back({rule, nurse, shift, actual, limit, skills});
+}
+
+// Luật theo y tá cho các y tá [begin, end) + tích lũy tổng theo ca
+inline void checkNurses(const NSPInstance& inst, const PackedSchedule& sched,
+                        const std::vector<uint64_t>& typeMasks, int begin, int end,
+                        size_t maxDetails, Partial& p) {
+    const int T = sched.totalShifts, W = sched.wordsPerRow, S = inst.shiftsPerDay;
+    const uint64_t* morningMask = typeMasks.data();
+    const uint64_t* afternoonMask = typeMasks.data() + W;
+    const uint64_t* nightMask = typeMasks.data() + 2 * W;
+    p.cover.assign(T, 0);
+    p.female.assign(T, 0);
+    p.headMorning.assign(inst.numDays, 0);
+    p.skillHist.assign(inst.skillDemand.empty() ? 0 : (size_t)T * 256, 0);
+    const bool trackSkills = !p.skillHist.empty();
+
+    for (int i = begin; i < end; i++) {
+        const NSPNurse& n = inst.nurses[i];
+        const uint64_t* row = sched.row(i);
+        const uint64_t* unavailable = inst.unavailable.empty() ? nullptr : &inst.unavailable[(size_t)i * W];
+        const uint64_t* avoid = inst.avoid.empty() ? nullptr : &inst.avoid[(size_t)i * W];
+        int worked = 0, morning = 0, afternoon = 0, night = 0;
+        for (int w = 0; w < W; w++) {
+            uint64_t bits = row[w];
+            if (avoid) p.avoidedShifts += __builtin_popcountll(bits & avoid[w]);
+            for (uint64_t bad = unavailable ? bits & unavailable[w] : 0; bad; bad &= bad - 1) {
+                addViolation(p, maxDetails, RULE_UNAVAILABLE, i, w * 64 + __builtin_ctzll(bad), 1, 0);
+            }
+            worked += __builtin_popcountll(bits);
+            morning += __builtin_popcountll(bits & morningMask[w]);
+            afternoon += __builtin_popcountll(bits & afternoonMask[w]);
+            night += __builtin_popcountll(bits & nightMask[w]);
+            // Tổng theo ca: chỉ duyệt các bit bật
+            while (bits) {
+                int j = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                p.cover[j]++;
+                if (trackSkills) p.skillHist[(size_t)j * 256 + n.skills]++;
+                if (n.isFemale) p.female[j]++;
+                if (n.isHead && j % S == 0) p.headMorning[j / S]++;
+            }
+        }
+
+        if (worked < n.minShift) addViolation(p, maxDetails, RULE_MIN_SHIFTS, i, -1, worked, (int)n.minShift);
+        if (worked > n.maxShift) addViolation(p, maxDetails, RULE_MAX_SHIFTS, i, -1, worked, (int)n.maxShift);
+        if (n.isHead) {
+            if (worked != morning) addViolation(p, maxDetails, RULE_HEAD_MORNING_ONLY, i, -1, worked - morning, 0);
+            if (morning < inst.minMorningPerHead) {
+                addViolation(p, maxDetails, RULE_HEAD_MIN_MORNING, i, -1, morning, inst.minMorningPerHead);
+            }
+            p.headShifts += worked;
+            continue;
+        }
+        if (S >= 3 && afternoon < inst.minAfternoon) {
+            addViolation(p, maxDetails, RULE_MIN_AFTERNOON, i, -1, afternoon, inst.minAfternoon);
+        }
+        if (S >= 2 && night < inst.minNight) {
+            addViolation(p, maxDetails, RULE_MIN_NIGHT, i, -1, night, inst.minNight);
+        }
+
+        for (int w = 0; w < W; w++) {
+            // #9: bit j của row & (row >> 2) = làm cả ca j và j + 2 (j + 2 < T)
+            uint64_t gap = row[w] & shifted(row, W, w, 2) & prefixMask(w, T - 2);
+            // #10: đếm 5 bit liên tiếp bằng bộ cộng bit-sliced, vi phạm khi tổng >= 3
+            uint64_t a0 = row[w], a1 = shifted(row, W, w, 1), a2 = shifted(row, W, w, 2),
+                     a3 = shifted(row, W, w, 3), a4 = shifted(row, W, w, 4);
+            uint64_t s1 = a0 ^ a1 ^ a2, c1 = (a0 & a1) | (a2 & (a0 ^ a1));
+            uint64_t bit0 = s1 ^ a3 ^ a4, c2 = (s1 & a3) | (a4 & (s1 ^ a3));
+            uint64_t bit1 = c1 ^ c2, bit2 = c1 & c2;
+            uint64_t window = (bit2 | (bit1 & bit0)) & prefixMask(w, T - 4);
+            while (gap) {
+                int j = w * 64 + __builtin_ctzll(gap);
+                gap &= gap - 1;
+                addViolation(p, maxDetails, RULE_GAP, i, j, 2, 1);
+            }
+            while (window) {
+                int j = w * 64 + __builtin_ctzll(window);
+                window &= window - 1;
+                int inWindow = 0;
+                for (int t = 0; t < 5; t++) inWindow += (row[(j + t) / 64] >> ((j + t) % 64)) & 1;
+                addViolation(p, maxDetails, RULE_WINDOW, i, j, inWindow, 2);
+            }
+        }
+        int overtime = worked > n.minShift ? worked - (int)n.minShift : 0;
+        p.normalShifts += worked - overtime;
+        p.overtimeShifts += overtime;
+    }
+}
+
+} // namespace nsp_validate_detail
+
+// numThreads <= 0: theo hardware_concurrency (instance nhỏ chạy một thread)
+inline NSPValidationReport validateSchedule(const NSPInstance& inst, const PackedSchedule& sched,
+                                            int numThreads = 0, size_t maxDetails = 1000) {
+    using namespace nsp_validate_detail;
+    const int T = sched.totalShifts, W = sched.wordsPerRow, S = inst.shiftsPerDay;
+    const int numNurses = sched.numNurses;
+
+    // Mask loại ca: sáng (s = 0), chiều (s = 1, chỉ khi S >= 3), đêm (s = S - 1, khi S > 1)
+    std::vector<uint64_t> typeMasks(3 * W, 0);
+    for (int j = 0; j < T; j++) {
+        int s = j % S;
+        uint64_t bit = uint64_t(1) << (j % 64);
+        if (s == 0) typeMasks[j / 64] |= bit;
+        if (s == 1) typeMasks[W + j / 64] |= bit;
+        if (s == S - 1 && S > 1) typeMasks[2 * W + j / 64] |= bit;
+    }
+
+    if (numThreads <= 0) numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = std::max(1, std::min(numThreads, numNurses / 4096 + 1));
+    std::vector<Partial> partials(numThreads);
+    std::vector<std::thread> workers;
+    int chunk = (numNurses + numThreads - 1) / numThreads;
+    for (int t = 0; t < numThreads; t++) {
+        int begin = std::min(numNurses, t * chunk), end = std::min(numNurses, begin + chunk);
+        if (t + 1 == numThreads) {
+            checkNurses(inst, sched, typeMasks, begin, end, maxDetails, partials[t]);
+        } else {
+            workers.emplace_back(checkNurses, std::cref(inst), std::cref(sched), std::cref(typeMasks),
+                                 begin, end, maxDetails, std::ref(partials[t]));
+        }
+    }
+    for (std::thread& w : workers) w.join();
+
+    NSPValidationReport report;
+    report.threadsUsed = numThreads;
+    Partial& total = partials[0];
+    for (int t = 1; t < numThreads; t++) {
+        const Partial& p = partials[t];
+        for (int j = 0; j < T; j++) {
+            total.cover[j] += p.cover[j];
+            total.female[j] += p.female[j];
+        }
+        for (int d = 0; d < inst.numDays; d++) total.headMorning[d] += p.headMorning[d];
+        for (size_t k = 0; k < p.skillHist.size(); k++) total.skillHist[k] += p.skillHist[k];
+        for (int r = 0; r < NUM_RULES; r++) total.byRule[r] += p.byRule[r];
+        total.normalShifts += p.normalShifts;
+        total.overtimeShifts += p.overtimeShifts;
+        total.headShifts += p.headShifts;
+        total.avoidedShifts += p.avoidedShifts;
+        for (const NSPViolation& v : p.details) {
+            if (total.details.size() >= maxDetails) break;
+            total.details.push_back(v);
+        }
+    }
+
+    // Luật theo ca / ngày
+    for (int j = 0; j < T; j++) {
+        if (total.cover[j] < inst.demandFor(j)) {
+            addViolation(total, maxDetails, RULE_DEMAND, -1, j, total.cover[j], inst.demandFor(j));
+        }
+        if (total.female[j] < 1) addViolation(total, maxDetails, RULE_FEMALE, -1, j, total.female[j], 1);
+    }
+    for (int d = 0; d < inst.numDays; d++) {
+        if (total.headMorning[d] < inst.minHeadPerMorning) {
+            addViolation(total, maxDetails, RULE_HEAD_PER_MORNING, -1, d, total.headMorning[d],
+                         inst.minHeadPerMorning);
+        }
+    }
+    std::vector<NSPSkillRow> skillRows = skillCoverageRows(inst);
+    std::vector<int> skillCover;
+    skillRowCover(skillRows, total.skillHist, skillCover);
+    for (size_t r = 0; r < skillRows.size(); r++) {
+        if (skillCover[r] >= skillRows[r].required) continue;
+        addViolation(total, maxDetails, RULE_SKILL, -1, skillRows[r].shift, skillCover[r],
+                     skillRows[r].required, skillRows[r].skills);
+    }
+
+    report.byRule = total.byRule;
+    for (long c : report.byRule) report.totalViolations += c;
+    report.details = std::move(total.details);
+    report.normalShifts = total.normalShifts;
+    report.overtimeShifts = total.overtimeShifts;
+    report.headShifts = total.headShifts;
+    report.avoidedShifts = total.avoidedShifts;
+    report.cost = report.normalShifts * inst.costNormal + report.overtimeShifts * inst.costOvertime +
+                  report.headShifts * inst.costHead + report.avoidedShifts * inst.costPreference;
+    return report;
+}
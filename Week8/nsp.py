@@ -1,3 +1,5 @@
+import time
+
 from pulp import *
 
 NUM_NURSES = 1983
@@ -49,6 +51,7 @@ num_female = sum(1 for n in nurses_data if n["is_female"])
 num_male = NUM_NURSES - num_female
 
 
+build_start = time.perf_counter()
 problem = LpProblem("NSP", LpMinimize)
 
 x = LpVariable.dicts(
@@ -166,10 +169,16 @@ for i in nor_nurses:
             lpSum(x[i, d, s] for d, s in window) <= 2
         )
 
+build_ms = (time.perf_counter() - build_start) * 1000.0
+solve_start = time.perf_counter()
 problem.solve(HiGHS())
+solve_ms = (time.perf_counter() - solve_start) * 1000.0
 
 if problem.status == 1:
     print("SUCCESS")
+    print(f"BUILD_MS={build_ms:.2f}")
+    print(f"SOLVE_MS={solve_ms:.2f}")
+    print(f"TOTAL_MS={build_ms + solve_ms:.2f}")
     print(f"TOTAL_COST={value(problem.objective):.0f}")
 else:
     print("FAILED")